@@ -0,0 +1,93 @@
+// Arena de memoria por blocos (ver arena.h).
+
+#include <stdlib.h>
+
+#include "arena.h"
+
+struct BlocoArena {
+    BlocoArena *proximo;
+    size_t tamanho;       // Bytes disponiveis em 'dados'
+    _Alignas(ARENA_ALINHAMENTO) unsigned char dados[];
+};
+
+// Arena de cada thread (arena_daThread)
+static _Thread_local Arena arena_thread;
+
+void arena_inicializar(Arena *a) {
+    a->primeiro = NULL;
+    a->atual = NULL;
+    a->usado = 0;
+}
+
+/**
+ * @brief Entrega 'tamanho' bytes alinhados a ARENA_ALINHAMENTO.
+ * Tenta o bloco atual, depois os blocos seguintes ja alocados (reaproveitados apos
+ * arena_reiniciar) e so entao aloca um bloco novo.
+ * @return O endereco, ou NULL se faltou memoria.
+ */
+void *arena_alocar(Arena *a, size_t tamanho) {
+    tamanho = (tamanho + ARENA_ALINHAMENTO - 1) & ~(size_t)(ARENA_ALINHAMENTO - 1);
+
+    while (a->atual && a->usado + tamanho > a->atual->tamanho) {
+        if (!a->atual->proximo) break;
+        a->atual = a->atual->proximo;
+        a->usado = 0;
+    }
+    if (!a->atual || a->usado + tamanho > a->atual->tamanho) {
+        size_t capacidade = tamanho > ARENA_TAM_BLOCO ? tamanho : ARENA_TAM_BLOCO;
+        BlocoArena *novo = malloc(sizeof(BlocoArena) + capacidade);
+        if (!novo) return NULL;
+        novo->tamanho = capacidade;
+        novo->proximo = NULL;
+        if (a->atual) {
+            a->atual->proximo = novo;
+        } else {
+            a->primeiro = novo;
+        }
+        a->atual = novo;
+        a->usado = 0;
+    }
+
+    void *endereco = a->atual->dados + a->usado;
+    a->usado += tamanho;
+    return endereco;
+}
+
+/**
+ * @brief Descarta tudo o que foi alocado, em O(1): os blocos ficam para as proximas alocacoes.
+ * Todo ponteiro entregue antes deixa de ser valido.
+ */
+void arena_reiniciar(Arena *a) {
+    a->atual = a->primeiro;
+    a->usado = 0;
+}
+
+/**
+ * @brief Devolve todos os blocos ao sistema.
+ */
+void arena_liberar(Arena *a) {
+    BlocoArena *b = a->primeiro;
+    while (b) {
+        BlocoArena *proximo = b->proximo;
+        free(b);
+        b = proximo;
+    }
+    arena_inicializar(a);
+}
+
+/**
+ * @brief Bytes mantidos pela arena (todos os blocos, usados ou nao).
+ */
+size_t arena_tamanhoReservado(const Arena *a) {
+    size_t total = 0;
+    for (const BlocoArena *b = a->primeiro; b; b = b->proximo) total += b->tamanho;
+    return total;
+}
+
+/**
+ * @brief Arena da thread que chama. Comeca vazia (zerada como toda variavel de thread);
+ * quem encerra a thread deve chamar arena_liberar(arena_daThread()).
+ */
+Arena *arena_daThread(void) {
+    return &arena_thread;
+}
@@ -0,0 +1,34 @@
+// Arena de memoria para o armazenamento das pilhas de reserva (ver criarPilha()).
+//
+// Alocacao por incremento de ponteiro dentro de blocos grandes: criar milhares de
+// sessoes nao faz um malloc por sessao, e nada e liberado individualmente. A arena
+// inteira volta a ficar vazia em O(1) com arena_reiniciar(); os blocos continuam
+// alocados e sao reaproveitados pelas proximas sessoes.
+//
+// Uma arena nao e thread-safe: cada thread usa a sua (arena_daThread()) ou a
+// arena de quem criou as sessoes.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_TAM_BLOCO (64 * 1024) // Bytes de cada bloco (maior se a alocacao pedir)
+#define ARENA_ALINHAMENTO 16
+
+typedef struct BlocoArena BlocoArena;
+
+typedef struct Arena {
+    BlocoArena *primeiro; // Lista de blocos, na ordem em que foram alocados
+    BlocoArena *atual;    // Bloco onde sai a proxima alocacao
+    size_t usado;         // Bytes ja entregues de 'atual'
+} Arena;
+
+void arena_inicializar(Arena *a);
+void *arena_alocar(Arena *a, size_t tamanho);
+void arena_reiniciar(Arena *a);
+void arena_liberar(Arena *a);
+size_t arena_tamanhoReservado(const Arena *a);
+Arena *arena_daThread(void);
+
+#endif // ARENA_H
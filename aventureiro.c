@@ -1,102 +1,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
 
-#define TAM_FILA 5
-#define TAM_PILHA 3
+#include "pecas.h"
+#include "arena.h"
+#include "entrada.h"
 
-// Estrutura que representa uma peça
-typedef struct {
-    char nome;  // Tipo da peça: 'I', 'O', 'T', 'L'
-    int id;     // Identificador único
-} Peca;
+#define TAM_FILA CAP_FILA
+#define TAM_PILHA CAP_PILHA
 
-// ---------- FILA CIRCULAR ----------
-typedef struct {
-    Peca elementos[TAM_FILA];
-    int frente;
-    int tras;
-    int quantidade;
-} Fila;
-
-// ---------- PILHA ----------
-typedef struct {
-    Peca elementos[TAM_PILHA];
-    int topo;
-} Pilha;
-
-// ---------- FUNÇÕES DA FILA ----------
-void inicializarFila(Fila *fila) {
-    fila->frente = 0;
-    fila->tras = -1;
-    fila->quantidade = 0;
-}
-
-int filaCheia(Fila *fila) {
-    return fila->quantidade == TAM_FILA;
-}
-
-int filaVazia(Fila *fila) {
-    return fila->quantidade == 0;
-}
-
-void enfileirar(Fila *fila, Peca peca) {
-    if (filaCheia(fila)) return;
-    fila->tras = (fila->tras + 1) % TAM_FILA;
-    fila->elementos[fila->tras] = peca;
-    fila->quantidade++;
-}
-
-Peca desenfileirar(Fila *fila) {
-    Peca removida = {'-', -1};
-    if (filaVazia(fila)) return removida;
-    removida = fila->elementos[fila->frente];
-    fila->frente = (fila->frente + 1) % TAM_FILA;
-    fila->quantidade--;
-    return removida;
-}
-
-// ---------- FUNÇÕES DA PILHA ----------
-void inicializarPilha(Pilha *pilha) {
-    pilha->topo = -1;
-}
-
-int pilhaVazia(Pilha *pilha) {
-    return pilha->topo == -1;
-}
-
-int pilhaCheia(Pilha *pilha) {
-    return pilha->topo == TAM_PILHA - 1;
-}
-
-void empilhar(Pilha *pilha, Peca peca) {
-    if (pilhaCheia(pilha)) {
-        printf("⚠️ Pilha cheia! Não é possível reservar mais peças.\n");
-        return;
-    }
-    pilha->topo++;
-    pilha->elementos[pilha->topo] = peca;
-}
-
-Peca desempilhar(Pilha *pilha) {
-    Peca removida = {'-', -1};
-    if (pilhaVazia(pilha)) {
-        printf("⚠️ Nenhuma peça reservada.\n");
-        return removida;
-    }
-    removida = pilha->elementos[pilha->topo];
-    pilha->topo--;
-    return removida;
-}
-
-// ---------- GERAÇÃO DE PEÇAS ----------
-Peca gerarPeca(int id) {
-    Peca nova;
-    char tipos[] = {'I', 'O', 'T', 'L'};
-    nova.nome = tipos[rand() % 4]; // Escolhe um tipo aleatório
-    nova.id = id;
-    return nova;
-}
+// Fila circular, pilha de reserva e as acoes vem do nucleo (pecas.h); este nivel
+// usa as acoes 1 (jogar), 2 (reservar) e 3 (usar) e so cuida das mensagens.
+// Jogar e reservar ja repoem uma peca nova no fim da fila.
 
 // ---------- EXIBIÇÃO DO ESTADO ----------
 void exibirEstado(Fila *fila, Pilha *pilha) {
@@ -104,37 +20,38 @@ void exibirEstado(Fila *fila, Pilha *pilha) {
     printf("ESTADO ATUAL:\n");
 
     printf("Fila de peças: ");
-    int i = fila->frente;
-    for (int c = 0; c < fila->quantidade; c++) {
-        Peca p = fila->elementos[i];
-        printf("[%c %d] ", p.nome, p.id);
-        i = (i + 1) % TAM_FILA;
+    for (uint32_t c = 0; c < fila_tamanho(fila); c++) {
+        Peca p = fila->elementos[(fila->cabeca + c) & fila->mascara];
+        printf("[%c %lld] ", p.nome, (long long)p.id);
     }
 
     printf("\nPilha de reserva (Topo -> Base): ");
     for (int j = pilha->topo; j >= 0; j--) {
         Peca p = pilha->elementos[j];
-        printf("[%c %d] ", p.nome, p.id);
+        printf("[%c %lld] ", p.nome, (long long)p.id);
     }
     printf("\n=========================\n");
 }
 
 // ---------- MENU PRINCIPAL ----------
 int main() {
-    srand(time(NULL));
+    inicializarFonte(&fonte_padrao, (uint64_t)time(NULL), GERADOR_UNIFORME);
 
     Fila fila;
     Pilha pilha;
-    inicializarFila(&fila);
-    inicializarPilha(&pilha);
+    if (!criarFila(&fila, TAM_FILA) || !criarPilha(&pilha, arena_daThread(), TAM_PILHA, 0)) {
+        fprintf(stderr, "Sem memoria para a fila e a pilha.\n");
+        return 1;
+    }
 
-    int idAtual = 0;
     // Inicializa a fila com 5 peças
-    for (int i = 0; i < TAM_FILA; i++) {
-        enfileirar(&fila, gerarPeca(idAtual++));
-    }
+    preencherFila(&fila);
 
-    int opcao;
+    static LeitorEntrada leitor;
+    ComandoEntrada lote[ENTRADA_MAX_LOTE];
+    int opcao = -1;
+    EventoAcao ev;
+    entrada_iniciar(&leitor, STDIN_FILENO);
     do {
         exibirEstado(&fila, &pilha);
         printf("\nOpções de ação:\n");
@@ -143,37 +60,48 @@ int main() {
         printf("3 - Usar peça reservada\n");
         printf("0 - Sair\n");
         printf("Escolha: ");
-        scanf("%d", &opcao);
+        fflush(stdout); // A entrada e lida com read(), fora do stdio
+
+        // Aplica todos os codigos ja digitados antes de mostrar o estado de novo
+        int n = entrada_lerComandos(&leitor, lote, ENTRADA_MAX_LOTE);
+        if (n <= 0) break; // Fim da entrada
 
-        if (opcao == 1) {
-            // JOGAR PEÇA
-            if (!filaVazia(&fila)) {
-                Peca jogada = desenfileirar(&fila);
-                printf("Você jogou a peça [%c %d]\n", jogada.nome, jogada.id);
-                enfileirar(&fila, gerarPeca(idAtual++));
+        for (int i = 0; i < n && opcao != 0; i++) {
+            if (!lote[i].valido) {
+                printf("\n[ERRO] Entrada invalida. Por favor, digite um numero.\n");
+                continue;
+            }
+            opcao = lote[i].codigo;
+
+            if (opcao == 1) {
+                // JOGAR PEÇA
+                if (executarAcao(1, &fila, &pilha, &ev) == ACAO_OK) {
+                    printf("Você jogou a peça [%c %lld]\n", ev.peca.nome, (long long)ev.peca.id);
+                }
+            }
+            else if (opcao == 2) {
+                // RESERVAR PEÇA
+                if (executarAcao(2, &fila, &pilha, &ev) == ACAO_OK) {
+                    printf("Peça [%c %lld] movida para a reserva.\n", ev.peca.nome, (long long)ev.peca.id);
+                }
+            }
+            else if (opcao == 3) {
+                // USAR PEÇA RESERVADA
+                if (executarAcao(3, &fila, &pilha, &ev) == ACAO_OK) {
+                    printf("Você usou a peça reservada [%c %lld]\n", ev.peca.nome, (long long)ev.peca.id);
+                } else {
+                    printf("⚠️ Nenhuma peça reservada.\n");
+                }
             }
-        } 
-        else if (opcao == 2) {
-            // RESERVAR PEÇA
-            if (!filaVazia(&fila) && !pilhaCheia(&pilha)) {
-                Peca reservada = desenfileirar(&fila);
-                empilhar(&pilha, reservada);
-                printf("Peça [%c %d] movida para a reserva.\n", reservada.nome, reservada.id);
-                enfileirar(&fila, gerarPeca(idAtual++));
+            else if (opcao != 0) {
+                printf("Opção inválida.\n");
             }
-        } 
-        else if (opcao == 3) {
-            // USAR PEÇA RESERVADA
-            Peca usada = desempilhar(&pilha);
-            if (usada.id != -1)
-                printf("Você usou a peça reservada [%c %d]\n", usada.nome, usada.id);
-        } 
-        else if (opcao != 0) {
-            printf("Opção inválida.\n");
         }
 
     } while (opcao != 0);
 
     printf("\nEncerrando o jogo. Até logo!\n");
+    destruirFila(&fila);
+    arena_liberar(arena_daThread());
     return 0;
 }
@@ -0,0 +1,667 @@
+// Microbenchmark das primitivas de fila, pilha e troca do nucleo (pecas.h).
+//
+// Mede vazao (ops/s) e latencia (p50/p99/p99.9) de cada operacao e grava os
+// resultados em CSV, acrescentando linhas a cada execucao para comparar builds.
+// Novato, aventureiro e mestre usam as mesmas operacoes, entao os numeros valem
+// para os tres niveis.
+//
+// Compilar: make bench
+// Uso:      bench [-n operacoes] [-o arquivo.csv] [-r rotulo]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "pecas.h"
+#include "arena.h"
+#include "tabuleiro.h"
+#include "historico.h"
+#include "sessoes.h"
+
+// Rodadas das operacoes que podem se repetir indefinidamente (estado estavel)
+#define RODADA_ESTAVEL 1024
+
+// Pecas geradas por chamada no caso de geracao em bloco
+#define BLOCO_GERACAO 1024
+
+// Pecas por chamada na troca de trechos grandes (fora da fila/pilha)
+#define BLOCO_TROCA 256
+
+// Criacao de sessoes em massa: pilhas de reserva grandes criadas e descartadas por chamada
+#define NUM_PILHAS_BENCH 1024
+#define CAP_PILHA_GRANDE 256
+
+// Colocacoes de uma peca T em um tabuleiro de 10 colunas: 8 + 9 + 8 + 9 (rotacoes deitadas e em pe)
+#define COLOCACOES_T 34
+
+// Fila longa para as consultas de previsao (indice de tipos contra varredura)
+#define CAP_FILA_LONGA 1024
+
+// Sessoes que recebem a mesma acao de uma vez (sessoes.h) e passos da conferencia
+#define NUM_SESSOES_BENCH 1024
+#define PASSOS_CONFERENCIA 2000
+
+// --- Estruturas do Benchmark ---
+
+// Um caso mede uma operacao. 'preparar' restaura o estado fora da medicao e
+// 'por_rodada' e quantas chamadas validas de 'operar' cabem apos cada preparo.
+// 'unidades' e quantos itens cada chamada processa (0 equivale a 1); a vazao e
+// dada em itens/s e a latencia e sempre por chamada.
+typedef struct {
+    const char *implementacao;
+    const char *operacao;
+    void (*preparar)(void);
+    void (*operar)(void);
+    int por_rodada;
+    int unidades;
+} CasoBench;
+
+typedef struct {
+    double ops_por_s;
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+} ResultadoBench;
+
+
+// --- 1. Relogio ---
+
+static double ns_por_tick = 1.0;
+
+/**
+ * @brief Le o contador de tempo mais barato disponivel (rdtsc no x86, clock_gettime nos demais).
+ */
+static inline uint64_t lerTicks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+#endif
+}
+
+static uint64_t lerNanos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+/**
+ * @brief Calibra a conversao de ticks para nanossegundos contra o relogio monotonico.
+ */
+static void calibrarRelogio(void) {
+    uint64_t n0 = lerNanos(), t0 = lerTicks();
+    while (lerNanos() - n0 < 50000000ULL) {
+        // espera ~50 ms
+    }
+    uint64_t n1 = lerNanos(), t1 = lerTicks();
+    ns_por_tick = (double)(n1 - n0) / (double)(t1 - t0);
+}
+
+
+// --- 2. Estado e Operacoes Medidas ---
+
+static Fila fila_bench;
+static Pilha pilha_bench;
+static const Peca PECA_BENCH = {'T', 42};
+
+static EventoAcao evento_bench;
+
+static void nucleoPrepararFilaVazia(void) { inicializarFila(&fila_bench); }
+
+static void nucleoPrepararFilaCheia(void) {
+    inicializarFila(&fila_bench);
+    while (!fila_estaCheia(&fila_bench)) enqueue(&fila_bench, PECA_BENCH);
+}
+
+static void nucleoPrepararPilhaVazia(void) { inicializarPilha(&pilha_bench); }
+
+static void nucleoPrepararPilhaCheia(void) {
+    inicializarPilha(&pilha_bench);
+    while (!pilha_estaCheia(&pilha_bench)) push(&pilha_bench, PECA_BENCH);
+}
+
+static void nucleoPrepararAmbasCheias(void) {
+    nucleoPrepararFilaCheia();
+    nucleoPrepararPilhaCheia();
+}
+
+// Fila cheia com a frente no fim do armazenamento: a troca em bloco da a volta no anel
+static void nucleoPrepararAmbasCheiasVolta(void) {
+    nucleoPrepararAmbasCheias();
+    fila_bench.cabeca = fila_bench.cauda = fila_bench.mascara;
+    while (!fila_estaCheia(&fila_bench)) enqueue(&fila_bench, PECA_BENCH);
+}
+
+static void nucleoEnqueue(void) { enqueue(&fila_bench, PECA_BENCH); }
+static void nucleoDequeueSimples(void) { dequeueSimples(&fila_bench); }
+static void nucleoDequeue(void) { dequeue(&fila_bench); }
+static void nucleoPush(void) { push(&pilha_bench, PECA_BENCH); }
+static void nucleoPop(void) { pop(&pilha_bench); }
+static void nucleoTrocaUnica(void) { trocarPecaUnicaAcao(&fila_bench, &pilha_bench, &evento_bench); }
+static void nucleoTrocaMultipla(void) { trocarPecasMultiplaAcao(&fila_bench, &pilha_bench, &evento_bench); }
+static void nucleoTrocarN(void) { fila_pilha_trocar_n(&fila_bench, &pilha_bench, NUM_TROCA_MULTIPLA); }
+
+// Implementacao anterior da troca 3x3 (dois vetores temporarios), mantida como referencia
+static void referenciaTroca3x3(void) {
+    Peca temp_pilha[NUM_TROCA_MULTIPLA];
+    Peca temp_fila[NUM_TROCA_MULTIPLA];
+
+    if (fila_tamanho(&fila_bench) < NUM_TROCA_MULTIPLA || pilha_bench.topo + 1 < NUM_TROCA_MULTIPLA) return;
+    fila_peek_n(&fila_bench, temp_fila, NUM_TROCA_MULTIPLA);
+    pilha_pop_n(&pilha_bench, temp_pilha, NUM_TROCA_MULTIPLA);
+    copiarParaAnel(&fila_bench, fila_bench.cabeca, temp_pilha, NUM_TROCA_MULTIPLA);
+    pilha_push_n(&pilha_bench, temp_fila, NUM_TROCA_MULTIPLA);
+}
+
+// Tentar uma acao e voltar ao estado anterior, como a busca faz em cada filho: o delta do
+// historico (aplicar e reverter) contra executar a acao sobre uma copia da sessao
+static DeltaAcao delta_bench;
+static Fila fila_copia;
+static Pilha pilha_copia;
+static FontePecas fonte_copia;
+static Peca copia_fila[2 * CAP_FILA], copia_pilha[CAP_PILHA];
+static void historicoTentar(int acao) {
+    historico_aplicar(&delta_bench, acao, &fila_bench, &pilha_bench, &evento_bench);
+    historico_reverter(&delta_bench, &fila_bench, &pilha_bench);
+}
+static void referenciaTentar(int acao) {
+    fonte_copia = *fila_bench.fonte;
+    fila_copia = fila_bench;
+    fila_copia.elementos = copia_fila;
+    fila_copia.fonte = &fonte_copia;
+    memcpy(copia_fila, fila_bench.elementos, (fila_bench.mascara + 1) * sizeof(Peca));
+    pilha_copia = pilha_bench;
+    pilha_copia.elementos = copia_pilha;
+    memcpy(copia_pilha, pilha_bench.elementos, (size_t)(pilha_bench.topo + 1) * sizeof(Peca));
+    executarAcao(acao, &fila_copia, &pilha_copia, &evento_bench);
+}
+static void historicoJogar(void) { historicoTentar(1); }
+static void referenciaJogar(void) { referenciaTentar(1); }
+static void historicoTroca3(void) { historicoTentar(5); }
+static void referenciaTroca3(void) { referenciaTentar(5); }
+
+// Uma acao aplicada a NUM_SESSOES_BENCH sessoes por chamada: executarAcao() em cada
+// sessao (Fila/Pilha comuns) contra os nucleos da estrutura de arrays (escalar, SSE4.1
+// e AVX2). A vazao sai em sessoes/s.
+static Fila filas_aos[NUM_SESSOES_BENCH];
+static Pilha pilhas_aos[NUM_SESSOES_BENCH];
+static FontePecas fontes_aos[NUM_SESSOES_BENCH];
+static Peca armazenamento_filas_aos[NUM_SESSOES_BENCH][2 * CAP_FILA];
+static Peca armazenamento_pilhas_aos[NUM_SESSOES_BENCH][CAP_PILHA];
+static SessoesSoA sessoes_bench;
+static uint8_t resultados_bench[NUM_SESSOES_BENCH];
+
+static void iniciarSessoesBench(void) {
+    for (uint32_t i = 0; i < NUM_SESSOES_BENCH; i++) {
+        inicializarFonte(&fontes_aos[i], i + 1, GERADOR_UNIFORME);
+        criarFilaEm(&filas_aos[i], armazenamento_filas_aos[i], CAP_FILA);
+        filas_aos[i].fonte = &fontes_aos[i];
+        criarPilhaEm(&pilhas_aos[i], armazenamento_pilhas_aos[i], CAP_PILHA);
+        preencherFila(&filas_aos[i]);
+        sessoes_iniciar(&sessoes_bench, i, i + 1);
+    }
+}
+
+static void sessoesPrepararPilhasVazias(void) {
+    for (uint32_t i = 0; i < NUM_SESSOES_BENCH; i++) inicializarPilha(&pilhas_aos[i]);
+    memset(sessoes_bench.topo, -1, NUM_SESSOES_BENCH);
+}
+
+static void sessoesPrepararPilhasCheias(void) {
+    for (uint32_t i = 0; i < NUM_SESSOES_BENCH; i++) {
+        while (!pilha_estaCheia(&pilhas_aos[i])) push(&pilhas_aos[i], PECA_BENCH);
+    }
+    memset(sessoes_bench.topo, CAP_PILHA - 1, NUM_SESSOES_BENCH);
+}
+
+static void escalarAplicar(int codigo) {
+    for (uint32_t i = 0; i < NUM_SESSOES_BENCH; i++) {
+        resultados_bench[i] = (uint8_t)executarAcao(codigo, &filas_aos[i], &pilhas_aos[i], &evento_bench);
+    }
+}
+static void escalarJogar(void) { escalarAplicar(1); }
+static void escalarReservar(void) { escalarAplicar(2); }
+static void escalarUsar(void) { escalarAplicar(3); }
+static void escalarTroca(void) { escalarAplicar(4); }
+static void soaJogar(void) { sessoes_aplicarCom(&sessoes_bench, 1, resultados_bench, SESSOES_ESCALAR); }
+static void soaReservar(void) { sessoes_aplicarCom(&sessoes_bench, 2, resultados_bench, SESSOES_ESCALAR); }
+static void soaUsar(void) { sessoes_aplicarCom(&sessoes_bench, 3, resultados_bench, SESSOES_ESCALAR); }
+static void soaTroca(void) { sessoes_aplicarCom(&sessoes_bench, 4, resultados_bench, SESSOES_ESCALAR); }
+static void sse4Jogar(void) { sessoes_aplicarCom(&sessoes_bench, 1, resultados_bench, SESSOES_SSE4); }
+static void sse4Reservar(void) { sessoes_aplicarCom(&sessoes_bench, 2, resultados_bench, SESSOES_SSE4); }
+static void sse4Usar(void) { sessoes_aplicarCom(&sessoes_bench, 3, resultados_bench, SESSOES_SSE4); }
+static void sse4Troca(void) { sessoes_aplicarCom(&sessoes_bench, 4, resultados_bench, SESSOES_SSE4); }
+static void avx2Jogar(void) { sessoes_aplicarCom(&sessoes_bench, 1, resultados_bench, SESSOES_AVX2); }
+static void avx2Reservar(void) { sessoes_aplicarCom(&sessoes_bench, 2, resultados_bench, SESSOES_AVX2); }
+static void avx2Usar(void) { sessoes_aplicarCom(&sessoes_bench, 3, resultados_bench, SESSOES_AVX2); }
+static void avx2Troca(void) { sessoes_aplicarCom(&sessoes_bench, 4, resultados_bench, SESSOES_AVX2); }
+
+/**
+ * @brief Confere cada nucleo contra executarAcao(): a mesma sequencia aleatoria de acoes
+ * (1-5) deve dar os mesmos resultados e, no fim, o mesmo hashEstado em todas as sessoes.
+ * @return 1 se todos conferem.
+ */
+static int conferirSessoes(void) {
+    static Peca armazenamento_fila[2 * CAP_FILA], armazenamento_pilha[CAP_PILHA];
+    FontePecas fonte;
+    Fila f;
+    Pilha p;
+
+    criarFilaEm(&f, armazenamento_fila, CAP_FILA);
+    f.fonte = &fonte;
+    criarPilhaEm(&p, armazenamento_pilha, CAP_PILHA);
+    for (int impl = SESSOES_ESCALAR; impl <= (int)sessoes_melhorImplementacao(); impl++) {
+        uint64_t x = 0x9E3779B97F4A7C15ULL;
+        iniciarSessoesBench();
+        for (int passo = 0; passo < PASSOS_CONFERENCIA; passo++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            int codigo = 1 + (int)(x % 5);
+            uint8_t resultados_soa[NUM_SESSOES_BENCH];
+            sessoes_aplicarCom(&sessoes_bench, codigo, resultados_soa, (ImplementacaoSessoes)impl);
+            escalarAplicar(codigo);
+            if (memcmp(resultados_soa, resultados_bench, sizeof(resultados_soa)) != 0) {
+                fprintf(stderr, "sessoes: %s difere no resultado da acao %d (passo %d)\n",
+                        sessoes_nomeImplementacao((ImplementacaoSessoes)impl), codigo, passo);
+                return 0;
+            }
+        }
+        for (uint32_t i = 0; i < NUM_SESSOES_BENCH; i++) {
+            sessoes_exportar(&sessoes_bench, i, &f, &p);
+            if (hashEstado(&f, &p) != hashEstado(&filas_aos[i], &pilhas_aos[i])) {
+                fprintf(stderr, "sessoes: %s difere no estado da sessao %u\n",
+                        sessoes_nomeImplementacao((ImplementacaoSessoes)impl), i);
+                return 0;
+            }
+        }
+    }
+    iniciarSessoesBench();
+    return 1;
+}
+
+// Troca de trechos grandes: no lugar (vetorizada) contra a copia por um temporario
+static Peca trecho_a[BLOCO_TROCA], trecho_b[BLOCO_TROCA];
+static void nucleoTrocarTrechos(void) { trocarTrechos(trecho_a, trecho_b, BLOCO_TROCA); }
+static void referenciaTrocarTrechos(void) {
+    Peca temp[BLOCO_TROCA];
+    memcpy(temp, trecho_a, sizeof(temp));
+    memcpy(trecho_a, trecho_b, sizeof(temp));
+    memcpy(trecho_b, temp, sizeof(temp));
+}
+
+// Pilhas de muitas sessoes: da arena (descartadas em O(1)) contra um malloc/free por pilha
+static Arena arena_pilhas;
+static Pilha pilhas_bench[NUM_PILHAS_BENCH];
+static Peca *armazenamentos_malloc[NUM_PILHAS_BENCH];
+static void arenaCriarDescartarPilhas(void) {
+    for (int i = 0; i < NUM_PILHAS_BENCH; i++) {
+        criarPilha(&pilhas_bench[i], &arena_pilhas, CAP_PILHA_GRANDE, 0);
+    }
+    arena_reiniciar(&arena_pilhas);
+}
+static void mallocCriarDescartarPilhas(void) {
+    for (int i = 0; i < NUM_PILHAS_BENCH; i++) {
+        armazenamentos_malloc[i] = malloc(CAP_PILHA_GRANDE * sizeof(Peca));
+        criarPilhaEm(&pilhas_bench[i], armazenamentos_malloc[i], CAP_PILHA_GRANDE);
+    }
+    for (int i = 0; i < NUM_PILHAS_BENCH; i++) free(armazenamentos_malloc[i]);
+}
+
+// Push em uma pilha que comeca com CAP_PILHA e dobra de capacidade na arena
+static Pilha pilha_crescente;
+static void arenaPrepararPilhaCrescente(void) {
+    arena_reiniciar(&arena_pilhas);
+    criarPilha(&pilha_crescente, &arena_pilhas, CAP_PILHA, 1);
+}
+static void arenaPushCrescente(void) { push(&pilha_crescente, PECA_BENCH); }
+
+static Peca janela_bench[CAP_FILA];
+static void nucleoEnqueueN(void) { fila_enqueue_n(&fila_bench, janela_bench, CAP_FILA); }
+static void nucleoDequeueN(void) { fila_dequeue_n(&fila_bench, janela_bench, CAP_FILA); }
+static void nucleoPushN(void) { pilha_push_n(&pilha_bench, janela_bench, CAP_PILHA); }
+static void nucleoPopN(void) { pilha_pop_n(&pilha_bench, janela_bench, CAP_PILHA); }
+
+// Mesmas operacoes com o indice de tipos ligado: o custo da manutencao incremental
+static Fila fila_indexada;
+static void indicePrepararFilaVazia(void) { inicializarFila(&fila_indexada); }
+static void indicePrepararFilaCheia(void) {
+    inicializarFila(&fila_indexada);
+    while (!fila_estaCheia(&fila_indexada)) enqueue(&fila_indexada, PECA_BENCH);
+}
+static void indiceEnqueue(void) { enqueue(&fila_indexada, PECA_BENCH); }
+static void indiceDequeue(void) { dequeue(&fila_indexada); }
+
+// Distancia ate o proximo 'I' numa fila longa onde ele esta perto do fim
+static Fila fila_longa;
+static volatile int distancia_bench;
+static void previsaoPrepararFilaLonga(void) {
+    inicializarFila(&fila_longa);
+    while (fila_tamanho(&fila_longa) < CAP_FILA_LONGA - 1) enqueue(&fila_longa, PECA_BENCH);
+    enqueue(&fila_longa, (Peca){'I', 7});
+}
+static void indiceDistanciaTipo(void) { distancia_bench = fila_distanciaTipo(&fila_longa, 'I'); }
+static void varreduraDistanciaTipo(void) {
+    int d = -1;
+    for (uint32_t c = 0; c < fila_tamanho(&fila_longa); c++) {
+        if (fila_longa.elementos[(fila_longa.cabeca + c) & fila_longa.mascara].nome == 'I') {
+            d = (int)c;
+            break;
+        }
+    }
+    distancia_bench = d;
+}
+
+// Tabuleiro 10x20: pecas O nas colunas 0, 2, 4, 6 e 8 completam duas linhas a cada cinco
+static Tabuleiro tabuleiro_bench;
+static int coluna_bench;
+static volatile int resultado_tabuleiro;
+static void tabuleiroPrepararVazio(void) {
+    tabuleiro_limpar(&tabuleiro_bench);
+    coluna_bench = 0;
+}
+static void tabuleiroColocarO(void) {
+    resultado_tabuleiro = tabuleiro_colocar(&tabuleiro_bench, 1, 0, coluna_bench);
+    coluna_bench = coluna_bench == 8 ? 0 : coluna_bench + 2;
+}
+
+// Quatro linhas completas de uma vez: um I em pe fecha a coluna 0 sob outras 8 linhas
+static void tabuleiroPrepararQuatroLinhas(void) {
+    tabuleiro_limpar(&tabuleiro_bench);
+    for (int y = 0; y < 4; y++) tabuleiro_bench.linhas[y] = (uint16_t)(tabuleiro_bench.vazia | 0x3FE);
+    for (int y = 4; y < 12; y++) tabuleiro_bench.linhas[y] = (uint16_t)(tabuleiro_bench.vazia | (0x155 << (y & 1)));
+    tabuleiro_bench.ocupadas = 12;
+}
+static void tabuleiroLimparQuatro(void) {
+    resultado_tabuleiro = tabuleiro_fixar(&tabuleiro_bench, 0, 1, 0, 0);
+}
+
+// Teste de colisao de cada forma e coluna em um tabuleiro com 10 linhas preenchidas
+static void tabuleiroPrepararMeio(void) {
+    tabuleiroPrepararQuatroLinhas();
+    for (int y = 0; y < 10; y++) tabuleiro_bench.linhas[y] |= (uint16_t)(0x2A5 >> (y % 3));
+    tabuleiro_bench.ocupadas = 12;
+    coluna_bench = 0;
+}
+static void tabuleiroCabe(void) {
+    int tipo = coluna_bench % GERADOR_NUM_TIPOS;
+    int rotacao = (coluna_bench >> 3) & 3;
+    resultado_tabuleiro = tabuleiro_cabe(&tabuleiro_bench, tipo, rotacao,
+                                         coluna_bench % (TABULEIRO_LARGURA - LARGURA_FORMA[tipo][rotacao] + 1),
+                                         coluna_bench & 15);
+    coluna_bench++;
+}
+
+// Todas as colocacoes de um T no tabuleiro com 10 linhas preenchidas: pelas alturas das
+// colunas e perfis, contra uma queda com teste de colisao para cada rotacao e coluna
+static Colocacao colocacoes_bench[2 * TABULEIRO_MAX_COLOCACOES];
+static void tabuleiroGerarColocacoes(void) {
+    resultado_tabuleiro = gerarColocacoes(&tabuleiro_bench, 2, colocacoes_bench);
+}
+static void referenciaGerarPorQueda(void) {
+    int n = 0;
+    for (int rotacao = 0; rotacao < TABULEIRO_ROTACOES; rotacao++) {
+        for (int coluna = 0; coluna + LARGURA_FORMA[2][rotacao] <= TABULEIRO_LARGURA; coluna++) {
+            int linha = tabuleiro_soltar(&tabuleiro_bench, 2, rotacao, coluna);
+            if (linha < 0) continue;
+            colocacoes_bench[n].tipo = 2;
+            colocacoes_bench[n].rotacao = (uint8_t)rotacao;
+            colocacoes_bench[n].coluna = (uint8_t)coluna;
+            colocacoes_bench[n].linha = (uint8_t)linha;
+            n++;
+        }
+    }
+    resultado_tabuleiro = n;
+}
+
+static Peca bloco_gerado[BLOCO_GERACAO];
+static void nadaPreparar(void) { }
+static void geradorGerarPeca(void) { bloco_gerado[0] = gerarPeca(); }
+static void geradorGerarN(void) { gerador_gerar_n(&fonte_padrao.gerador, bloco_gerado, BLOCO_GERACAO, &fonte_padrao.proximo_id); }
+
+// IDs de um alocador compartilhado: um fetch_add por bloco de BLOCO_IDS pecas, contra
+// um fetch_add por peca (a forma ingenua de tornar o contador seguro entre threads)
+static AlocadorIds alocador_bench;
+static FontePecas fonte_alocada;
+static void alocadorGerarPeca(void) { bloco_gerado[0] = gerarPecaDe(&fonte_alocada); }
+static void atomicoGerarPeca(void) {
+    bloco_gerado[0].nome = GERADOR_TIPOS[gerador_proximoTipo(&fonte_alocada.gerador)];
+    bloco_gerado[0].id = atomic_fetch_add_explicit(&alocador_bench.proximo, 1, memory_order_relaxed);
+}
+
+// Implementacao anterior de gerarPeca, mantida como referencia de comparacao
+static void randGerarPeca(void) {
+    static const char tipos[] = {'I', 'O', 'T', 'L', 'J', 'S', 'Z'};
+    bloco_gerado[0].nome = tipos[rand() % 7];
+    bloco_gerado[0].id = fonte_padrao.proximo_id++;
+}
+
+static const CasoBench CASOS[] = {
+    {"nucleo",      "enqueue",                 nucleoPrepararFilaVazia,    nucleoEnqueue,        CAP_FILA, 0},
+    {"nucleo",      "dequeue_sem_reabastecer", nucleoPrepararFilaCheia,    nucleoDequeueSimples, CAP_FILA, 0},
+    {"nucleo",      "dequeue_com_reabastecer", nucleoPrepararFilaCheia,    nucleoDequeue,        RODADA_ESTAVEL, 0},
+    {"nucleo",      "push",                    nucleoPrepararPilhaVazia,   nucleoPush,           CAP_PILHA, 0},
+    {"nucleo",      "pop",                     nucleoPrepararPilhaCheia,   nucleoPop,            CAP_PILHA, 0},
+    {"nucleo",      "fila_enqueue_n",          nucleoPrepararFilaVazia,    nucleoEnqueueN,       1, CAP_FILA},
+    {"nucleo",      "fila_dequeue_n",          nucleoPrepararFilaCheia,    nucleoDequeueN,       1, CAP_FILA},
+    {"nucleo",      "pilha_push_n",            nucleoPrepararPilhaVazia,   nucleoPushN,          1, CAP_PILHA},
+    {"nucleo",      "pilha_pop_n",             nucleoPrepararPilhaCheia,   nucleoPopN,           1, CAP_PILHA},
+    {"indice",      "enqueue",                 indicePrepararFilaVazia,    indiceEnqueue,        CAP_FILA, 0},
+    {"indice",      "dequeue_com_reabastecer", indicePrepararFilaCheia,    indiceDequeue,        RODADA_ESTAVEL, 0},
+    {"varredura",   "distancia_tipo_1024",     previsaoPrepararFilaLonga,  varreduraDistanciaTipo, RODADA_ESTAVEL, 0},
+    {"indice",      "distancia_tipo_1024",     previsaoPrepararFilaLonga,  indiceDistanciaTipo,  RODADA_ESTAVEL, 0},
+    {"nucleo",      "trocarPecaUnicaAcao",     nucleoPrepararAmbasCheias,  nucleoTrocaUnica,     RODADA_ESTAVEL, 0},
+    {"nucleo",      "trocarPecasMultiplaAcao", nucleoPrepararAmbasCheias,  nucleoTrocaMultipla,  RODADA_ESTAVEL, 0},
+    {"referencia",  "troca_3x3_temporarios",   nucleoPrepararAmbasCheias,  referenciaTroca3x3,   RODADA_ESTAVEL, 0},
+    {"nucleo",      "fila_pilha_trocar_n",     nucleoPrepararAmbasCheias,  nucleoTrocarN,        RODADA_ESTAVEL, 0},
+    {"referencia",  "troca_3x3_temp_volta",    nucleoPrepararAmbasCheiasVolta, referenciaTroca3x3, RODADA_ESTAVEL, 0},
+    {"nucleo",      "fila_pilha_trocar_volta", nucleoPrepararAmbasCheiasVolta, nucleoTrocarN,    RODADA_ESTAVEL, 0},
+    {"copia",       "tentar_jogar",            nucleoPrepararAmbasCheias,  referenciaJogar,      RODADA_ESTAVEL, 0},
+    {"historico",   "tentar_jogar",            nucleoPrepararAmbasCheias,  historicoJogar,       RODADA_ESTAVEL, 0},
+    {"copia",       "tentar_troca_3x3",        nucleoPrepararAmbasCheias,  referenciaTroca3,     RODADA_ESTAVEL, 0},
+    {"historico",   "tentar_troca_3x3",        nucleoPrepararAmbasCheias,  historicoTroca3,      RODADA_ESTAVEL, 0},
+    {"referencia",  "trocar_trechos_temp",     nadaPreparar,               referenciaTrocarTrechos, 16, BLOCO_TROCA},
+    {"nucleo",      "trocarTrechos",           nadaPreparar,               nucleoTrocarTrechos,  16, BLOCO_TROCA},
+    {"escalar",     "sessoes_jogar",           nadaPreparar,               escalarJogar,         16, NUM_SESSOES_BENCH},
+    {"soa",         "sessoes_jogar",           nadaPreparar,               soaJogar,             16, NUM_SESSOES_BENCH},
+    {"sse4",        "sessoes_jogar",           nadaPreparar,               sse4Jogar,            16, NUM_SESSOES_BENCH},
+    {"avx2",        "sessoes_jogar",           nadaPreparar,               avx2Jogar,            16, NUM_SESSOES_BENCH},
+    {"escalar",     "sessoes_reservar",        sessoesPrepararPilhasVazias, escalarReservar,     CAP_PILHA + 1, NUM_SESSOES_BENCH},
+    {"soa",         "sessoes_reservar",        sessoesPrepararPilhasVazias, soaReservar,         CAP_PILHA + 1, NUM_SESSOES_BENCH},
+    {"sse4",        "sessoes_reservar",        sessoesPrepararPilhasVazias, sse4Reservar,        CAP_PILHA + 1, NUM_SESSOES_BENCH},
+    {"avx2",        "sessoes_reservar",        sessoesPrepararPilhasVazias, avx2Reservar,        CAP_PILHA + 1, NUM_SESSOES_BENCH},
+    {"escalar",     "sessoes_usar",            sessoesPrepararPilhasCheias, escalarUsar,         CAP_PILHA + 1, NUM_SESSOES_BENCH},
+    {"soa",         "sessoes_usar",            sessoesPrepararPilhasCheias, soaUsar,             CAP_PILHA + 1, NUM_SESSOES_BENCH},
+    {"sse4",        "sessoes_usar",            sessoesPrepararPilhasCheias, sse4Usar,            CAP_PILHA + 1, NUM_SESSOES_BENCH},
+    {"avx2",        "sessoes_usar",            sessoesPrepararPilhasCheias, avx2Usar,            CAP_PILHA + 1, NUM_SESSOES_BENCH},
+    {"escalar",     "sessoes_troca",           sessoesPrepararPilhasCheias, escalarTroca,        16, NUM_SESSOES_BENCH},
+    {"soa",         "sessoes_troca",           sessoesPrepararPilhasCheias, soaTroca,            16, NUM_SESSOES_BENCH},
+    {"sse4",        "sessoes_troca",           sessoesPrepararPilhasCheias, sse4Troca,           16, NUM_SESSOES_BENCH},
+    {"avx2",        "sessoes_troca",           sessoesPrepararPilhasCheias, avx2Troca,           16, NUM_SESSOES_BENCH},
+    {"malloc",      "criar_descartar_pilhas",  nadaPreparar,               mallocCriarDescartarPilhas, 16, NUM_PILHAS_BENCH},
+    {"arena",       "criar_descartar_pilhas",  nadaPreparar,               arenaCriarDescartarPilhas,  16, NUM_PILHAS_BENCH},
+    {"arena",       "push_crescendo",          arenaPrepararPilhaCrescente, arenaPushCrescente,  RODADA_ESTAVEL, 0},
+    {"tabuleiro",   "colocar_O",               tabuleiroPrepararVazio,     tabuleiroColocarO,    RODADA_ESTAVEL, 0},
+    {"tabuleiro",   "eliminar_4_linhas",       tabuleiroPrepararQuatroLinhas, tabuleiroLimparQuatro, 1, 0},
+    {"tabuleiro",   "cabe",                    tabuleiroPrepararMeio,      tabuleiroCabe,        RODADA_ESTAVEL, 0},
+    {"referencia",  "colocacoes_por_queda",    tabuleiroPrepararMeio,      referenciaGerarPorQueda, RODADA_ESTAVEL, COLOCACOES_T},
+    {"tabuleiro",   "gerarColocacoes",         tabuleiroPrepararMeio,      tabuleiroGerarColocacoes, RODADA_ESTAVEL, COLOCACOES_T},
+    {"rand",        "gerarPeca",               nadaPreparar,               randGerarPeca,        RODADA_ESTAVEL, 0},
+    {"gerador",     "gerarPeca",               nadaPreparar,               geradorGerarPeca,     RODADA_ESTAVEL, 0},
+    {"atomico",     "gerarPeca_ids",           nadaPreparar,               atomicoGerarPeca,     RODADA_ESTAVEL, 0},
+    {"alocador",    "gerarPeca_ids",           nadaPreparar,               alocadorGerarPeca,    RODADA_ESTAVEL, 0},
+    {"gerador",     "gerar_n",                 nadaPreparar,               geradorGerarN,        16, BLOCO_GERACAO},
+};
+
+
+// --- 3. Medicao ---
+
+static int compararTicks(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentil(const uint64_t *ordenadas, long n, double q) {
+    long idx = (long)(q * (double)(n - 1));
+    return (double)ordenadas[idx] * ns_por_tick;
+}
+
+/**
+ * @brief Custo de uma leitura vazia do relogio, descontado de cada amostra de latencia.
+ */
+static uint64_t medirSobrecarga(void) {
+    uint64_t menor = UINT64_MAX;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t t0 = lerTicks();
+        uint64_t t1 = lerTicks();
+        if (t1 - t0 < menor) menor = t1 - t0;
+    }
+    return menor;
+}
+
+/**
+ * @brief Quantas rodadas de um caso cabem em 'total' itens (ao menos uma).
+ */
+static long rodadasCaso(const CasoBench *c, long total) {
+    long por_rodada = (long)c->por_rodada * (c->unidades > 0 ? c->unidades : 1);
+    return total / por_rodada > 0 ? total / por_rodada : 1;
+}
+
+/**
+ * @brief Executa um caso: uma passada mede a vazao por rodada, outra mede cada chamada.
+ * @param amostras Buffer com espaco para 'total' amostras de latencia.
+ */
+static ResultadoBench medirCaso(const CasoBench *c, long total, uint64_t *amostras, uint64_t sobrecarga) {
+    ResultadoBench r;
+    long rodadas = rodadasCaso(c, total);
+    long n = rodadas * c->por_rodada;
+
+    // Aquecimento
+    for (int i = 0; i < 1000; i++) {
+        c->preparar();
+        for (int j = 0; j < c->por_rodada; j++) c->operar();
+    }
+
+    // Vazao: o tempo de cada rodada inteira, sem o preparo
+    uint64_t ticks_total = 0;
+    for (long i = 0; i < rodadas; i++) {
+        c->preparar();
+        uint64_t t0 = lerTicks();
+        for (int j = 0; j < c->por_rodada; j++) c->operar();
+        uint64_t t1 = lerTicks();
+        ticks_total += (t1 - t0 > sobrecarga) ? t1 - t0 - sobrecarga : 0;
+    }
+    double ns_total = (double)ticks_total * ns_por_tick;
+    double itens = (double)n * (c->unidades > 0 ? c->unidades : 1);
+    r.ops_por_s = ns_total > 0 ? itens / (ns_total / 1e9) : 0.0;
+
+    // Latencia: cada chamada medida individualmente
+    long k = 0;
+    for (long i = 0; i < rodadas; i++) {
+        c->preparar();
+        for (int j = 0; j < c->por_rodada; j++) {
+            uint64_t t0 = lerTicks();
+            c->operar();
+            uint64_t t1 = lerTicks();
+            amostras[k++] = (t1 - t0 > sobrecarga) ? t1 - t0 - sobrecarga : 0;
+        }
+    }
+    qsort(amostras, (size_t)k, sizeof(uint64_t), compararTicks);
+    r.p50_ns = percentil(amostras, k, 0.50);
+    r.p99_ns = percentil(amostras, k, 0.99);
+    r.p999_ns = percentil(amostras, k, 0.999);
+    return r;
+}
+
+
+// --- Funcao Principal ---
+
+int main(int argc, char *argv[]) {
+    long total = 1L << 20;
+    const char *caminho_csv = "bench.csv";
+    const char *rotulo = "local";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            total = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            caminho_csv = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            rotulo = argv[++i];
+        } else {
+            fprintf(stderr, "Uso: %s [-n operacoes] [-o arquivo.csv] [-r rotulo]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (total < RODADA_ESTAVEL) total = RODADA_ESTAVEL;
+
+    FILE *csv = fopen(caminho_csv, "a");
+    if (!csv) {
+        perror(caminho_csv);
+        return 1;
+    }
+    if (ftell(csv) == 0) {
+        fprintf(csv, "rotulo,implementacao,operacao,amostras,ops_por_s,p50_ns,p99_ns,p999_ns\n");
+    }
+
+    uint64_t *amostras = malloc((size_t)total * sizeof(uint64_t));
+    if (!amostras) {
+        fprintf(stderr, "Sem memoria para %ld amostras.\n", total);
+        return 1;
+    }
+
+    if (!criarFila(&fila_bench, CAP_FILA) || !criarPilha(&pilha_bench, arena_daThread(), CAP_PILHA, 0)) {
+        fprintf(stderr, "Sem memoria para a fila e a pilha.\n");
+        return 1;
+    }
+
+    if (!criarFila(&fila_indexada, CAP_FILA) || !indexarFila(&fila_indexada) ||
+        !criarFila(&fila_longa, CAP_FILA_LONGA) || !indexarFila(&fila_longa)) {
+        fprintf(stderr, "Sem memoria para as filas indexadas.\n");
+        return 1;
+    }
+
+    tabuleiro_inicializar(&tabuleiro_bench, TABULEIRO_LARGURA, TABULEIRO_ALTURA);
+
+    if (!sessoes_criar(&sessoes_bench, arena_daThread(), NUM_SESSOES_BENCH, CAP_FILA, CAP_PILHA)) {
+        fprintf(stderr, "Sem memoria para as sessoes em estrutura de arrays.\n");
+        return 1;
+    }
+    if (!conferirSessoes()) return 1;
+    fprintf(stderr, "sessoes: nucleos ate %s conferem com executarAcao (%d sessoes)\n",
+            sessoes_nomeImplementacao(sessoes_melhorImplementacao()), NUM_SESSOES_BENCH);
+
+    inicializarFonte(&fonte_padrao, 1, GERADOR_UNIFORME);
+    inicializarFonte(&fonte_alocada, 1, GERADOR_UNIFORME);
+    inicializarAlocadorIds(&alocador_bench, 0);
+    usarAlocadorIds(&fonte_alocada, &alocador_bench);
+    calibrarRelogio();
+    uint64_t sobrecarga = medirSobrecarga();
+
+    fprintf(stderr, "%-12s %-24s %14s %10s %10s %10s\n", "impl", "operacao", "ops/s", "p50(ns)", "p99(ns)", "p99.9(ns)");
+    for (size_t i = 0; i < sizeof(CASOS) / sizeof(CASOS[0]); i++) {
+        const CasoBench *c = &CASOS[i];
+        ResultadoBench r = medirCaso(c, total, amostras, sobrecarga);
+        long n = rodadasCaso(c, total) * c->por_rodada;
+        fprintf(stderr, "%-12s %-24s %14.0f %10.1f %10.1f %10.1f\n",
+                c->implementacao, c->operacao, r.ops_por_s, r.p50_ns, r.p99_ns, r.p999_ns);
+        fprintf(csv, "%s,%s,%s,%ld,%.0f,%.1f,%.1f,%.1f\n",
+                rotulo, c->implementacao, c->operacao, n, r.ops_por_s, r.p50_ns, r.p99_ns, r.p999_ns);
+    }
+
+    destruirFila(&fila_bench);
+    destruirFila(&fila_indexada);
+    destruirFila(&fila_longa);
+    arena_liberar(&arena_pilhas);
+    arena_liberar(arena_daThread());
+    free(amostras);
+    fclose(csv);
+    return 0;
+}
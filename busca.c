@@ -0,0 +1,571 @@
+// Busca da melhor sequencia de acoes (ver busca.h).
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "busca.h"
+#include "historico.h"
+
+// Semente fixa das chaves Zobrist: as chaves (e as estatisticas da tabela) se repetem
+// entre execucoes
+#define BUSCA_SEMENTE_ZOBRIST 0x5A0B6157ULL
+
+#define DADO_VALIDO (1ULL << 63)
+
+// Valores internos da busca: cada ponto vale BUSCA_ESCALA_PONTOS, mais um bonus pelas
+// acoes que ainda faltavam quando ele veio. Entre sequencias com os mesmos pontos vence
+// a que pontua antes; sem isso o jogador automatico adiaria para sempre um ponto que
+// continua ao alcance do horizonte. O bonus total (ate 64 * 65 / 2) fica abaixo de um ponto.
+#define BUSCA_ESCALA_PONTOS 4096
+
+// Sessao copiada para a busca. Os ponteiros internos (elementos e fonte) apontam para
+// o proprio no; copiarNo() os refaz a cada copia.
+typedef struct {
+    Fila fila;
+    Pilha pilha;
+    FontePecas fonte;
+    int progresso; // OBJETIVO_SEQUENCIA: pecas do alvo ja acertadas
+    Peca armazenamento_fila[BUSCA_MAX_FILA];
+    Peca armazenamento_pilha[BUSCA_MAX_PILHA];
+} NoBusca;
+
+// Tarefa da raiz: o no depois de um prefixo de ate BUSCA_NIVEIS_DIVISAO acoes
+typedef struct {
+    NoBusca no;
+    int pontos_prefixo; // Valor interno das acoes do prefixo
+    int tam_prefixo;
+    uint8_t prefixo[BUSCA_NIVEIS_DIVISAO];
+    int restante;    // Acoes que a tarefa ainda escolhe
+    int valor;       // Melhor valor interno depois do prefixo (ver pontosInternos)
+    int tamanho;     // Feixe: acoes em 'acoes'
+    uint8_t acoes[BUSCA_MAX_PROFUNDIDADE];
+} TarefaBusca;
+
+// Sessao do feixe e as acoes que levaram ate ela
+typedef struct {
+    NoBusca no;
+    int pontos;
+    uint8_t acoes[BUSCA_MAX_PROFUNDIDADE];
+} CandidatoFeixe;
+
+typedef struct {
+    Buscador *b;
+    TarefaBusca *tarefas;
+    int num_tarefas;
+    _Atomic int *proxima;
+    int falhou;             // Feixe: faltou memoria
+    uint64_t nos;
+    uint64_t consultas;
+    uint64_t acertos;
+} TrabalhadorBusca;
+
+
+// --- 1. Estado e Chaves ---
+
+static uint64_t misturar64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void copiarNo(NoBusca *destino, const NoBusca *origem) {
+    destino->fila = origem->fila;
+    destino->fila.elementos = destino->armazenamento_fila;
+    destino->fila.fonte = &destino->fonte;
+    destino->pilha = origem->pilha;
+    destino->pilha.elementos = destino->armazenamento_pilha;
+    destino->fonte = origem->fonte;
+    destino->progresso = origem->progresso;
+    memcpy(destino->armazenamento_fila, origem->armazenamento_fila,
+           (origem->fila.mascara + 1) * sizeof(Peca));
+    memcpy(destino->armazenamento_pilha, origem->armazenamento_pilha,
+           (size_t)(origem->pilha.topo + 1) * sizeof(Peca));
+}
+
+/**
+ * @brief Copia a sessao do jogo para a raiz da busca.
+ * @return 0 se a sessao nao cabe na busca (fila ou pilha grandes demais, pilha que
+ * cresce ou pecas vindas do produtor).
+ */
+static int prepararRaiz(NoBusca *raiz, const Fila *f, const Pilha *p, int progresso) {
+    Peca janela[BUSCA_MAX_FILA];
+
+    if (fila_tamanhoArmazenamento(f->limite) > BUSCA_MAX_FILA || p->capacidade > BUSCA_MAX_PILHA ||
+        p->crescer || f->fonte->produtor) {
+        return 0;
+    }
+
+    // IDs proprios da copia: a busca nao reserva blocos do alocador compartilhado
+    raiz->fonte = *f->fonte;
+    raiz->fonte.alocador = NULL;
+    raiz->fonte.fim_bloco = INT64_MAX;
+    raiz->progresso = progresso;
+
+    criarFilaEm(&raiz->fila, raiz->armazenamento_fila, f->limite);
+    raiz->fila.fonte = &raiz->fonte;
+    fila_enqueue_n(&raiz->fila, janela, fila_peek_n(f, janela, BUSCA_MAX_FILA));
+
+    criarPilhaEm(&raiz->pilha, raiz->armazenamento_pilha, p->capacidade);
+    memcpy(raiz->armazenamento_pilha, p->elementos, (size_t)(p->topo + 1) * sizeof(Peca));
+    raiz->pilha.topo = p->topo;
+    return 1;
+}
+
+/**
+ * @brief Chave Zobrist do no: tipos da fila (a partir da frente) e da pilha (a partir
+ * da base), estado do gerador, progresso no alvo e acoes restantes.
+ * Os IDs nao entram: dependem so de quantas pecas o gerador ja entregou.
+ */
+static uint64_t chaveNo(const Buscador *b, const NoBusca *no, int restante) {
+    uint64_t chave = b->zob_restante[restante];
+    const Fila *f = &no->fila;
+
+    for (uint32_t c = 0; c < fila_tamanho(f); c++) {
+        chave ^= b->zob_fila[c][tipoIndice(f->elementos[(f->cabeca + c) & f->mascara].nome)];
+    }
+    for (int j = 0; j <= no->pilha.topo; j++) {
+        chave ^= b->zob_pilha[j][tipoIndice(no->pilha.elementos[j].nome)];
+    }
+    // No modo GERADOR_SACO7 o xoshiro so anda quando um saco novo e embaralhado: ele
+    // determina o conteudo do saco, mas nao quantas pecas dele ainda faltam
+    const GeradorPecas *g = &no->fonte.gerador;
+    const uint64_t *s = g->s;
+    chave ^= misturar64(s[0]) ^ misturar64(s[1] + 1) ^ misturar64(s[2] + 2) ^ misturar64(s[3] + 3);
+    chave ^= misturar64(((uint64_t)g->restantes << 8) | ((uint64_t)g->modo << 16) | 0x5C);
+    chave ^= misturar64(((uint64_t)no->progresso << 8) | 0x9D);
+    return chave;
+}
+
+/**
+ * @brief Pontos de uma acao aplicada, avancando o progresso no alvo.
+ */
+int busca_pontos(const ObjetivoBusca *o, const EventoAcao *ev, int *progresso) {
+    if (ev->resultado != ACAO_OK || (ev->codigo != 1 && ev->codigo != 3)) return 0;
+
+    if (o->tipo == OBJETIVO_PESOS) {
+        int t = tipoIndice(ev->peca.nome);
+        return t < GERADOR_NUM_TIPOS ? o->pesos[t] : 0;
+    }
+    if (*progresso < o->tamanho_alvo && o->alvo[*progresso] == ev->peca.nome) {
+        (*progresso)++;
+        return 1;
+    }
+    return 0;
+}
+
+static int pontosInternos(int pontos, int restante) {
+    return pontos * BUSCA_ESCALA_PONTOS + (pontos > 0 ? restante : 0);
+}
+
+/**
+ * @brief Copia 'no' para 'filho' e aplica a acao.
+ * @return 1 se a acao foi aplicada (pontos em *pontos), 0 se ela falhou nesse estado.
+ */
+static int expandir(const Buscador *b, const NoBusca *no, NoBusca *filho, int acao, int *pontos) {
+    EventoAcao ev;
+
+    copiarNo(filho, no);
+    if (executarAcao(acao, &filho->fila, &filho->pilha, &ev) != ACAO_OK) return 0;
+    *pontos = busca_pontos(&b->config.objetivo, &ev, &filho->progresso);
+    return 1;
+}
+
+
+// --- 2. Tabela de Transposicao ---
+
+static int consultarTabela(const Buscador *b, uint64_t chave, int *valor) {
+    EntradaTabela *e = &b->tabela[chave & b->mascara_tabela];
+    uint64_t dado = atomic_load_explicit(&e->dado, memory_order_relaxed);
+    uint64_t verificacao = atomic_load_explicit(&e->verificacao, memory_order_relaxed);
+
+    if (!(dado & DADO_VALIDO) || (verificacao ^ dado) != chave) return 0;
+    *valor = (int32_t)(uint32_t)dado;
+    return 1;
+}
+
+static void gravarTabela(Buscador *b, uint64_t chave, int valor) {
+    EntradaTabela *e = &b->tabela[chave & b->mascara_tabela];
+    uint64_t dado = DADO_VALIDO | (uint32_t)valor;
+
+    atomic_store_explicit(&e->verificacao, chave ^ dado, memory_order_relaxed);
+    atomic_store_explicit(&e->dado, dado, memory_order_relaxed);
+}
+
+
+// --- 3. Busca em Profundidade Limitada ---
+
+/**
+ * @brief Melhores pontos que 'restante' acoes conseguem a partir de 'no'.
+ * Um estado sem acao possivel vale 0. Os filhos sao visitados no proprio no: cada acao
+ * e aplicada e desfeita (historico.h), sem copiar a sessao.
+ */
+static int avaliarNo(TrabalhadorBusca *t, NoBusca *no, int restante) {
+    Buscador *b = t->b;
+    uint64_t chave = 0;
+    int valor;
+
+    if (restante == 0) return 0;
+    if (b->tabela) {
+        chave = chaveNo(b, no, restante);
+        t->consultas++;
+        if (consultarTabela(b, chave, &valor)) {
+            t->acertos++;
+            return valor;
+        }
+    }
+
+    t->nos++;
+    DeltaAcao delta;
+    EventoAcao ev;
+    int progresso = no->progresso;
+    int algum = 0;
+    valor = 0;
+    for (int acao = 1; acao <= 5; acao++) {
+        if (historico_aplicar(&delta, acao, &no->fila, &no->pilha, &ev) != ACAO_OK) continue;
+        int pontos = busca_pontos(&b->config.objetivo, &ev, &no->progresso);
+        int v = pontosInternos(pontos, restante) + avaliarNo(t, no, restante - 1);
+        historico_reverter(&delta, &no->fila, &no->pilha);
+        no->progresso = progresso;
+        if (!algum || v > valor) valor = v;
+        algum = 1;
+    }
+
+    if (b->tabela) gravarTabela(b, chave, valor);
+    return valor;
+}
+
+/**
+ * @brief Refaz a sequencia de uma tarefa: em cada nivel, a primeira acao cujo filho
+ * atinge o valor que ainda falta (quase sempre um acerto na tabela).
+ */
+static void reconstruirSequencia(TrabalhadorBusca *t, TarefaBusca *tarefa) {
+    NoBusca no, filho;
+    int falta = tarefa->valor;
+
+    copiarNo(&no, &tarefa->no);
+    tarefa->tamanho = 0;
+    for (int restante = tarefa->restante; restante > 0; restante--) {
+        int pontos;
+        int acao;
+        for (acao = 1; acao <= 5; acao++) {
+            if (!expandir(t->b, &no, &filho, acao, &pontos)) continue;
+            if (pontosInternos(pontos, restante) + avaliarNo(t, &filho, restante - 1) == falta) break;
+        }
+        if (acao > 5) break; // Sem acao possivel
+        tarefa->acoes[tarefa->tamanho++] = (uint8_t)acao;
+        falta -= pontosInternos(pontos, restante);
+        copiarNo(&no, &filho);
+    }
+}
+
+
+// --- 4. Busca em Feixe ---
+
+// Candidatos do proximo nivel, em ordem de pontos (desempate: ordem de geracao).
+// qsort nao recebe contexto, entao o vetor fica em uma variavel da thread.
+static _Thread_local const CandidatoFeixe *candidatos_ordenacao;
+
+static int compararCandidatos(const void *a, const void *b) {
+    uint32_t i = *(const uint32_t *)a, j = *(const uint32_t *)b;
+    int pi = candidatos_ordenacao[i].pontos, pj = candidatos_ordenacao[j].pontos;
+    if (pi != pj) return pi > pj ? -1 : 1;
+    return i < j ? -1 : (i > j);
+}
+
+/**
+ * @brief Insere a chave no conjunto do nivel (enderecamento aberto, 0 = vazio).
+ * @return 0 se a chave ja estava la.
+ */
+static int inserirChave(uint64_t *conjunto, uint64_t mascara, uint64_t chave) {
+    if (chave == 0) chave = 1;
+    for (uint64_t i = chave & mascara; ; i = (i + 1) & mascara) {
+        if (conjunto[i] == chave) return 0;
+        if (conjunto[i] == 0) {
+            conjunto[i] = chave;
+            return 1;
+        }
+    }
+}
+
+static void feixeTarefa(TrabalhadorBusca *t, TarefaBusca *tarefa, CandidatoFeixe *atual, CandidatoFeixe *proximos,
+                        uint32_t *ordem, uint64_t *conjunto, uint64_t mascara_conjunto) {
+    Buscador *b = t->b;
+    int largura = b->config.largura;
+    int n_atual = 1;
+    int melhor_pontos = 0, melhor_tamanho = 0, tem_melhor = 0;
+
+    copiarNo(&atual[0].no, &tarefa->no);
+    atual[0].pontos = 0;
+
+    for (int nivel = 0; nivel < tarefa->restante; nivel++) {
+        int n_proximos = 0;
+        for (int i = 0; i < n_atual; i++) {
+            int filhos = 0;
+            t->nos++;
+            for (int acao = 1; acao <= 5; acao++) {
+                CandidatoFeixe *c = &proximos[n_proximos];
+                int pontos;
+                if (!expandir(b, &atual[i].no, &c->no, acao, &pontos)) continue;
+                c->pontos = atual[i].pontos + pontosInternos(pontos, tarefa->restante - nivel);
+                memcpy(c->acoes, atual[i].acoes, (size_t)nivel);
+                c->acoes[nivel] = (uint8_t)acao;
+                n_proximos++;
+                filhos++;
+            }
+            // Sessao sem acao possivel: termina aqui
+            if (filhos == 0 && (!tem_melhor || atual[i].pontos > melhor_pontos)) {
+                melhor_pontos = atual[i].pontos;
+                melhor_tamanho = nivel;
+                memcpy(tarefa->acoes, atual[i].acoes, (size_t)nivel);
+                tem_melhor = 1;
+            }
+        }
+        if (n_proximos == 0) {
+            n_atual = 0;
+            break;
+        }
+
+        for (int i = 0; i < n_proximos; i++) ordem[i] = (uint32_t)i;
+        candidatos_ordenacao = proximos;
+        qsort(ordem, (size_t)n_proximos, sizeof(uint32_t), compararCandidatos);
+
+        // Os 'largura' melhores, cada estado uma vez so (o de mais pontos)
+        memset(conjunto, 0, (mascara_conjunto + 1) * sizeof(uint64_t));
+        n_atual = 0;
+        for (int k = 0; k < n_proximos && n_atual < largura; k++) {
+            const CandidatoFeixe *c = &proximos[ordem[k]];
+            t->consultas++;
+            if (!inserirChave(conjunto, mascara_conjunto, chaveNo(b, &c->no, 0))) {
+                t->acertos++;
+                continue;
+            }
+            copiarNo(&atual[n_atual].no, &c->no);
+            atual[n_atual].pontos = c->pontos;
+            memcpy(atual[n_atual].acoes, c->acoes, (size_t)nivel + 1);
+            n_atual++;
+        }
+    }
+
+    // 'atual' esta em ordem de pontos: o primeiro e o melhor do ultimo nivel
+    if (n_atual > 0 && (!tem_melhor || atual[0].pontos > melhor_pontos)) {
+        melhor_pontos = atual[0].pontos;
+        melhor_tamanho = tarefa->restante;
+        memcpy(tarefa->acoes, atual[0].acoes, (size_t)melhor_tamanho);
+    }
+    tarefa->valor = melhor_pontos;
+    tarefa->tamanho = melhor_tamanho;
+}
+
+
+// --- 5. Divisao da Raiz entre Threads ---
+
+static void *lacoBusca(void *arg) {
+    TrabalhadorBusca *t = arg;
+    const ConfigBusca *cfg = &t->b->config;
+    CandidatoFeixe *atual = NULL, *proximos = NULL;
+    uint32_t *ordem = NULL;
+    uint64_t *conjunto = NULL;
+    uint64_t mascara_conjunto = 0;
+
+    if (cfg->algoritmo == BUSCA_FEIXE) {
+        size_t n = (size_t)cfg->largura * 5;
+        uint64_t tamanho_conjunto = 1;
+        while (tamanho_conjunto < 2 * (uint64_t)cfg->largura) tamanho_conjunto <<= 1;
+        mascara_conjunto = tamanho_conjunto - 1;
+        atual = malloc((size_t)cfg->largura * sizeof(CandidatoFeixe));
+        proximos = malloc(n * sizeof(CandidatoFeixe));
+        ordem = malloc(n * sizeof(uint32_t));
+        conjunto = malloc(tamanho_conjunto * sizeof(uint64_t));
+        if (!atual || !proximos || !ordem || !conjunto) {
+            t->falhou = 1;
+            free(atual);
+            free(proximos);
+            free(ordem);
+            free(conjunto);
+            return NULL;
+        }
+    }
+
+    int i;
+    while ((i = atomic_fetch_add_explicit(t->proxima, 1, memory_order_relaxed)) < t->num_tarefas) {
+        TarefaBusca *tarefa = &t->tarefas[i];
+        if (cfg->algoritmo == BUSCA_FEIXE) {
+            feixeTarefa(t, tarefa, atual, proximos, ordem, conjunto, mascara_conjunto);
+        } else {
+            tarefa->valor = avaliarNo(t, &tarefa->no, tarefa->restante);
+        }
+    }
+
+    free(atual);
+    free(proximos);
+    free(ordem);
+    free(conjunto);
+    return NULL;
+}
+
+/**
+ * @brief Gera as tarefas da raiz: cada sequencia valida de BUSCA_NIVEIS_DIVISAO acoes
+ * (ou menos, se a profundidade for menor ou o estado ficar sem acao), em ordem de codigo.
+ */
+static void gerarTarefas(TrabalhadorBusca *t, const NoBusca *no, TarefaBusca *base, int nivel, int limite,
+                         TarefaBusca *tarefas, int *num_tarefas) {
+    TarefaBusca *tarefa = &tarefas[*num_tarefas];
+    int algum = 0;
+
+    if (nivel < limite) {
+        t->nos++;
+        for (int acao = 1; acao <= 5; acao++) {
+            NoBusca filho;
+            int pontos;
+            if (!expandir(t->b, no, &filho, acao, &pontos)) continue;
+            base->prefixo[nivel] = (uint8_t)acao;
+            int interno = pontosInternos(pontos, t->b->config.profundidade - nivel);
+            base->pontos_prefixo += interno;
+            gerarTarefas(t, &filho, base, nivel + 1, limite, tarefas, num_tarefas);
+            base->pontos_prefixo -= interno;
+            algum = 1;
+        }
+    }
+    if (algum) return;
+
+    tarefa->pontos_prefixo = base->pontos_prefixo;
+    tarefa->tam_prefixo = nivel;
+    memcpy(tarefa->prefixo, base->prefixo, (size_t)nivel);
+    tarefa->restante = nivel < limite ? 0 : t->b->config.profundidade - nivel;
+    tarefa->tamanho = 0;
+    copiarNo(&tarefa->no, no);
+    (*num_tarefas)++;
+}
+
+
+// --- 6. Interface ---
+
+/**
+ * @brief Valida a configuracao, aloca a tabela de transposicao e sorteia as chaves Zobrist.
+ * A tabela continua valida entre chamadas de buscarAcoes() com o mesmo buscador.
+ * @return 1 em caso de sucesso, 0 se a configuracao e invalida ou faltou memoria.
+ */
+int criarBuscador(Buscador *b, const ConfigBusca *config) {
+    if (config->profundidade < 1 || config->profundidade > BUSCA_MAX_PROFUNDIDADE ||
+        config->threads < 1 || config->threads > BUSCA_MAX_THREADS ||
+        config->bits_tabela < 0 || config->bits_tabela > 30 ||
+        (config->algoritmo == BUSCA_FEIXE && (config->largura < 1 || config->largura > (1 << 20))) ||
+        config->objetivo.tamanho_alvo < 0 || config->objetivo.tamanho_alvo > BUSCA_MAX_ALVO) {
+        return 0;
+    }
+    for (int t = 0; t < GERADOR_NUM_TIPOS; t++) {
+        if (config->objetivo.pesos[t] < -BUSCA_MAX_PESO || config->objetivo.pesos[t] > BUSCA_MAX_PESO) return 0;
+    }
+
+    b->config = *config;
+    b->tabela = NULL;
+    b->mascara_tabela = 0;
+    if (config->bits_tabela > 0) {
+        b->tabela = calloc((size_t)1 << config->bits_tabela, sizeof(EntradaTabela));
+        if (!b->tabela) return 0;
+        b->mascara_tabela = ((uint64_t)1 << config->bits_tabela) - 1;
+    }
+
+    uint64_t estado = BUSCA_SEMENTE_ZOBRIST;
+    for (int i = 0; i < BUSCA_MAX_FILA; i++) {
+        for (int t = 0; t < INDICE_TIPOS; t++) b->zob_fila[i][t] = misturar64(estado += 0x9E3779B97F4A7C15ULL);
+    }
+    for (int i = 0; i < BUSCA_MAX_PILHA; i++) {
+        for (int t = 0; t < INDICE_TIPOS; t++) b->zob_pilha[i][t] = misturar64(estado += 0x9E3779B97F4A7C15ULL);
+    }
+    for (int i = 0; i <= BUSCA_MAX_PROFUNDIDADE; i++) {
+        b->zob_restante[i] = misturar64(estado += 0x9E3779B97F4A7C15ULL);
+    }
+    return 1;
+}
+
+void destruirBuscador(Buscador *b) {
+    free(b->tabela);
+    b->tabela = NULL;
+}
+
+/**
+ * @brief Procura a melhor sequencia de ate config.profundidade acoes a partir da sessao
+ * (f, p), que nao e alterada. Em empate vence a sequencia de menores codigos.
+ * @param progresso OBJETIVO_SEQUENCIA: pecas do alvo ja acertadas antes desta busca.
+ * @return 1 em caso de sucesso, 0 se a sessao nao cabe na busca ou faltou memoria.
+ */
+int buscarAcoes(Buscador *b, const Fila *f, const Pilha *p, int progresso, ResultadoBusca *r) {
+    NoBusca raiz;
+    TarefaBusca tarefas[25]; // 5^BUSCA_NIVEIS_DIVISAO
+    TrabalhadorBusca trabalhadores[BUSCA_MAX_THREADS];
+    pthread_t threads[BUSCA_MAX_THREADS];
+    _Atomic int proxima = 0;
+    struct timespec t0, t1;
+    int num_tarefas = 0;
+
+    memset(r, 0, sizeof(*r));
+    if (!prepararRaiz(&raiz, f, p, progresso)) return 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    memset(trabalhadores, 0, sizeof(trabalhadores));
+    trabalhadores[0].b = b;
+    trabalhadores[0].proxima = &proxima;
+    TarefaBusca base;
+    base.pontos_prefixo = 0;
+    int niveis = b->config.profundidade < BUSCA_NIVEIS_DIVISAO ? b->config.profundidade : BUSCA_NIVEIS_DIVISAO;
+    gerarTarefas(&trabalhadores[0], &raiz, &base, 0, niveis, tarefas, &num_tarefas);
+
+    int num_threads = b->config.threads < num_tarefas ? b->config.threads : num_tarefas;
+    if (num_threads < 1) num_threads = 1;
+    for (int i = 0; i < num_threads; i++) {
+        trabalhadores[i].b = b;
+        trabalhadores[i].tarefas = tarefas;
+        trabalhadores[i].num_tarefas = num_tarefas;
+        trabalhadores[i].proxima = &proxima;
+        if (i > 0 && pthread_create(&threads[i], NULL, lacoBusca, &trabalhadores[i]) != 0) {
+            num_threads = i; // Segue com as threads que ja iniciaram
+            break;
+        }
+    }
+    lacoBusca(&trabalhadores[0]); // A thread que chamou tambem busca
+
+    int falhou = 0;
+    for (int i = 0; i < num_threads; i++) {
+        if (i > 0) pthread_join(threads[i], NULL);
+        falhou |= trabalhadores[i].falhou;
+    }
+
+    // Melhor tarefa; em empate, a primeira (prefixo de menores codigos)
+    int melhor = -1, melhor_valor = 0;
+    for (int i = 0; i < num_tarefas; i++) {
+        int total = tarefas[i].pontos_prefixo + tarefas[i].valor;
+        if (melhor < 0 || total > melhor_valor) {
+            melhor = i;
+            melhor_valor = total;
+        }
+    }
+    if (melhor >= 0) {
+        TarefaBusca *tarefa = &tarefas[melhor];
+        if (b->config.algoritmo == BUSCA_PROFUNDIDADE) reconstruirSequencia(&trabalhadores[0], tarefa);
+        memcpy(r->acoes, tarefa->prefixo, (size_t)tarefa->tam_prefixo);
+        memcpy(r->acoes + tarefa->tam_prefixo, tarefa->acoes, (size_t)tarefa->tamanho);
+        r->tamanho = tarefa->tam_prefixo + tarefa->tamanho;
+    }
+
+    // Pontos reais da sequencia (sem o bonus de desempate)
+    NoBusca no, filho;
+    copiarNo(&no, &raiz);
+    for (int k = 0; k < r->tamanho; k++) {
+        int pontos = 0;
+        expandir(b, &no, &filho, r->acoes[k], &pontos);
+        r->pontos += pontos;
+        copiarNo(&no, &filho);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    for (int i = 0; i < num_threads; i++) {
+        r->nos += trabalhadores[i].nos;
+        r->consultas += trabalhadores[i].consultas;
+        r->acertos += trabalhadores[i].acertos;
+    }
+    r->segundos = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    return !falhou;
+}
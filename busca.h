@@ -0,0 +1,90 @@
+// Busca da melhor sequencia das cinco acoes do mestre (jogar, reservar, usar, trocar
+// e trocar 3) para as pecas que a sessao ainda vai receber, segundo um objetivo.
+//
+// Cada no da busca e uma copia pequena da sessao (fila, pilha e fonte sobre
+// armazenamento proprio) e os filhos sao gerados com executarAcao(): a sequencia
+// encontrada e exatamente a que o jogo reproduz com a mesma semente. Dois algoritmos:
+//   - profundidade limitada: busca exata ate 'profundidade' acoes, com uma tabela de
+//     transposicao (chave Zobrist) que avalia uma vez so cada estado repetido; a
+//     recursao aplica e desfaz cada acao no mesmo no (historico.h), sem copias;
+//   - feixe: a cada nivel ficam as 'largura' melhores sessoes, sem repetir estados.
+// As primeiras BUSCA_NIVEIS_DIVISAO acoes formam as tarefas da raiz, divididas entre
+// as threads; o resultado nao depende do numero de threads. Entre sequencias com os
+// mesmos pontos, a busca prefere a que pontua mais cedo.
+
+#ifndef BUSCA_H
+#define BUSCA_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "pecas.h"
+
+#define BUSCA_MAX_FILA 32          // Maior fila aceita (armazenamento do no, potencia de dois)
+#define BUSCA_MAX_PILHA 16         // Maior pilha aceita (capacidade fixa)
+#define BUSCA_MAX_PROFUNDIDADE 64  // Acoes por sequencia
+#define BUSCA_MAX_ALVO 255         // Tamanho maximo da sequencia alvo
+#define BUSCA_MAX_PESO 1000        // Pesos de OBJETIVO_PESOS em [-BUSCA_MAX_PESO, BUSCA_MAX_PESO]
+#define BUSCA_MAX_THREADS 64
+#define BUSCA_NIVEIS_DIVISAO 2     // Acoes da raiz que definem cada tarefa (ate 5^2 tarefas)
+
+typedef enum {
+    BUSCA_PROFUNDIDADE = 0, // Exata ate a profundidade, com tabela de transposicao
+    BUSCA_FEIXE = 1         // Beam search com 'largura' estados por nivel
+} AlgoritmoBusca;
+
+// O que a busca maximiza. Pontuam as pecas que saem do jogo: a jogada (acao 1) e a
+// reserva usada (acao 3).
+typedef enum {
+    OBJETIVO_PESOS = 0,     // Soma de pesos[tipo] das pecas jogadas ou usadas
+    OBJETIVO_SEQUENCIA = 1  // Um ponto por peca que segue 'alvo' na ordem (as demais nao contam)
+} TipoObjetivo;
+
+typedef struct {
+    TipoObjetivo tipo;
+    int pesos[GERADOR_NUM_TIPOS];    // Na ordem de GERADOR_TIPOS (limite BUSCA_MAX_PESO)
+    char alvo[BUSCA_MAX_ALVO + 1];   // Tipos esperados, ex.: "IITZ"
+    int tamanho_alvo;
+} ObjetivoBusca;
+
+typedef struct {
+    AlgoritmoBusca algoritmo;
+    int profundidade; // Acoes por sequencia (1 a BUSCA_MAX_PROFUNDIDADE)
+    int largura;      // Feixe: sessoes mantidas por nivel
+    int threads;      // 1 a BUSCA_MAX_THREADS
+    int bits_tabela;  // Tabela de transposicao com 2^bits entradas (0: sem tabela)
+    ObjetivoBusca objetivo;
+} ConfigBusca;
+
+// Entrada da tabela de transposicao, lida e escrita sem trava: 'verificacao' guarda
+// chave ^ dado, entao uma entrada meio escrita por outra thread nao confere e e ignorada
+typedef struct {
+    _Atomic uint64_t verificacao;
+    _Atomic uint64_t dado;
+} EntradaTabela;
+
+typedef struct {
+    ConfigBusca config;
+    EntradaTabela *tabela;  // NULL se bits_tabela == 0
+    uint64_t mascara_tabela;
+    uint64_t zob_fila[BUSCA_MAX_FILA][INDICE_TIPOS];   // Tipo em cada posicao a partir da frente
+    uint64_t zob_pilha[BUSCA_MAX_PILHA][INDICE_TIPOS]; // Tipo em cada posicao a partir da base
+    uint64_t zob_restante[BUSCA_MAX_PROFUNDIDADE + 1]; // Acoes que ainda faltam
+} Buscador;
+
+typedef struct {
+    int pontos;        // Valor da melhor sequencia
+    int tamanho;       // Acoes em 'acoes'
+    uint8_t acoes[BUSCA_MAX_PROFUNDIDADE]; // Codigos 1-5
+    uint64_t nos;        // Estados expandidos
+    uint64_t consultas;  // Consultas a tabela (profundidade) ou estados gerados (feixe)
+    uint64_t acertos;    // Consultas que evitaram expandir um estado de novo
+    double segundos;
+} ResultadoBusca;
+
+int criarBuscador(Buscador *b, const ConfigBusca *config);
+void destruirBuscador(Buscador *b);
+int buscarAcoes(Buscador *b, const Fila *f, const Pilha *p, int progresso, ResultadoBusca *r);
+int busca_pontos(const ObjetivoBusca *o, const EventoAcao *ev, int *progresso);
+
+#endif // BUSCA_H
@@ -0,0 +1,227 @@
+// Jogador automatico: escolhe as acoes do mestre com a busca de busca.h.
+//
+// Sem --passos, faz uma busca a partir da fila inicial e mostra a melhor sequencia.
+// Com --passos N, joga N acoes: a cada passo busca de novo a partir do estado atual e
+// aplica a primeira acao da melhor sequencia (horizonte deslizante). A tabela de
+// transposicao e mantida entre os passos. As acoes jogadas podem ser gravadas com
+// --roteiro e reproduzidas por "mestre --semente S --lote arquivo", que chega ao
+// mesmo hash. --conferir repete a busca (profundidade, sem --passos) sem a tabela de
+// transposicao e falha se os pontos forem diferentes: a tabela nao pode mudar o resultado.
+//
+// Compilar: make buscar
+// Uso:      buscar [--semente S] [--saco7] [--fila N] [--pilha N] [--profundidade D]
+//                  [--feixe L] [-t threads] [--tabela bits] [--pesos I=4,T=2,...]
+//                  [--alvo SEQUENCIA] [--passos N] [--roteiro arquivo] [--conferir]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pecas.h"
+#include "busca.h"
+
+#define BITS_TABELA_PADRAO 20
+
+/**
+ * @brief Le "I=4,T=2,...": pesos por tipo (os tipos ausentes valem 0).
+ * @return 0 se o texto e invalido.
+ */
+static int lerPesos(const char *texto, int pesos[GERADOR_NUM_TIPOS]) {
+    memset(pesos, 0, GERADOR_NUM_TIPOS * sizeof(int));
+    while (*texto) {
+        int t = tipoIndice(*texto);
+        if (t >= GERADOR_NUM_TIPOS || GERADOR_TIPOS[t] != *texto || texto[1] != '=') return 0;
+        char *fim;
+        pesos[t] = (int)strtol(texto + 2, &fim, 10);
+        if (fim == texto + 2) return 0;
+        texto = fim;
+        if (*texto == ',') texto++;
+    }
+    return 1;
+}
+
+static int lerAlvo(const char *texto, ObjetivoBusca *o) {
+    size_t n = strlen(texto);
+    if (n == 0 || n > BUSCA_MAX_ALVO) return 0;
+    for (size_t i = 0; i < n; i++) {
+        int t = tipoIndice(texto[i]);
+        if (t >= GERADOR_NUM_TIPOS || GERADOR_TIPOS[t] != texto[i]) return 0;
+    }
+    memcpy(o->alvo, texto, n + 1);
+    o->tamanho_alvo = (int)n;
+    o->tipo = OBJETIVO_SEQUENCIA;
+    return 1;
+}
+
+static void imprimirEstatisticas(const char *rotulo, uint64_t nos, uint64_t consultas, uint64_t acertos,
+                                 double segundos) {
+    printf("%s: nos=%llu nos/s=%.0f consultas=%llu acertos=%llu (%.1f%%) tempo=%.6fs\n", rotulo,
+           (unsigned long long)nos, segundos > 0 ? nos / segundos : 0.0, (unsigned long long)consultas,
+           (unsigned long long)acertos, consultas ? 100.0 * acertos / consultas : 0.0, segundos);
+}
+
+int main(int argc, char *argv[]) {
+    Fila fila;
+    Pilha pilha;
+    Peca armazenamento_pilha[BUSCA_MAX_PILHA];
+    Buscador buscador;
+    ConfigBusca cfg;
+    uint32_t limite_fila = CAP_FILA;
+    int capacidade_pilha = CAP_PILHA;
+    ModoGerador modo = GERADOR_UNIFORME;
+    uint64_t semente = 1;
+    long passos = 0;
+    const char *arquivo_roteiro = NULL;
+    int conferir = 0;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.algoritmo = BUSCA_PROFUNDIDADE;
+    cfg.profundidade = 8;
+    cfg.threads = 1;
+    cfg.bits_tabela = BITS_TABELA_PADRAO;
+    cfg.objetivo.tipo = OBJETIVO_PESOS;
+    cfg.objetivo.pesos[0] = 1; // Padrao: jogar o maximo de pecas 'I'
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--saco7") == 0) {
+            modo = GERADOR_SACO7;
+        } else if (strcmp(argv[i], "--fila") == 0 && i + 1 < argc) {
+            limite_fila = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--pilha") == 0 && i + 1 < argc) {
+            capacidade_pilha = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--profundidade") == 0 && i + 1 < argc) {
+            cfg.profundidade = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--feixe") == 0 && i + 1 < argc) {
+            cfg.algoritmo = BUSCA_FEIXE;
+            cfg.largura = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            cfg.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tabela") == 0 && i + 1 < argc) {
+            cfg.bits_tabela = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pesos") == 0 && i + 1 < argc) {
+            cfg.objetivo.tipo = OBJETIVO_PESOS;
+            if (!lerPesos(argv[++i], cfg.objetivo.pesos)) {
+                fprintf(stderr, "Pesos invalidos: %s (ex.: I=4,T=2)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--alvo") == 0 && i + 1 < argc) {
+            if (!lerAlvo(argv[++i], &cfg.objetivo)) {
+                fprintf(stderr, "Alvo invalido: %s (tipos IOTLJSZ, ate %d)\n", argv[i], BUSCA_MAX_ALVO);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--passos") == 0 && i + 1 < argc) {
+            passos = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--roteiro") == 0 && i + 1 < argc) {
+            arquivo_roteiro = argv[++i];
+        } else if (strcmp(argv[i], "--conferir") == 0) {
+            conferir = 1;
+        } else {
+            fprintf(stderr, "Uso: %s [--semente S] [--saco7] [--fila N] [--pilha N] [--profundidade D]\n"
+                            "          [--feixe L] [-t threads] [--tabela bits] [--pesos I=4,T=2,...]\n"
+                            "          [--alvo SEQUENCIA] [--passos N] [--roteiro arquivo] [--conferir]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (limite_fila == 0 || fila_tamanhoArmazenamento(limite_fila) > BUSCA_MAX_FILA ||
+        capacidade_pilha < 1 || capacidade_pilha > BUSCA_MAX_PILHA || passos < 0) {
+        fprintf(stderr, "Parametros invalidos (fila ate %d, pilha ate %d).\n", BUSCA_MAX_FILA, BUSCA_MAX_PILHA);
+        return 1;
+    }
+    if (conferir && (cfg.algoritmo != BUSCA_PROFUNDIDADE || cfg.bits_tabela <= 0 || passos > 0)) {
+        fprintf(stderr, "--conferir compara a busca em profundidade com e sem tabela (sem --feixe e --passos).\n");
+        return 1;
+    }
+    if (!criarBuscador(&buscador, &cfg)) {
+        fprintf(stderr, "Configuracao de busca invalida ou sem memoria.\n");
+        return 1;
+    }
+
+    inicializarFonte(&fonte_padrao, semente, modo);
+    if (!criarFila(&fila, limite_fila)) {
+        fprintf(stderr, "Sem memoria para a fila.\n");
+        destruirBuscador(&buscador);
+        return 1;
+    }
+    criarPilhaEm(&pilha, armazenamento_pilha, capacidade_pilha);
+    preencherFila(&fila);
+
+    printf("busca=%s profundidade=%d", cfg.algoritmo == BUSCA_FEIXE ? "feixe" : "profundidade", cfg.profundidade);
+    if (cfg.algoritmo == BUSCA_FEIXE) printf(" largura=%d", cfg.largura);
+    printf(" threads=%d tabela=", cfg.threads);
+    if (cfg.bits_tabela > 0) printf("2^%d", cfg.bits_tabela); else printf("nenhuma");
+    printf(" semente=%llu\n", (unsigned long long)semente);
+
+    int status = 0;
+    ResultadoBusca r;
+    if (passos == 0) {
+        if (!buscarAcoes(&buscador, &fila, &pilha, 0, &r)) {
+            fprintf(stderr, "A busca falhou (sem memoria).\n");
+            status = 1;
+        } else {
+            printf("melhor: pontos=%d acoes=", r.pontos);
+            for (int k = 0; k < r.tamanho; k++) putchar('0' + r.acoes[k]);
+            putchar('\n');
+            imprimirEstatisticas("busca", r.nos, r.consultas, r.acertos, r.segundos);
+        }
+        if (status == 0 && conferir) {
+            Buscador exaustivo;
+            ConfigBusca sem_tabela = cfg;
+            ResultadoBusca e;
+            sem_tabela.bits_tabela = 0;
+            if (!criarBuscador(&exaustivo, &sem_tabela) || !buscarAcoes(&exaustivo, &fila, &pilha, 0, &e)) {
+                fprintf(stderr, "A busca sem tabela falhou (sem memoria).\n");
+                status = 1;
+            } else if (e.pontos != r.pontos) {
+                printf("conferencia: FALHOU (sem tabela pontos=%d, com tabela pontos=%d)\n", e.pontos, r.pontos);
+                status = 1;
+            } else {
+                printf("conferencia: OK (sem tabela pontos=%d)\n", e.pontos);
+            }
+            destruirBuscador(&exaustivo);
+        }
+    } else {
+        FILE *roteiro = NULL;
+        if (arquivo_roteiro && !(roteiro = fopen(arquivo_roteiro, "w"))) {
+            perror(arquivo_roteiro);
+            status = 1;
+        }
+        uint64_t nos = 0, consultas = 0, acertos = 0;
+        double segundos = 0.0;
+        int progresso = 0;
+        long pontos = 0, jogados = 0;
+        for (; status == 0 && jogados < passos; jogados++) {
+            if (!buscarAcoes(&buscador, &fila, &pilha, progresso, &r)) {
+                fprintf(stderr, "A busca falhou (sem memoria).\n");
+                status = 1;
+                break;
+            }
+            nos += r.nos;
+            consultas += r.consultas;
+            acertos += r.acertos;
+            segundos += r.segundos;
+            if (r.tamanho == 0) break; // Nenhuma acao possivel
+
+            EventoAcao ev;
+            executarAcao(r.acoes[0], &fila, &pilha, &ev);
+            pontos += busca_pontos(&cfg.objetivo, &ev, &progresso);
+            if (roteiro) fputc('0' + r.acoes[0], roteiro);
+        }
+        if (roteiro) {
+            fputc('\n', roteiro);
+            if (fclose(roteiro) != 0) status = 1;
+        }
+        printf("passos=%ld pontos=%ld", jogados, pontos);
+        if (cfg.objetivo.tipo == OBJETIVO_SEQUENCIA) printf(" alvo=%d/%d", progresso, cfg.objetivo.tamanho_alvo);
+        printf("\n");
+        imprimirEstatisticas("busca", nos, consultas, acertos, segundos);
+        printf("fila=%u/%u pilha=%d/%d proximo_id=%lld hash=%016llx\n", fila_tamanho(&fila), fila.limite,
+               pilha.topo + 1, pilha.capacidade, (long long)proximoIdJogo(fila.fonte),
+               (unsigned long long)hashEstado(&fila, &pilha));
+    }
+
+    destruirFila(&fila);
+    destruirBuscador(&buscador);
+    return status;
+}
@@ -0,0 +1,411 @@
+// Gerador de carga para o servidor de sessoes (servidor.c).
+//
+// Abre varias conexoes, divididas entre algumas threads (cada uma com o seu epoll), e
+// em cada conexao joga sessoes completas ate o tempo acabar: PROTO_INICIAR, as acoes
+// sorteadas (splitmix64) e PROTO_ESTADO no fim. Cada conexao mantem ate 'janela'
+// comandos sem resposta (pipeline). A latencia de cada comando vai do envio a chegada
+// da resposta.
+//
+// Antes e depois da carga, o tempo de CPU do servidor e consultado com PROTO_SERVIDOR:
+// sessoes por nucleo = sessoes completas / segundos de CPU gastos pelo servidor.
+// Com --verificar, cada conexao repete as sessoes localmente com o nucleo (pecas.h) e
+// confere o resultado de cada acao e o hash final.
+//
+// Compilar: make carga
+// Uso:      carga [--socket caminho] [-c conexoes] [-t threads] [-d segundos]
+//                 [-p acoes por sessao] [--janela N] [--semente S] [--saco7] [--verificar]
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "pecas.h"
+#include "protocolo.h"
+
+#define MAX_THREADS 64
+#define MAX_JANELA 256
+#define MAX_EVENTOS 64
+#define TAM_BUFFER 4096
+#define BALDES 40                // Balde b conta latencias em [2^b, 2^(b+1)) ns
+
+typedef struct {
+    uint64_t amostras, soma_ns, max_ns;
+    uint64_t baldes[BALDES];
+} Latencias;
+
+// Comando enviado e ainda sem resposta
+typedef struct {
+    uint8_t tipo;
+    uint8_t esperado;      // --verificar: ResultadoAcao esperado
+    uint64_t hash;         // --verificar: hash esperado (PROTO_ESTADO)
+    uint64_t enviado_ns;
+} Pendente;
+
+typedef struct {
+    int fd;
+    int aberta;
+    uint64_t semente;          // Semente da sessao atual
+    uint64_t politica;         // Sorteio das acoes (splitmix64)
+    long comando;              // Proximo comando da sessao: 0 = INICIAR, 1..p = acoes, p + 1 = ESTADO
+    Pendente pendentes[MAX_JANELA];
+    int cabeca, num_pendentes; // Anel de pendentes, na ordem de envio
+    uint8_t entrada[TAM_BUFFER];
+    size_t tam_entrada;
+    uint8_t saida[TAM_BUFFER];
+    size_t inicio_saida, fim_saida;
+    SessaoProto espelho;       // --verificar: a mesma sessao, jogada localmente
+} ConexaoCarga;
+
+typedef struct {
+    int indice;
+    pthread_t thread;
+    int epoll;
+    ConexaoCarga *conexoes;
+    int num_conexoes;
+    uint64_t sessoes, comandos, divergencias, erros;
+    Latencias latencias;
+} ThreadCarga;
+
+static const char *caminho_socket = PROTO_SOCKET_PADRAO;
+static long acoes_por_sessao = 100;
+static int janela = 16;
+static int modo_gerador = GERADOR_UNIFORME;
+static int verificar = 0;
+static uint64_t fim_ns;       // Depois disso nenhuma sessao nova comeca
+
+static uint64_t agoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int sortearAcao(uint64_t *estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (int)(((z >> 32) * 5) >> 32) + 1;
+}
+
+static void registrarLatencia(Latencias *l, uint64_t ns) {
+    int balde = 63 - __builtin_clzll(ns | 1);
+    if (balde >= BALDES) balde = BALDES - 1;
+    l->amostras++;
+    l->soma_ns += ns;
+    if (ns > l->max_ns) l->max_ns = ns;
+    l->baldes[balde]++;
+}
+
+/**
+ * @brief Limite superior (ns) do balde do percentil 'q' (no maximo a maior latencia).
+ */
+static uint64_t percentil(const Latencias *l, double q) {
+    uint64_t alvo = (uint64_t)(q * (double)l->amostras), acumulado = 0;
+    for (int b = 0; b < BALDES; b++) {
+        acumulado += l->baldes[b];
+        if (acumulado > alvo) return (2ULL << b) < l->max_ns ? 2ULL << b : l->max_ns;
+    }
+    return 0;
+}
+
+static int conectar(void) {
+    struct sockaddr_un endereco;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strncpy(endereco.sun_path, caminho_socket, sizeof(endereco.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&endereco, sizeof(endereco)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+// --- 1. Comandos de uma Conexao ---
+
+/**
+ * @brief Poe na saida os proximos comandos da sessao, ate encher a janela.
+ */
+static void enfileirarComandos(ConexaoCarga *c, uint64_t agora) {
+    while (c->num_pendentes < janela && c->comando <= acoes_por_sessao + 1 &&
+           c->fim_saida + PROTO_TAM_INICIAR <= TAM_BUFFER) {
+        if (c->comando == 0 && agora >= fim_ns) return; // Tempo esgotado: nao comeca outra sessao
+
+        Pendente *p = &c->pendentes[(c->cabeca + c->num_pendentes) % MAX_JANELA];
+        uint8_t *d = c->saida + c->fim_saida;
+        if (c->comando == 0) {
+            proto_comandoIniciar(d, c->semente, modo_gerador, CAP_FILA, CAP_PILHA);
+            p->tipo = PROTO_INICIAR;
+            p->esperado = 0;
+            if (verificar) proto_iniciarSessao(&c->espelho, c->semente, modo_gerador, CAP_FILA, CAP_PILHA);
+        } else if (c->comando <= acoes_por_sessao) {
+            d[0] = (uint8_t)sortearAcao(&c->politica);
+            p->tipo = d[0];
+            if (verificar) {
+                EventoAcao ev;
+                p->esperado = (uint8_t)executarAcao(d[0], &c->espelho.fila, &c->espelho.pilha, &ev);
+            }
+        } else {
+            d[0] = PROTO_ESTADO;
+            p->tipo = PROTO_ESTADO;
+            if (verificar) p->hash = hashEstado(&c->espelho.fila, &c->espelho.pilha);
+        }
+        c->fim_saida += (size_t)proto_tamanhoComando(d[0]);
+        p->enviado_ns = agora;
+        c->num_pendentes++;
+        c->comando++;
+    }
+}
+
+/**
+ * @brief Consome as respostas completas da entrada, na ordem dos pendentes.
+ */
+static void consumirRespostas(ThreadCarga *t, ConexaoCarga *c, uint64_t agora) {
+    size_t pos = 0;
+    while (c->num_pendentes > 0) {
+        Pendente *p = &c->pendentes[c->cabeca];
+        size_t tamanho = (size_t)proto_tamanhoResposta(p->tipo);
+        if (pos + tamanho > c->tam_entrada) break;
+
+        const uint8_t *r = c->entrada + pos;
+        registrarLatencia(&t->latencias, agora - p->enviado_ns);
+        t->comandos++;
+        if (p->tipo == PROTO_ESTADO) {
+            if (verificar && proto_ler64(r) != p->hash) t->divergencias++;
+            t->sessoes++;
+            c->semente += 0x9E3779B97F4A7C15ULL; // Proxima sessao da conexao
+            c->politica = ~c->semente;
+            c->comando = 0;
+        } else if (verificar && r[0] != p->esperado) {
+            t->divergencias++;
+        }
+        pos += tamanho;
+        c->cabeca = (c->cabeca + 1) % MAX_JANELA;
+        c->num_pendentes--;
+    }
+    memmove(c->entrada, c->entrada + pos, c->tam_entrada - pos);
+    c->tam_entrada -= pos;
+}
+
+/**
+ * @brief Envia, le e repoe comandos. Com o tempo esgotado e nada pendente, a conexao
+ * e fechada.
+ * @return 0 se a conexao terminou (ou caiu).
+ */
+static int atenderConexao(ThreadCarga *t, ConexaoCarga *c, uint32_t eventos) {
+    if (eventos & EPOLLERR) return 0;
+    if (eventos & (EPOLLIN | EPOLLHUP)) {
+        ssize_t n = recv(c->fd, c->entrada + c->tam_entrada, TAM_BUFFER - c->tam_entrada, MSG_DONTWAIT);
+        if (n == 0) return 0;
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return 0;
+        if (n > 0) c->tam_entrada += (size_t)n;
+        consumirRespostas(t, c, agoraNs());
+    }
+
+    uint64_t agora = agoraNs();
+    if (c->inicio_saida == c->fim_saida) c->inicio_saida = c->fim_saida = 0;
+    enfileirarComandos(c, agora);
+    if (c->num_pendentes == 0 && c->comando == 0) return 0; // Fim do tempo
+    while (c->inicio_saida < c->fim_saida) {
+        ssize_t n = send(c->fd, c->saida + c->inicio_saida, c->fim_saida - c->inicio_saida,
+                         MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return 0;
+        }
+        c->inicio_saida += (size_t)n;
+    }
+
+    struct epoll_event ev = {.events = EPOLLIN | (c->inicio_saida < c->fim_saida ? EPOLLOUT : 0), .data.ptr = c};
+    return epoll_ctl(t->epoll, EPOLL_CTL_MOD, c->fd, &ev) == 0;
+}
+
+static void *executarThreadCarga(void *arg) {
+    ThreadCarga *t = arg;
+    struct epoll_event eventos[MAX_EVENTOS];
+    int abertas = 0;
+
+    for (int i = 0; i < t->num_conexoes; i++) {
+        ConexaoCarga *c = &t->conexoes[i];
+        struct epoll_event ev = {.events = EPOLLOUT, .data.ptr = c};
+        if (epoll_ctl(t->epoll, EPOLL_CTL_ADD, c->fd, &ev) == 0) {
+            c->aberta = 1;
+            abertas++;
+        } else {
+            t->erros++;
+        }
+    }
+    while (abertas > 0) {
+        int n = epoll_wait(t->epoll, eventos, MAX_EVENTOS, 100);
+        if (n < 0 && errno != EINTR) break;
+        for (int i = 0; i < n; i++) {
+            ConexaoCarga *c = eventos[i].data.ptr;
+            if (!atenderConexao(t, c, eventos[i].events)) {
+                if (c->num_pendentes > 0 || c->comando != 0) t->erros++; // Caiu no meio de uma sessao
+                epoll_ctl(t->epoll, EPOLL_CTL_DEL, c->fd, NULL);
+                c->aberta = 0;
+                abertas--;
+            }
+        }
+    }
+    return NULL;
+}
+
+
+// --- Funcao Principal ---
+
+/**
+ * @brief Consulta PROTO_SERVIDOR em uma conexao propria (bloqueante).
+ * @return 1 em caso de sucesso.
+ */
+static int consultarServidor(uint64_t *cpu_ns, uint32_t *threads) {
+    uint8_t comando = PROTO_SERVIDOR, r[PROTO_TAM_SERVIDOR];
+    size_t lidos = 0;
+    int fd = conectar();
+    if (fd < 0) return 0;
+    if (send(fd, &comando, 1, MSG_NOSIGNAL) != 1) {
+        close(fd);
+        return 0;
+    }
+    while (lidos < sizeof(r)) {
+        ssize_t n = recv(fd, r + lidos, sizeof(r) - lidos, 0);
+        if (n <= 0) break;
+        lidos += (size_t)n;
+    }
+    close(fd);
+    if (lidos < sizeof(r)) return 0;
+    *cpu_ns = proto_ler64(r);
+    *threads = proto_ler32(r + 8);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    static ThreadCarga threads[MAX_THREADS];
+    int num_conexoes = 64, num_threads = 1;
+    double segundos = 2.0;
+    uint64_t semente = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            caminho_socket = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            num_conexoes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            segundos = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            acoes_por_sessao = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--janela") == 0 && i + 1 < argc) {
+            janela = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--saco7") == 0) {
+            modo_gerador = GERADOR_SACO7;
+        } else if (strcmp(argv[i], "--verificar") == 0) {
+            verificar = 1;
+        } else {
+            fprintf(stderr, "Uso: %s [--socket caminho] [-c conexoes] [-t threads] [-d segundos]\n"
+                            "          [-p acoes por sessao] [--janela N] [--semente S] [--saco7] [--verificar]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (num_conexoes < 1 || num_threads < 1 || num_threads > MAX_THREADS || num_threads > num_conexoes ||
+        segundos <= 0 || acoes_por_sessao < 0 || janela < 1 || janela > MAX_JANELA) {
+        fprintf(stderr, "Parametros invalidos (threads 1 a %d e no maximo uma por conexao, janela 1 a %d).\n",
+                MAX_THREADS, MAX_JANELA);
+        return 1;
+    }
+
+    uint64_t cpu0 = 0, cpu1 = 0;
+    uint32_t threads_servidor = 0;
+    if (!consultarServidor(&cpu0, &threads_servidor)) {
+        fprintf(stderr, "Servidor indisponivel em %s.\n", caminho_socket);
+        return 1;
+    }
+
+    ConexaoCarga *conexoes = calloc((size_t)num_conexoes, sizeof(ConexaoCarga));
+    if (!conexoes) {
+        fprintf(stderr, "Sem memoria para as conexoes.\n");
+        return 1;
+    }
+    for (int i = 0; i < num_conexoes; i++) {
+        conexoes[i].fd = conectar();
+        if (conexoes[i].fd < 0) {
+            perror("connect");
+            return 1;
+        }
+        conexoes[i].semente = semente + (uint64_t)i;
+        conexoes[i].politica = ~conexoes[i].semente;
+    }
+
+    uint64_t t0 = agoraNs();
+    fim_ns = t0 + (uint64_t)(segundos * 1e9);
+    int base = 0;
+    for (int i = 0; i < num_threads; i++) {
+        ThreadCarga *t = &threads[i];
+        t->indice = i;
+        t->conexoes = conexoes + base;
+        t->num_conexoes = num_conexoes / num_threads + (i < num_conexoes % num_threads);
+        base += t->num_conexoes;
+        t->epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (t->epoll < 0 || pthread_create(&t->thread, NULL, executarThreadCarga, t) != 0) {
+            perror("Nao foi possivel iniciar as threads");
+            return 1;
+        }
+    }
+
+    Latencias total = {0};
+    uint64_t sessoes = 0, comandos = 0, divergencias = 0, erros = 0;
+    for (int i = 0; i < num_threads; i++) {
+        ThreadCarga *t = &threads[i];
+        pthread_join(t->thread, NULL);
+        close(t->epoll);
+        sessoes += t->sessoes;
+        comandos += t->comandos;
+        divergencias += t->divergencias;
+        erros += t->erros;
+        total.amostras += t->latencias.amostras;
+        total.soma_ns += t->latencias.soma_ns;
+        if (t->latencias.max_ns > total.max_ns) total.max_ns = t->latencias.max_ns;
+        for (int b = 0; b < BALDES; b++) total.baldes[b] += t->latencias.baldes[b];
+    }
+    double duracao = (agoraNs() - t0) / 1e9;
+    for (int i = 0; i < num_conexoes; i++) close(conexoes[i].fd);
+    free(conexoes);
+
+    int status = 0;
+    printf("conexoes=%d threads=%d janela=%d acoes_por_sessao=%ld tempo=%.3fs\n", num_conexoes, num_threads,
+           janela, acoes_por_sessao, duracao);
+    printf("sessoes=%llu sessoes/s=%.0f comandos/s=%.0f erros=%llu\n", (unsigned long long)sessoes,
+           sessoes / duracao, comandos / duracao, (unsigned long long)erros);
+    printf("latencia: media=%.1fus p50<=%.1fus p99<=%.1fus p999<=%.1fus max=%.1fus\n",
+           total.amostras ? (double)total.soma_ns / (double)total.amostras / 1e3 : 0.0,
+           percentil(&total, 0.50) / 1e3, percentil(&total, 0.99) / 1e3, percentil(&total, 0.999) / 1e3,
+           total.max_ns / 1e3);
+    if (consultarServidor(&cpu1, &threads_servidor)) {
+        double cpu = (cpu1 - cpu0) / 1e9;
+        printf("servidor: threads=%u cpu=%.3fs sessoes por nucleo=%.0f/s\n", threads_servidor, cpu,
+               cpu > 0 ? sessoes / cpu : 0.0);
+    } else {
+        fprintf(stderr, "Nao foi possivel consultar o servidor ao final.\n");
+        status = 1;
+    }
+    if (verificar) {
+        printf("verificadas=%llu divergencias=%llu\n", (unsigned long long)sessoes, (unsigned long long)divergencias);
+        if (divergencias) status = 2;
+    }
+    if (erros) status = 1;
+    return status;
+}
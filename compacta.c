@@ -0,0 +1,68 @@
+// Conversao entre Fila/Pilha e o formato SessaoCompacta (ver compacta.h).
+
+#include "compacta.h"
+
+/**
+ * @brief Grava uma peca em um slot, relativa ao proximo_id ja definido.
+ * @return 1 se coube no formato, 0 se o tipo e invalido ou o ID e antigo demais.
+ */
+int compacta_definirPeca(SessaoCompacta *c, int slot, Peca p) {
+    int tipo = codigoTipo(p.nome);
+    int64_t id = p.id;
+    uint32_t idade = c->proximo_id - (uint32_t)id;
+    if (tipo < 0 || id < 0 || id > (int64_t)c->proximo_id || idade > COMPACTA_IDADE_MAX) {
+        return 0;
+    }
+    c->cabecalho = (c->cabecalho & ~(7u << (3 * slot))) | ((uint32_t)tipo << (3 * slot));
+    c->idade[slot] = (uint16_t)idade;
+    return 1;
+}
+
+/**
+ * @brief Converte uma sessao (fila com limite 5, pilha fixa de 3 e proximo_id da fonte da fila,
+ * com IDs proprios abaixo de 2^32) para o formato compacto. Nao guarda o gerador, que fica a cargo do chamador.
+ * @return 1 se a sessao coube no formato, 0 caso contrario (c fica indefinido).
+ */
+int compactarSessao(SessaoCompacta *c, Fila *f, Pilha *p) {
+    uint32_t tamanho_fila = fila_tamanho(f);
+    int tamanho_pilha = p->topo + 1;
+
+    if (f->limite != COMPACTA_SLOTS_FILA || p->capacidade != COMPACTA_SLOTS_PILHA || p->crescer ||
+        f->fonte->produtor || f->fonte->alocador || f->fonte->proximo_id > UINT32_MAX) {
+        return 0;
+    }
+    c->proximo_id = (uint32_t)f->fonte->proximo_id;
+    c->cabecalho = (tamanho_fila << 24) | ((uint32_t)tamanho_pilha << 27);
+    for (uint32_t i = 0; i < tamanho_fila; i++) {
+        if (!compacta_definirPeca(c, (int)i, f->elementos[(f->cabeca + i) & f->mascara])) return 0;
+    }
+    for (int i = 0; i < tamanho_pilha; i++) {
+        if (!compacta_definirPeca(c, COMPACTA_SLOTS_FILA + i, p->elementos[i])) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Reconstroi a fila, a pilha e o proximo_id da fonte da fila a partir do formato
+ * compacto. A fila deve ter sido criada com limite COMPACTA_SLOTS_FILA e a pilha com
+ * capacidade COMPACTA_SLOTS_PILHA.
+ */
+void expandirSessao(const SessaoCompacta *c, Fila *f, Pilha *p) {
+    int tamanho_fila = compacta_tamanhoFila(c);
+    int tamanho_pilha = compacta_tamanhoPilha(c);
+
+    inicializarFila(f);
+    for (int i = 0; i < tamanho_fila; i++) {
+        f->elementos[i] = compacta_peca(c, i);
+    }
+    f->cauda = (uint32_t)tamanho_fila;
+
+    p->topo = tamanho_pilha - 1;
+    for (int i = 0; i < tamanho_pilha; i++) {
+        p->elementos[i] = compacta_peca(c, COMPACTA_SLOTS_FILA + i);
+    }
+    if (f->indice) fila_reconstruirIndice(f);
+    if (p->indice) pilha_reconstruirIndice(p);
+    f->fonte->proximo_id = c->proximo_id;
+}
+
@@ -0,0 +1,52 @@
+// Sessao compactada (configuracao padrao: fila de 5 e pilha de 3), usada pelo
+// simulacao.c para guardar muitas sessoes em pouca memoria.
+//
+// Os tipos ocupam 3 bits cada e os IDs sao guardados como idade em relacao a
+// proximo_id (16 bits). Tamanho: 24 bytes por sessao, contra 160 bytes de
+// Fila + Pilha + armazenamento da fila (8 posicoes) e da pilha (3) no formato normal.
+
+#ifndef COMPACTA_H
+#define COMPACTA_H
+
+#include <stdint.h>
+
+#include "pecas.h"
+
+#define COMPACTA_SLOTS_FILA 5   // Slots 0-4: fila, da frente para tras
+#define COMPACTA_SLOTS_PILHA 3  // Slots 5-7: pilha, da base para o topo
+#define COMPACTA_EXPANDIDA 7    // Tamanho de fila reservado: a sessao nao coube no formato
+#define COMPACTA_IDADE_MAX 0xFFFF
+
+typedef struct {
+    uint32_t proximo_id; // Base dos IDs: id = proximo_id - idade[slot]
+    uint32_t cabecalho;  // Bits 0-23: 8 tipos x 3 bits; 24-26: tamanho da fila; 27-28: tamanho da pilha
+    uint16_t idade[COMPACTA_SLOTS_FILA + COMPACTA_SLOTS_PILHA];
+} SessaoCompacta;
+
+int compacta_definirPeca(SessaoCompacta *c, int slot, Peca p);
+int compactarSessao(SessaoCompacta *c, Fila *f, Pilha *p);
+void expandirSessao(const SessaoCompacta *c, Fila *f, Pilha *p);
+
+static inline int compacta_tipo(const SessaoCompacta *c, int slot) {
+    return (int)(c->cabecalho >> (3 * slot)) & 7;
+}
+
+static inline int compacta_tamanhoFila(const SessaoCompacta *c) {
+    return (int)(c->cabecalho >> 24) & 7;
+}
+
+static inline int compacta_tamanhoPilha(const SessaoCompacta *c) {
+    return (int)(c->cabecalho >> 27) & 3;
+}
+
+/**
+ * @brief Le a peca de um slot (0-4 fila, 5-7 pilha).
+ */
+static inline Peca compacta_peca(const SessaoCompacta *c, int slot) {
+    Peca p;
+    p.nome = GERADOR_TIPOS[compacta_tipo(c, slot)];
+    p.id = (int64_t)c->proximo_id - c->idade[slot];
+    return p;
+}
+
+#endif // COMPACTA_H
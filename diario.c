@@ -0,0 +1,122 @@
+// Gravacao do diario de acoes (ver diario.h).
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "diario.h"
+
+/**
+ * @brief Escreve o conteudo do buffer no arquivo do diario.
+ * @return 1 em caso de sucesso, 0 se a escrita falhou.
+ */
+static int descarregarDiario(Diario *d) {
+    size_t enviado = 0;
+    while (enviado < d->usado) {
+        ssize_t n = write(d->fd, d->buffer + enviado, d->usado - enviado);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("diario");
+            return 0;
+        }
+        enviado += (size_t)n;
+    }
+    d->usado = 0;
+    return 1;
+}
+
+/**
+ * @brief Cria (ou trunca) o arquivo do diario e grava o cabecalho da sessao.
+ * @param p Pilha da sessao, ainda vazia (o diario guarda a sua capacidade e se ela cresce).
+ * @return 1 em caso de sucesso, 0 se o arquivo nao pode ser criado.
+ */
+int abrirDiario(Diario *d, const char *caminho, uint64_t semente, ModoGerador modo, uint32_t limite_fila,
+                const Pilha *p) {
+    CabecalhoDiario cab;
+
+    d->fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (d->fd < 0) {
+        perror(caminho);
+        return 0;
+    }
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magico, DIARIO_MAGICO, sizeof(cab.magico));
+    cab.versao = DIARIO_VERSAO;
+    cab.limite_fila = limite_fila;
+    cab.semente = semente;
+    cab.modo = (uint32_t)modo;
+    cab.intervalo = DIARIO_INTERVALO;
+    cab.cap_pilha = (uint32_t)p->capacidade;
+    cab.flags_pilha = p->crescer ? DIARIO_PILHA_CRESCE : 0;
+
+    memcpy(d->buffer, &cab, sizeof(cab));
+    d->usado = sizeof(cab);
+    d->desde_verificacao = 0;
+    d->acoes = 0;
+    return 1;
+}
+
+/**
+ * @brief Acrescenta o byte de uma acao ao diario.
+ * @param tipo_gerado Codigo (0-6) da peca gerada no reabastecimento, ou -1 se nenhuma.
+ * @return 1 em caso de sucesso, 0 se a escrita falhou.
+ */
+int registrarAcao(Diario *d, int codigo, int sucesso, int tipo_gerado) {
+    if (d->usado == TAM_BUFFER_DIARIO && !descarregarDiario(d)) return 0;
+    d->buffer[d->usado++] = (uint8_t)(codigo | ((tipo_gerado + 1) << 3) | ((sucesso != 0) << 6));
+    d->acoes++;
+    d->desde_verificacao++;
+    return 1;
+}
+
+/**
+ * @brief Acrescenta um ponto de verificacao (proximo_id e hash do estado atual).
+ * @return 1 em caso de sucesso, 0 se a escrita falhou.
+ */
+int registrarVerificacao(Diario *d, Fila *f, Pilha *p) {
+    int64_t proximo_id = proximoIdJogo(f->fonte);
+    uint64_t hash = hashEstado(f, p);
+
+    if (d->usado + TAM_VERIFICACAO_DIARIO > TAM_BUFFER_DIARIO && !descarregarDiario(d)) return 0;
+    d->buffer[d->usado] = DIARIO_VERIFICACAO;
+    memcpy(d->buffer + d->usado + 1, &proximo_id, sizeof(proximo_id));
+    memcpy(d->buffer + d->usado + 1 + sizeof(proximo_id), &hash, sizeof(hash));
+    d->usado += TAM_VERIFICACAO_DIARIO;
+    d->desde_verificacao = 0;
+    return 1;
+}
+
+/**
+ * @brief Grava o ponto de verificacao final, descarrega o buffer e fecha o arquivo.
+ * @return 1 em caso de sucesso, 0 se alguma escrita falhou (tambem antes, ver
+ * executarAcaoDiario).
+ */
+int fecharDiario(Diario *d, Fila *f, Pilha *p) {
+    if (d->fd < 0) return 0;
+    int ok = registrarVerificacao(d, f, p) && descarregarDiario(d);
+    if (close(d->fd) != 0) ok = 0;
+    d->fd = -1;
+    return ok;
+}
+
+/**
+ * @brief Aplica uma acao e, com o diario ativo (d != NULL), registra o seu resultado.
+ * A peca gerada no reabastecimento vem do proprio evento da acao. Se a escrita falha,
+ * o diario avisa uma vez, e fechado e deixa de ser gravado (a sessao continua);
+ * fecharDiario() entao devolve 0.
+ * @return O mesmo que executarAcao().
+ */
+ResultadoAcao executarAcaoDiario(Diario *d, int codigo, Fila *f, Pilha *p, EventoAcao *ev) {
+    ResultadoAcao resultado = executarAcao(codigo, f, p, ev);
+    if (!d || d->fd < 0 || resultado == ACAO_INVALIDA) return resultado;
+
+    if (!registrarAcao(d, codigo, resultado == ACAO_OK, ev->reabastecida ? codigoTipo(ev->nova.nome) : -1) ||
+        (d->desde_verificacao == DIARIO_INTERVALO && !registrarVerificacao(d, f, p))) {
+        fprintf(stderr, "diario: falha na escrita; as proximas acoes nao serao gravadas.\n");
+        close(d->fd);
+        d->fd = -1;
+    }
+    return resultado;
+}
@@ -0,0 +1,53 @@
+// Diario de acoes (mestre --diario): arquivo binario so de acrescimo com tudo o que
+// foi jogado, reproduzido por reproduzir.c.
+//
+// Depois do cabecalho, cada acao ocupa 1 byte:
+//   bits 0-2: codigo da acao (1-5)
+//   bits 3-5: tipo da peca gerada no reabastecimento + 1 (0 = nenhuma peca gerada)
+//   bit 6:    1 se a acao teve sucesso
+// A cada 'intervalo' acoes (e no fim) vem um ponto de verificacao: o byte
+// DIARIO_VERIFICACAO seguido de proximo_id (int64) e hashEstado (uint64), 17 bytes.
+
+#ifndef DIARIO_H
+#define DIARIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pecas.h"
+
+#define DIARIO_MAGICO "TTRSDIA1"
+#define DIARIO_VERSAO 3
+#define DIARIO_PILHA_CRESCE 1u  // flags_pilha: a pilha dobra de capacidade quando enche
+#define DIARIO_INTERVALO 4096
+#define DIARIO_VERIFICACAO 0x80
+#define TAM_VERIFICACAO_DIARIO (1 + sizeof(int64_t) + sizeof(uint64_t))
+#define TAM_BUFFER_DIARIO (1 << 16)
+
+typedef struct {
+    char magico[8];        // DIARIO_MAGICO (sem o '\0')
+    uint32_t versao;
+    uint32_t limite_fila;
+    uint64_t semente;      // Semente da sessao: reproduz a mesma sequencia de pecas
+    uint32_t modo;         // ModoGerador
+    uint32_t intervalo;    // Acoes entre dois pontos de verificacao
+    uint32_t cap_pilha;    // Capacidade inicial da pilha
+    uint32_t flags_pilha;  // DIARIO_PILHA_*
+} CabecalhoDiario;
+
+typedef struct {
+    int fd;
+    uint32_t desde_verificacao; // Acoes desde o ultimo ponto de verificacao
+    uint64_t acoes;
+    size_t usado;
+    uint8_t buffer[TAM_BUFFER_DIARIO];
+} Diario;
+
+int abrirDiario(Diario *d, const char *caminho, uint64_t semente, ModoGerador modo, uint32_t limite_fila,
+                const Pilha *p);
+int registrarAcao(Diario *d, int codigo, int sucesso, int tipo_gerado);
+int registrarVerificacao(Diario *d, Fila *f, Pilha *p);
+int fecharDiario(Diario *d, Fila *f, Pilha *p);
+ResultadoAcao executarAcaoDiario(Diario *d, int codigo, Fila *f, Pilha *p, EventoAcao *ev);
+
+#endif // DIARIO_H
@@ -0,0 +1,110 @@
+// Scanner dos comandos dos menus (ver entrada.h).
+
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include "entrada.h"
+
+// Estados do scanner entre um byte e o proximo
+enum {
+    ENTRE_COMANDOS = 0, // Ignorando espacos
+    NO_SINAL,           // Leu '+' ou '-', ainda sem digito
+    NO_NUMERO,          // Leu pelo menos um digito
+    DESCARTANDO         // Comando invalido: ignora ate o fim da linha
+};
+
+static inline int ehEspaco(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline void emitir(LeitorEntrada *l, ComandoEntrada *destino) {
+    int64_t v = l->negativo ? -l->valor : l->valor;
+    destino->valido = 1;
+    destino->codigo = v > INT_MAX ? INT_MAX : v < INT_MIN ? INT_MIN : (int)v;
+    l->estado = ENTRE_COMANDOS;
+}
+
+/**
+ * @brief Examina um byte. Um byte pode fechar um numero e ainda ser invalido (ex.:
+ * "1x"), entao cabe ao chamador deixar espaco para dois comandos.
+ * @return Quantos comandos foram escritos em destino (0, 1 ou 2).
+ */
+static int examinarByte(LeitorEntrada *l, unsigned char c, ComandoEntrada *destino) {
+    int n = 0;
+
+    if (l->estado == NO_NUMERO) {
+        if (c >= '0' && c <= '9') {
+            if (l->valor <= INT_MAX) l->valor = l->valor * 10 + (c - '0');
+            return 0;
+        }
+        emitir(l, &destino[n++]); // O byte comeca o proximo comando
+    } else if (l->estado == NO_SINAL) {
+        if (c >= '0' && c <= '9') {
+            l->valor = c - '0';
+            l->estado = NO_NUMERO;
+            return 0;
+        }
+        l->estado = DESCARTANDO;
+        destino[n++].valido = 0;
+    }
+
+    if (l->estado == DESCARTANDO) {
+        if (c == '\n') l->estado = ENTRE_COMANDOS;
+    } else if (ehEspaco(c)) {
+        // Nada: separador
+    } else if (c >= '0' && c <= '9') {
+        l->negativo = 0;
+        l->valor = c - '0';
+        l->estado = NO_NUMERO;
+    } else if (c == '-' || c == '+') {
+        l->negativo = (c == '-');
+        l->estado = NO_SINAL;
+    } else {
+        l->estado = DESCARTANDO;
+        destino[n++].valido = 0;
+    }
+    return n;
+}
+
+void entrada_iniciar(LeitorEntrada *l, int fd) {
+    l->fd = fd;
+    l->fim = 0;
+    l->estado = ENTRE_COMANDOS;
+    l->negativo = 0;
+    l->valor = 0;
+    l->pos = l->tam = 0;
+}
+
+/**
+ * @brief Entrega os comandos que ja chegaram (ate 'max', no minimo 2). So bloqueia
+ * em read() quando nao ha nenhum comando completo.
+ * @return Quantos comandos foram escritos, 0 no fim da entrada, -1 em erro de leitura.
+ */
+int entrada_lerComandos(LeitorEntrada *l, ComandoEntrada *destino, int max) {
+    int n = 0;
+
+    for (;;) {
+        while (l->pos < l->tam && n <= max - 2) {
+            n += examinarByte(l, (unsigned char)l->bloco[l->pos++], destino + n);
+        }
+        if (n > 0) return n;
+        if (l->fim) return 0;
+
+        ssize_t lidos;
+        do {
+            lidos = read(l->fd, l->bloco, sizeof(l->bloco));
+        } while (lidos < 0 && errno == EINTR);
+        if (lidos < 0) return -1;
+        if (lidos == 0) { // Um numero no fim da entrada, sem nada depois, tambem vale
+            l->fim = 1;
+            if (l->estado == NO_NUMERO) {
+                emitir(l, destino);
+                return 1;
+            }
+            return 0;
+        }
+        l->pos = 0;
+        l->tam = (size_t)lidos;
+    }
+}
@@ -0,0 +1,38 @@
+// Leitura dos codigos de acao digitados ou enviados por pipe aos menus.
+//
+// A entrada e lida em blocos grandes com read() e examinada por um scanner proprio,
+// byte a byte, que entrega ao menu um lote de comandos de cada vez (todos os que ja
+// chegaram). Cada comando segue a regra de scanf("%d"): espacos sao ignorados, um
+// numero e um sinal opcional seguido de digitos e termina no primeiro caractere que
+// nao e digito. Qualquer outra coisa e um comando invalido, e o resto da linha e
+// descartado (como o while (getchar() != '\n') dos menus fazia). O estado do scanner
+// fica no leitor, entao um numero pode chegar dividido entre dois blocos.
+
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ENTRADA_TAM_BLOCO (1 << 16)
+#define ENTRADA_MAX_LOTE 256   // Comandos entregues por chamada nos menus
+
+typedef struct {
+    int valido;  // 0: entrada que nao e numero ("[ERRO] Entrada invalida")
+    int codigo;
+} ComandoEntrada;
+
+typedef struct {
+    int fd;
+    int fim;           // 1 depois que read() indicou o fim da entrada
+    int estado;        // Onde o scanner parou (ver entrada.c)
+    int negativo;
+    int64_t valor;     // Numero em leitura (saturado fora do intervalo de int)
+    size_t pos, tam;   // Bytes de 'bloco' ainda nao examinados: [pos, tam)
+    char bloco[ENTRADA_TAM_BLOCO];
+} LeitorEntrada;
+
+void entrada_iniciar(LeitorEntrada *l, int fd);
+int entrada_lerComandos(LeitorEntrada *l, ComandoEntrada *destino, int max);
+
+#endif // ENTRADA_H
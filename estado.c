@@ -0,0 +1,159 @@
+// Gravacao e leitura do estado salvo (ver estado.h).
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "estado.h"
+
+/**
+ * @brief Confere se as n pecas gravadas tem tipos conhecidos (elas vao para o indice de tipos).
+ */
+static int pecasValidas(const Peca *pecas, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (codigoTipo(pecas[i].nome) < 0) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Quantos bytes o estado atual ocupa no formato salvo.
+ */
+size_t estado_tamanhoSalvo(Fila *f, Pilha *p) {
+    return sizeof(CabecalhoSalvo) + (fila_tamanho(f) + (size_t)(p->topo + 1)) * sizeof(Peca);
+}
+
+/**
+ * @brief Grava o estado (fila, pilha e fonte da fila) em 'destino'.
+ * @param destino Pelo menos estado_tamanhoSalvo(f, p) bytes.
+ * @return Bytes gravados.
+ */
+size_t serializarEstado(uint8_t *destino, Fila *f, Pilha *p) {
+    CabecalhoSalvo cab;
+    uint32_t tamanho = fila_tamanho(f);
+
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magico, SALVO_MAGICO, sizeof(cab.magico));
+    cab.versao = SALVO_VERSAO;
+    cab.limite_fila = f->limite;
+    cab.tamanho_fila = tamanho;
+    cab.topo_pilha = p->topo;
+    cab.proximo_id = f->fonte->proximo_id;
+    cab.cap_pilha = (uint32_t)p->capacidade;
+    cab.flags_pilha = p->crescer ? SALVO_PILHA_CRESCE : 0;
+    cab.semente = f->fonte->semente;
+    cab.gerador = f->fonte->gerador;
+
+    memcpy(destino, &cab, sizeof(cab));
+    size_t usado = sizeof(cab);
+    usado += fila_peek_n(f, (Peca *)(void *)(destino + usado), tamanho) * sizeof(Peca);
+    memcpy(destino + usado, p->elementos, (size_t)(p->topo + 1) * sizeof(Peca));
+    return usado + (size_t)(p->topo + 1) * sizeof(Peca);
+}
+
+/**
+ * @brief Restaura o estado gravado por serializarEstado().
+ * A fila ja deve existir com o mesmo limite gravado. A pilha tambem: com a mesma
+ * capacidade, ou com crescimento (ela cresce ate a capacidade gravada). O gerador,
+ * o proximo_id e a semente vao para a fonte da fila, que passa a usar IDs proprios
+ * continuando de proximo_id.
+ * @return Bytes consumidos, ou 0 se os dados nao sao um estado valido para esta fila.
+ */
+size_t desserializarEstado(const uint8_t *origem, size_t tamanho, Fila *f, Pilha *p) {
+    CabecalhoSalvo cab;
+
+    if (tamanho < sizeof(cab)) return 0;
+    memcpy(&cab, origem, sizeof(cab));
+    if (memcmp(cab.magico, SALVO_MAGICO, sizeof(cab.magico)) != 0 || cab.versao != SALVO_VERSAO ||
+        cab.proximo_id < 0 || cab.proximo_id > ID_PECA_MAX ||
+        cab.limite_fila != f->limite || cab.tamanho_fila > cab.limite_fila ||
+        cab.cap_pilha == 0 || cab.cap_pilha > (1u << 30) || cab.topo_pilha < -1 ||
+        cab.topo_pilha >= (int32_t)cab.cap_pilha || !gerador_valido(&cab.gerador) ||
+        ((cab.flags_pilha & SALVO_PILHA_CRESCE) != 0) != (p->crescer != NULL)) {
+        return 0;
+    }
+    size_t total = sizeof(cab) + (cab.tamanho_fila + (size_t)(cab.topo_pilha + 1)) * sizeof(Peca);
+    if (tamanho < total) return 0;
+
+    const uint8_t *pecas = origem + sizeof(cab);
+    if (!pecasValidas((const Peca *)(const void *)pecas, cab.tamanho_fila + (size_t)(cab.topo_pilha + 1))) return 0;
+    if (!pilha_reservar(p, (int)cab.cap_pilha) || p->capacidade != (int)cab.cap_pilha) return 0;
+    inicializarFila(f);
+    fila_enqueue_n(f, (const Peca *)(const void *)pecas, cab.tamanho_fila);
+    p->topo = cab.topo_pilha;
+    memcpy(p->elementos, pecas + cab.tamanho_fila * sizeof(Peca), (size_t)(p->topo + 1) * sizeof(Peca));
+    if (p->indice) pilha_reconstruirIndice(p);
+    f->fonte->gerador = cab.gerador;
+    f->fonte->proximo_id = cab.proximo_id;
+    f->fonte->fim_bloco = INT64_MAX;
+    f->fonte->alocador = NULL;
+    f->fonte->semente = cab.semente;
+    return total;
+}
+
+/**
+ * @brief Grava o estado em um arquivo com um unico write().
+ * A fonte da fila nao pode estar usando a thread produtora (as pecas ja geradas no
+ * anel nao fazem parte do estado).
+ * @return 1 em caso de sucesso, 0 caso contrario.
+ */
+int salvarEstado(const char *caminho, Fila *f, Pilha *p) {
+    size_t tamanho = estado_tamanhoSalvo(f, p);
+    uint8_t *buffer = malloc(tamanho);
+    if (!buffer) return 0;
+    serializarEstado(buffer, f, p);
+
+    int fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(caminho);
+        free(buffer);
+        return 0;
+    }
+    ssize_t n = write(fd, buffer, tamanho);
+    int ok = (n == (ssize_t)tamanho);
+    if (!ok) perror(caminho);
+    if (close(fd) != 0) ok = 0;
+    free(buffer);
+    return ok;
+}
+
+/**
+ * @brief Le um estado salvo com um unico read() e cria a fila e a pilha com os limites
+ * gravados (a pilha na arena da thread).
+ * @param f Fila ainda nao criada; a sua fonte e fonte_padrao.
+ * @param p Pilha ainda nao criada.
+ * @return 1 em caso de sucesso, 0 caso contrario (a fila nao fica criada).
+ */
+int carregarEstado(const char *caminho, Fila *f, Pilha *p) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        perror(caminho);
+        return 0;
+    }
+    off_t tamanho = lseek(fd, 0, SEEK_END);
+    uint8_t *buffer = tamanho > 0 ? malloc((size_t)tamanho) : NULL;
+    if (!buffer || pread(fd, buffer, (size_t)tamanho, 0) != tamanho) {
+        fprintf(stderr, "%s: nao foi possivel ler o estado salvo.\n", caminho);
+        free(buffer);
+        close(fd);
+        return 0;
+    }
+    close(fd);
+
+    CabecalhoSalvo cab;
+    int ok = 0;
+    if ((size_t)tamanho >= sizeof(cab)) {
+        memcpy(&cab, buffer, sizeof(cab));
+        if (criarPilha(p, arena_daThread(), (int)cab.cap_pilha, cab.flags_pilha & SALVO_PILHA_CRESCE) &&
+            criarFila(f, cab.limite_fila)) {
+            ok = desserializarEstado(buffer, (size_t)tamanho, f, p) != 0;
+            if (!ok) destruirFila(f);
+        }
+    }
+    if (!ok) fprintf(stderr, "%s: nao e um estado salvo da versao %d.\n", caminho, SALVO_VERSAO);
+    free(buffer);
+    return ok;
+}
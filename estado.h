@@ -0,0 +1,39 @@
+// Estado salvo (mestre --salvar / --carregar, simulacao --salvar): fila, pilha,
+// contador de IDs e gerador.
+//
+// Cabecalho seguido das pecas da fila (da frente para tras) e da pilha (da base
+// para o topo). O gerador e gravado no layout nativo: o arquivo so e lido na
+// mesma arquitetura em que foi gravado.
+
+#ifndef ESTADO_H
+#define ESTADO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pecas.h"
+
+#define SALVO_MAGICO "TTRSSAV1"
+#define SALVO_VERSAO 3
+#define SALVO_PILHA_CRESCE 1u  // flags_pilha: a pilha dobra de capacidade quando enche
+
+typedef struct {
+    char magico[8];         // SALVO_MAGICO (sem o '\0')
+    uint32_t versao;
+    uint32_t limite_fila;
+    uint32_t tamanho_fila;
+    int32_t topo_pilha;
+    uint32_t cap_pilha;     // Capacidade da pilha ao gravar
+    uint32_t flags_pilha;   // SALVO_PILHA_*
+    int64_t proximo_id;     // Continua como contador proprio da sessao ao carregar
+    uint64_t semente;       // Semente original da sessao (apenas informativa)
+    GeradorPecas gerador;   // Estado exato do gerador: as proximas pecas continuam iguais
+} CabecalhoSalvo;
+
+size_t estado_tamanhoSalvo(Fila *f, Pilha *p);
+size_t serializarEstado(uint8_t *destino, Fila *f, Pilha *p);
+size_t desserializarEstado(const uint8_t *origem, size_t tamanho, Fila *f, Pilha *p);
+int salvarEstado(const char *caminho, Fila *f, Pilha *p);
+int carregarEstado(const char *caminho, Fila *f, Pilha *p);
+
+#endif // ESTADO_H
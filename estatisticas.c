@@ -0,0 +1,182 @@
+// Registro dos contadores por thread e relatorio das estatisticas (ver estatisticas.h).
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "estatisticas.h"
+
+#ifndef TETRIS_SEM_ESTATISTICAS
+_Thread_local BlocoEstatisticas *est_bloco_local = NULL;
+_Thread_local uint32_t est_ate_amostra = 0;
+#endif
+
+// Nomes usados no relatorio, pelo codigo da acao e pelo EventoEstatistica
+static const char *NOMES_ACOES[NUM_CODIGOS_ACAO] = {"invalida", "jogar", "reservar", "usar", "trocar", "trocar3"};
+static const char *NOMES_EVENTOS[NUM_EVENTOS] = {"reabastecimento", "fila_vazia", "pilha_cheia", "pilha_vazia",
+                                                 "troca_insuficiente"};
+
+static BlocoEstatisticas *est_blocos = NULL;  // Todos os blocos ja registrados
+static pthread_mutex_t est_trava = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Cria o bloco de contadores da thread atual e o inclui na lista.
+ * Os blocos nunca sao liberados: o relatorio inclui threads que ja terminaram.
+ */
+BlocoEstatisticas *registrarBlocoEstatisticas(void) {
+    BlocoEstatisticas *b = calloc(1, sizeof(BlocoEstatisticas));
+    if (!b) {
+        fprintf(stderr, "Sem memoria para as estatisticas.\n");
+        exit(1);
+    }
+    pthread_mutex_lock(&est_trava);
+    b->proximo = est_blocos;
+    est_blocos = b;
+    pthread_mutex_unlock(&est_trava);
+    return b;
+}
+
+/**
+ * @brief Limite superior (em unidades do relogio) do balde onde cai o percentil 'q'.
+ */
+static uint64_t percentilBaldes(const uint64_t *baldes, double q) {
+    uint64_t total = 0, acumulado = 0;
+    for (int b = 0; b < EST_BALDES; b++) total += baldes[b];
+    uint64_t alvo = (uint64_t)(q * (double)total);
+    for (int b = 0; b < EST_BALDES; b++) {
+        acumulado += baldes[b];
+        if (acumulado > alvo) return 2ULL << b;
+    }
+    return 0;
+}
+
+/**
+ * @brief Soma os blocos de todas as threads e grava o relatorio em 'caminho'.
+ * Arquivos terminados em ".json" recebem JSON; os demais, texto.
+ * @return 1 em caso de sucesso, 0 se o arquivo nao pode ser gravado.
+ */
+int escreverEstatisticas(const char *caminho) {
+    uint64_t chamadas[NUM_CODIGOS_ACAO] = {0}, falhas[NUM_CODIGOS_ACAO] = {0}, eventos[NUM_EVENTOS] = {0};
+    uint64_t latencia[NUM_CODIGOS_ACAO][EST_BALDES] = {{0}};
+#if defined(__x86_64__) || defined(__i386__)
+    const char *unidade = "ciclos";
+#else
+    const char *unidade = "ns";
+#endif
+
+    pthread_mutex_lock(&est_trava);
+    for (BlocoEstatisticas *b = est_blocos; b; b = b->proximo) {
+        for (int a = 0; a < NUM_CODIGOS_ACAO; a++) {
+            chamadas[a] += atomic_load_explicit(&b->chamadas[a], memory_order_relaxed);
+            falhas[a] += atomic_load_explicit(&b->falhas[a], memory_order_relaxed);
+            for (int k = 0; k < EST_BALDES; k++) {
+                latencia[a][k] += atomic_load_explicit(&b->latencia[a][k], memory_order_relaxed);
+            }
+        }
+        for (int e = 0; e < NUM_EVENTOS; e++) {
+            eventos[e] += atomic_load_explicit(&b->eventos[e], memory_order_relaxed);
+        }
+    }
+
+    FILE *arq = fopen(caminho, "w");
+    if (!arq) {
+        pthread_mutex_unlock(&est_trava);
+        perror(caminho);
+        return 0;
+    }
+    size_t tam = strlen(caminho);
+    int json = tam >= 5 && strcmp(caminho + tam - 5, ".json") == 0;
+
+    if (json) {
+        fprintf(arq, "{\n  \"unidade\": \"%s\",\n  \"amostragem\": %d,\n  \"acoes\": {\n", unidade, EST_AMOSTRAGEM);
+        for (int a = 0; a < NUM_CODIGOS_ACAO; a++) {
+            fprintf(arq, "    \"%s\": {\"chamadas\": %llu, \"falhas\": %llu, \"p50\": %llu, \"p99\": %llu, \"baldes\": [",
+                    NOMES_ACOES[a], (unsigned long long)chamadas[a], (unsigned long long)falhas[a],
+                    (unsigned long long)percentilBaldes(latencia[a], 0.50),
+                    (unsigned long long)percentilBaldes(latencia[a], 0.99));
+            int primeiro = 1;
+            for (int k = 0; k < EST_BALDES; k++) {
+                if (!latencia[a][k]) continue;
+                fprintf(arq, "%s[%llu, %llu]", primeiro ? "" : ", ", 1ULL << k, (unsigned long long)latencia[a][k]);
+                primeiro = 0;
+            }
+            fprintf(arq, "]}%s\n", a < NUM_CODIGOS_ACAO - 1 ? "," : "");
+        }
+        fprintf(arq, "  },\n  \"eventos\": {");
+        for (int e = 0; e < NUM_EVENTOS; e++) {
+            fprintf(arq, "%s\"%s\": %llu", e ? ", " : "", NOMES_EVENTOS[e], (unsigned long long)eventos[e]);
+        }
+        fprintf(arq, "}\n}\n");
+    } else {
+        fprintf(arq, "# Estatisticas das acoes (latencia em %s, 1 a cada %d acoes; p50/p99 = limite do balde)\n",
+                unidade, EST_AMOSTRAGEM);
+        fprintf(arq, "%-10s %12s %12s %10s %10s\n", "acao", "chamadas", "falhas", "p50", "p99");
+        for (int a = 0; a < NUM_CODIGOS_ACAO; a++) {
+            fprintf(arq, "%-10s %12llu %12llu %10llu %10llu\n", NOMES_ACOES[a], (unsigned long long)chamadas[a],
+                    (unsigned long long)falhas[a],
+                    (unsigned long long)percentilBaldes(latencia[a], 0.50),
+                    (unsigned long long)percentilBaldes(latencia[a], 0.99));
+        }
+        fprintf(arq, "\n# Eventos\n");
+        for (int e = 0; e < NUM_EVENTOS; e++) {
+            fprintf(arq, "%-20s %12llu\n", NOMES_EVENTOS[e], (unsigned long long)eventos[e]);
+        }
+        fprintf(arq, "\n# Histogramas (balde [2^k, 2^(k+1)) %s: contagem)\n", unidade);
+        for (int a = 0; a < NUM_CODIGOS_ACAO; a++) {
+            if (!chamadas[a]) continue;
+            fprintf(arq, "%-10s", NOMES_ACOES[a]);
+            for (int k = 0; k < EST_BALDES; k++) {
+                if (latencia[a][k]) fprintf(arq, " %llu:%llu", 1ULL << k, (unsigned long long)latencia[a][k]);
+            }
+            fprintf(arq, "\n");
+        }
+    }
+    int ok = fclose(arq) == 0;
+    pthread_mutex_unlock(&est_trava);
+    return ok;
+}
+
+#ifndef TETRIS_SEM_ESTATISTICAS
+static const char *est_caminho = NULL; // Destino do relatorio pedido por SIGUSR1
+
+/**
+ * @brief Thread que espera SIGUSR1 e grava o relatorio a cada sinal.
+ */
+static void *lacoSinalEstatisticas(void *arg) {
+    sigset_t *sinais = arg;
+    int sinal;
+    while (sigwait(sinais, &sinal) == 0) {
+        escreverEstatisticas(est_caminho);
+    }
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Define o arquivo do relatorio e passa a atender SIGUSR1.
+ * Deve ser chamada antes de criar outras threads: o sinal fica bloqueado em todas
+ * elas e so a thread dedicada o recebe.
+ * @return 1 em caso de sucesso, 0 caso contrario.
+ */
+int iniciarEstatisticas(const char *caminho) {
+#ifdef TETRIS_SEM_ESTATISTICAS
+    (void)caminho;
+    fprintf(stderr, "Estatisticas indisponiveis: compilado com TETRIS_SEM_ESTATISTICAS.\n");
+    return 0;
+#else
+    static sigset_t sinais;
+    pthread_t thread;
+
+    est_caminho = caminho;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGUSR1);
+    if (pthread_sigmask(SIG_BLOCK, &sinais, NULL) != 0 ||
+        pthread_create(&thread, NULL, lacoSinalEstatisticas, &sinais) != 0) {
+        return 0;
+    }
+    pthread_detach(thread);
+    return 1;
+#endif
+}
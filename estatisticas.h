@@ -0,0 +1,107 @@
+// Estatisticas das acoes (--estatisticas arq): chamadas, falhas, eventos e histogramas
+// de latencia por acao, gravados no arquivo ao sair e a cada SIGUSR1.
+//
+// A instrumentacao (macros EST_*) e usada pelo nucleo em pecas.c; o registro dos
+// blocos e o relatorio ficam em estatisticas.c.
+// Compilar com -DTETRIS_SEM_ESTATISTICAS remove toda a instrumentacao.
+
+#ifndef ESTATISTICAS_H
+#define ESTATISTICAS_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define NUM_CODIGOS_ACAO 6  // 0 = codigo invalido, 1-5 = acoes
+#define EST_BALDES 40       // Balde b conta latencias em [2^b, 2^(b+1)) unidades do relogio
+#define EST_AMOSTRAGEM 64   // Mede a latencia de 1 a cada N acoes (contadores sao exatos)
+
+typedef enum {
+    EVENTO_REABASTECIMENTO = 0, // Peca nova inserida pelo dequeue
+    EVENTO_FILA_VAZIA,          // Acao recusada: fila vazia
+    EVENTO_PILHA_CHEIA,         // Reserva recusada: pilha cheia
+    EVENTO_PILHA_VAZIA,         // Acao recusada: pilha vazia
+    EVENTO_TROCA_INSUFICIENTE,  // Troca multipla recusada: menos de 3 pecas
+    NUM_EVENTOS
+} EventoEstatistica;
+
+// Contadores de uma thread. So a propria thread escreve (load + store relaxados,
+// sem instrucao travada); o relatorio soma os blocos de todas as threads.
+typedef struct BlocoEstatisticas {
+    _Atomic uint64_t chamadas[NUM_CODIGOS_ACAO];
+    _Atomic uint64_t falhas[NUM_CODIGOS_ACAO];
+    _Atomic uint64_t eventos[NUM_EVENTOS];
+    _Atomic uint64_t latencia[NUM_CODIGOS_ACAO][EST_BALDES];
+    struct BlocoEstatisticas *proximo; // Lista de todos os blocos (ver registrarBlocoEstatisticas)
+} BlocoEstatisticas;
+
+BlocoEstatisticas *registrarBlocoEstatisticas(void);
+int iniciarEstatisticas(const char *caminho);
+int escreverEstatisticas(const char *caminho);
+
+#ifndef TETRIS_SEM_ESTATISTICAS
+
+extern _Thread_local BlocoEstatisticas *est_bloco_local;
+extern _Thread_local uint32_t est_ate_amostra; // Acoes ate a proxima medicao de latencia
+
+static inline BlocoEstatisticas *est_bloco(void) {
+    if (!est_bloco_local) est_bloco_local = registrarBlocoEstatisticas();
+    return est_bloco_local;
+}
+
+static inline void est_somar(_Atomic uint64_t *contador, uint64_t valor) {
+    atomic_store_explicit(contador, atomic_load_explicit(contador, memory_order_relaxed) + valor,
+                          memory_order_relaxed);
+}
+
+/**
+ * @brief Relogio das latencias: ciclos (rdtsc) em x86, nanossegundos nos demais.
+ */
+static inline uint64_t est_relogio(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Inicio da medicao: le o relogio so nas acoes amostradas (0 nas demais).
+ */
+static inline uint64_t est_inicio(void) {
+    if (est_ate_amostra-- != 0) return 0;
+    est_ate_amostra = EST_AMOSTRAGEM - 1;
+    return est_relogio();
+}
+
+static inline void est_registrarAcao(int codigo, int sucesso, uint64_t inicio) {
+    BlocoEstatisticas *b = est_bloco();
+    if (codigo < 1 || codigo >= NUM_CODIGOS_ACAO) codigo = 0;
+    est_somar(&b->chamadas[codigo], 1);
+    est_somar(&b->falhas[codigo], !sucesso);
+    if (inicio) {
+        int balde = 63 - __builtin_clzll((est_relogio() - inicio) | 1);
+        if (balde >= EST_BALDES) balde = EST_BALDES - 1;
+        est_somar(&b->latencia[codigo][balde], 1);
+    }
+}
+
+#define EST_INICIO(t) uint64_t t = est_inicio()
+#define EST_ACAO(codigo, sucesso, t) est_registrarAcao((codigo), (sucesso), (t))
+#define EST_EVENTO(e) est_somar(&est_bloco()->eventos[(e)], 1)
+
+#else
+
+#define EST_INICIO(t) do { } while (0)
+#define EST_ACAO(codigo, sucesso, t) do { } while (0)
+#define EST_EVENTO(e) do { } while (0)
+
+#endif // TETRIS_SEM_ESTATISTICAS
+
+#endif // ESTATISTICAS_H
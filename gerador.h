@@ -0,0 +1,134 @@
+// Gerador de pecas com estado explicito (xoshiro256**), compartilhado pelos tres niveis.
+//
+// Cada sessao tem o seu proprio GeradorPecas: nada de estado global escondido como
+// em rand(), e a mesma semente sempre reproduz a mesma sequencia de pecas.
+//
+// Este cabecalho usa o tipo Peca (campos 'nome' e 'id'), por isso deve ser incluido
+// depois da definicao de Peca no programa.
+
+#ifndef GERADOR_H
+#define GERADOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GERADOR_NUM_TIPOS 7
+
+// Tipos de peca, na ordem dos codigos 0-6 devolvidos pelo gerador
+static const char GERADOR_TIPOS[GERADOR_NUM_TIPOS] = {'I', 'O', 'T', 'L', 'J', 'S', 'Z'};
+
+// Distribuicao dos tipos sorteados
+typedef enum {
+    GERADOR_UNIFORME = 0, // Cada peca e independente (1/7 para cada tipo)
+    GERADOR_SACO7 = 1     // "7-bag": cada bloco de 7 pecas contem os 7 tipos embaralhados
+} ModoGerador;
+
+typedef struct {
+    uint64_t s[4];                     // Estado do xoshiro256**
+    uint8_t saco[GERADOR_NUM_TIPOS];   // Permutacao do saco atual (modo GERADOR_SACO7)
+    uint8_t restantes;                 // Pecas ainda nao entregues do saco atual
+    uint8_t modo;                      // ModoGerador
+} GeradorPecas;
+
+
+// --- 1. Nucleo do Gerador ---
+
+static inline uint64_t gerador_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Proximo numero de 64 bits do xoshiro256**.
+ */
+static inline uint64_t gerador_proximo64(GeradorPecas *g) {
+    uint64_t *s = g->s;
+    uint64_t resultado = gerador_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = gerador_rotl(s[3], 45);
+    return resultado;
+}
+
+/**
+ * @brief Sorteia um inteiro em [0, n) sem divisao (multiplicacao de Lemire).
+ */
+static inline uint32_t gerador_intervalo(GeradorPecas *g, uint32_t n) {
+    uint32_t x = (uint32_t)(gerador_proximo64(g) >> 32);
+    return (uint32_t)(((uint64_t)x * n) >> 32);
+}
+
+/**
+ * @brief Inicializa o gerador a partir de uma semente de 64 bits (expandida com splitmix64).
+ */
+static inline void gerador_inicializar(GeradorPecas *g, uint64_t semente, ModoGerador modo) {
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (semente += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        g->s[i] = z ^ (z >> 31);
+    }
+    g->restantes = 0;
+    g->modo = (uint8_t)modo;
+}
+
+/**
+ * @brief Sorteia o codigo (0-6) do proximo tipo de peca, conforme o modo do gerador.
+ */
+static inline int gerador_proximoTipo(GeradorPecas *g) {
+    if (g->modo == GERADOR_UNIFORME) {
+        return (int)gerador_intervalo(g, GERADOR_NUM_TIPOS);
+    }
+    if (g->restantes == 0) {
+        // Novo saco: embaralha os 7 tipos (Fisher-Yates)
+        for (int i = 0; i < GERADOR_NUM_TIPOS; i++) {
+            g->saco[i] = (uint8_t)i;
+        }
+        for (int i = GERADOR_NUM_TIPOS - 1; i > 0; i--) {
+            int j = (int)gerador_intervalo(g, (uint32_t)i + 1);
+            uint8_t tmp = g->saco[i];
+            g->saco[i] = g->saco[j];
+            g->saco[j] = tmp;
+        }
+        g->restantes = GERADOR_NUM_TIPOS;
+    }
+    return g->saco[--g->restantes];
+}
+
+/**
+ * @brief Confere um estado de gerador lido de fora (arquivo salvo, sessoes, diario):
+ * modo conhecido e as pecas que faltam no saco com codigos 0-6.
+ * @return 1 se o estado e valido, 0 caso contrario.
+ */
+static inline int gerador_valido(const GeradorPecas *g) {
+    if ((g->modo != GERADOR_UNIFORME && g->modo != GERADOR_SACO7) || g->restantes > GERADOR_NUM_TIPOS) {
+        return 0;
+    }
+    for (int i = 0; i < g->restantes; i++) {
+        if (g->saco[i] >= GERADOR_NUM_TIPOS) return 0;
+    }
+    return 1;
+}
+
+
+// --- 2. Geracao de Pecas ---
+
+/**
+ * @brief Preenche 'destino' com n pecas novas em uma unica chamada.
+ * @param proximo_id Contador de IDs da sessao; avanca n posicoes (os n IDs devem estar
+ * no bloco reservado da sessao, ver gerarPecasDe).
+ */
+static inline void gerador_gerar_n(GeradorPecas *g, Peca *destino, size_t n, int64_t *proximo_id) {
+    int64_t id = *proximo_id;
+    for (size_t i = 0; i < n; i++) {
+        destino[i].nome = GERADOR_TIPOS[gerador_proximoTipo(g)];
+        destino[i].id = id++;
+    }
+    *proximo_id = id;
+}
+
+#endif // GERADOR_H
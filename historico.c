@@ -0,0 +1,82 @@
+// Anel de desfazer/refazer das acoes (ver historico.h).
+
+#include <stdlib.h>
+
+#include "historico.h"
+
+/**
+ * @brief Cria um historico vazio para as ultimas 'capacidade' acoes (arredondada para
+ * uma potencia de dois).
+ * @return 1 em caso de sucesso, 0 se a capacidade e invalida ou faltou memoria.
+ */
+int historico_criar(Historico *h, uint32_t capacidade) {
+    if (capacidade == 0 || capacidade > (1u << 30)) return 0;
+    uint32_t tamanho = 1;
+    while (tamanho < capacidade) tamanho <<= 1;
+
+    h->deltas = malloc((size_t)tamanho * sizeof(DeltaAcao));
+    if (!h->deltas) return 0;
+    h->mascara = tamanho - 1;
+    historico_limpar(h);
+    return 1;
+}
+
+void historico_destruir(Historico *h) {
+    free(h->deltas);
+    h->deltas = NULL;
+}
+
+/**
+ * @brief Esquece todas as acoes (ex.: a sessao foi recomecada).
+ */
+void historico_limpar(Historico *h) {
+    h->inicio = h->atual = h->fim = 0;
+}
+
+/**
+ * @brief Executa a acao e, se ela teve sucesso, a guarda no historico. Uma acao nova
+ * descarta o que podia ser refeito; com o anel cheio, a acao mais antiga e esquecida.
+ */
+ResultadoAcao historico_executar(Historico *h, int codigo, Fila *f, Pilha *p, EventoAcao *ev) {
+    DeltaAcao d; // Com o anel cheio, a posicao livre ainda guarda a acao mais antiga
+
+    ResultadoAcao r = historico_aplicar(&d, codigo, f, p, ev);
+    if (r == ACAO_OK) {
+        h->deltas[h->atual & h->mascara] = d;
+        h->atual++;
+        h->fim = h->atual;
+        if (h->atual - h->inicio > (uint64_t)h->mascara + 1) h->inicio++;
+    }
+    return r;
+}
+
+/**
+ * @brief Desfaz a ultima acao do historico, em tempo constante.
+ * @param desfeita Recebe o delta da acao desfeita (codigo e peca); pode ser NULL.
+ * @return 1 se uma acao foi desfeita, 0 se nao ha o que desfazer.
+ */
+int historico_desfazer(Historico *h, Fila *f, Pilha *p, DeltaAcao *desfeita) {
+    if (h->atual == h->inicio) return 0;
+
+    h->atual--;
+    const DeltaAcao *d = &h->deltas[h->atual & h->mascara];
+    historico_reverter(d, f, p);
+    if (desfeita) *desfeita = *d;
+    return 1;
+}
+
+/**
+ * @brief Refaz a ultima acao desfeita, executando-a de novo sobre o estado restaurado.
+ * @return 1 se uma acao foi refeita (resultado em ev), 0 se nao ha o que refazer.
+ */
+int historico_refazer(Historico *h, Fila *f, Pilha *p, EventoAcao *ev) {
+    if (h->atual == h->fim) return 0;
+
+    DeltaAcao *d = &h->deltas[h->atual & h->mascara];
+    if (historico_aplicar(d, d->codigo, f, p, ev) == ACAO_OK) {
+        h->atual++;
+    } else {
+        h->fim = h->atual; // A sessao mudou por fora do historico: nada mais a refazer
+    }
+    return 1;
+}
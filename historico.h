@@ -0,0 +1,110 @@
+// Historico de acoes para desfazer e refazer (mestre, opcoes 6 e 7) e o "faz/desfaz"
+// da busca em profundidade.
+//
+// Cada acao bem-sucedida vira um delta pequeno (DeltaAcao): o codigo, a peca que saiu
+// e, de antes da acao, os contadores da fila e da pilha e a posicao da fonte (estado
+// do gerador, proximo_id e bloco de IDs). Desfazer aplica o inverso da acao com as
+// operacoes O(1) de pecas.h, que tambem acertam os indices de tipos:
+//   1 jogar:    tira a peca do reabastecimento do fim e devolve a jogada a frente
+//   2 reservar: pop na pilha e depois o mesmo que jogar
+//   3 usar:     push da peca usada
+//   4 e 5:      cada troca e a propria inversa
+// e volta a fonte para onde estava, entao refazer e so executar a acao de novo: o
+// gerador entrega a mesma peca, com o mesmo ID (exceto se o reabastecimento abria um
+// bloco novo do alocador, que reserva outro bloco). Acoes que falham nao mudam a sessao
+// e nao entram no historico. Uma pilha que cresceu continua com a capacidade nova.
+// A fonte nao pode usar o produtor: as pecas do anel nao voltam para o gerador.
+
+#ifndef HISTORICO_H
+#define HISTORICO_H
+
+#include <stdint.h>
+
+#include "pecas.h"
+
+typedef struct {
+    GeradorPecas gerador;   // Fonte antes da acao (so o reabastecimento a muda)
+    int64_t proximo_id;
+    int64_t fim_bloco;
+    Peca peca;              // Peca jogada (1), reservada (2) ou usada (3)
+    uint32_t cabeca, cauda; // Contadores da fila antes da acao
+    int topo;               // Topo da pilha antes da acao
+    uint8_t codigo;
+    uint8_t reabastecida;   // 1 se a acao gerou uma peca no fim da fila
+} DeltaAcao;
+
+// Anel com as ultimas (mascara + 1) acoes. Os contadores so crescem:
+// [inicio, atual) pode ser desfeito e [atual, fim) refeito.
+typedef struct {
+    DeltaAcao *deltas;
+    uint32_t mascara;
+    uint64_t inicio, atual, fim;
+} Historico;
+
+
+// --- 1. Delta de uma Acao (caminho quente) ---
+
+/**
+ * @brief Executa a acao e guarda em d o necessario para desfaze-la.
+ * @return O resultado da acao; d so vale se ele for ACAO_OK.
+ */
+static inline ResultadoAcao historico_aplicar(DeltaAcao *d, int codigo, Fila *f, Pilha *p, EventoAcao *ev) {
+    d->codigo = (uint8_t)codigo;
+    d->cabeca = f->cabeca;
+    d->cauda = f->cauda;
+    d->topo = p->topo;
+    d->gerador = f->fonte->gerador;
+    d->proximo_id = f->fonte->proximo_id;
+    d->fim_bloco = f->fonte->fim_bloco;
+
+    ResultadoAcao r = executarAcao(codigo, f, p, ev);
+    d->peca = ev->peca;
+    d->reabastecida = (uint8_t)ev->reabastecida;
+    return r;
+}
+
+/**
+ * @brief Desfaz a acao de d, que precisa ser a ultima aplicada a f e p.
+ */
+static inline void historico_reverter(const DeltaAcao *d, Fila *f, Pilha *p) {
+    EventoAcao ev;
+
+    switch (d->codigo) {
+        case 1:
+        case 2:
+            if (d->codigo == 2) pop(p); // O resto e o inverso de jogar
+            if (d->reabastecida) {
+                uint32_t idx = d->cauda & f->mascara;
+                if (f->indice) indice_desmarcar(f->indice, f->elementos[idx].nome, idx);
+                f->cauda = d->cauda;
+                f->fonte->gerador = d->gerador;
+                f->fonte->proximo_id = d->proximo_id;
+                f->fonte->fim_bloco = d->fim_bloco;
+            }
+            f->cabeca = d->cabeca;
+            f->elementos[d->cabeca & f->mascara] = d->peca;
+            if (f->indice) indice_marcar(f->indice, d->peca.nome, d->cabeca & f->mascara);
+            break;
+        case 3:
+            push(p, d->peca);
+            break;
+        case 4:
+            trocarPecaUnicaAcao(f, p, &ev);
+            break;
+        case 5:
+            fila_pilha_trocar_n(f, p, NUM_TROCA_MULTIPLA);
+            break;
+    }
+}
+
+
+// --- 2. Anel de Desfazer/Refazer ---
+
+int historico_criar(Historico *h, uint32_t capacidade);
+void historico_destruir(Historico *h);
+void historico_limpar(Historico *h);
+ResultadoAcao historico_executar(Historico *h, int codigo, Fila *f, Pilha *p, EventoAcao *ev);
+int historico_desfazer(Historico *h, Fila *f, Pilha *p, DeltaAcao *desfeita);
+int historico_refazer(Historico *h, Fila *f, Pilha *p, EventoAcao *ev);
+
+#endif // HISTORICO_H
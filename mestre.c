@@ -1,414 +1,967 @@
+#define _GNU_SOURCE // ppoll(): espera com resolucao de nanossegundos no modo em tempo real
+
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-
-// Definições de Capacidade
-#define CAP_FILA 5   // Capacidade fixa da fila circular
-#define CAP_PILHA 3  // Capacidade maxima da pilha de reserva
-
-// Variavel global para o ID unico das pecas
-int proximo_id = 0;
-
-// --- Estruturas de Dados ---
-
-// Atributos das pecas: nome (tipo) e id
-typedef struct {
-    char nome; // Tipo da peca: 'I', 'O', 'T', 'L', 'J', 'S', 'Z'
-    int id;    // Identificador unico
-} Peca;
-
-// Estrutura para a Fila Circular
-typedef struct {
-    Peca elementos[CAP_FILA];
-    int inicio; 
-    int fim;    
-    int tamanho_atual;
-} Fila;
-
-// Estrutura para a Pilha Estatica (Peças Reservadas)
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "pecas.h"
+#include "arena.h"
+#include "produtor.h"
+#include "diario.h"
+#include "estado.h"
+#include "estatisticas.h"
+#include "tabuleiro.h"
+#include "tela.h"
+#include "teclado.h"
+#include "entrada.h"
+#include "historico.h"
+
+// Tamanho do bloco lido de uma vez no modo em lote
+#define TAM_BLOCO_LOTE (1 << 16)
+
+// Linhas reservadas para mensagens de status no quadro do menu
+#define LINHAS_STATUS 6
+
+// Acoes que o menu consegue desfazer (opcao 6)
+#define HISTORICO_ACOES 1024
+
+// Quanto as acoes informam na tela (--nivel / --silencioso)
+typedef enum {
+    SAIDA_SILENCIOSA = 0, // Apenas o estado e o menu (tambem usado no modo em lote)
+    SAIDA_ACOES = 1,      // Resultado de cada acao
+    SAIDA_DETALHADA = 2   // Acoes e cada [REABASTECIMENTO]
+} NivelSaida;
+
+int nivel_saida = SAIDA_DETALHADA;
+
+// Mensagens de acao: vao para a area de status do proximo quadro, conforme o nivel
+#define LOG_ACAO(...) do { if (nivel_saida >= SAIDA_ACOES) tela_status(&tela, __VA_ARGS__); } while (0)
+#define LOG_REABASTECIMENTO(...) do { if (nivel_saida >= SAIDA_DETALHADA) tela_status(&tela, __VA_ARGS__); } while (0)
+
+// Terminal do menu interativo (um write() por quadro)
+Tela tela;
+
+// Diario da sessao (--diario); NULL quando desativado
+Diario *diario_sessao = NULL;
+
+// Tabuleiro onde as pecas jogadas e usadas sao colocadas (--tabuleiro); NULL quando desativado
+Tabuleiro *tabuleiro_sessao = NULL;
+long long fins_de_jogo = 0; // Vezes em que uma peca nao coube e o tabuleiro foi esvaziado
+
+// Desfazer/refazer do menu (opcoes 6 e 7); NULL quando a sessao nao permite (ver main)
+Historico *historico_sessao = NULL;
+
+// Peca que esta caindo no modo em tempo real (--tempo-real). Ela continua na fila (ou na
+// reserva) ate travar: so entao a acao 'origem' a tira do jogo, como no menu.
 typedef struct {
-    Peca elementos[CAP_PILHA];
-    int topo; // Indice do ultimo elemento (topo da pilha)
-} Pilha;
-
-// --- Prototipos de Funcoes de Utilitario ---
-Peca gerarPeca();
+    int ativa;
+    int origem;        // 1 = frente da fila, 3 = topo da reserva
+    int64_t id;        // Para perceber quando outra acao trocou a peca
+    int tipo, rotacao, coluna, linha;
+    int ticks_queda;   // Ticks desde a ultima descida pela gravidade
+    int ticks_apoiada; // Ticks parada sobre um bloco (trava em TR_TRAVA_TICKS)
+    int adiamentos;    // Movimentos que ja reiniciaram a contagem da trava
+} PecaCaindo;
+
+PecaCaindo peca_caindo = {0};
+
+// --- Prototipos ---
 void exibirEstado(Fila *f, Pilha *p);
-
-// --- Prototipos de Funcoes da Fila ---
-void inicializarFila(Fila *f);
-int fila_estaVazia(Fila *f);
-int fila_estaCheia(Fila *f);
-int enqueue(Fila *f, Peca p);
-Peca dequeue(Fila *f);
-
-// --- Prototipos de Funcoes da Pilha ---
-void inicializarPilha(Pilha *p);
-int pilha_estaVazia(Pilha *p);
-int pilha_estaCheia(Pilha *p);
-int push(Pilha *p, Peca peca);
-Peca pop(Pilha *p);
-
-// --- Prototipos de Funcoes de Acao Estrategica ---
-void jogarPecaAcao(Fila *f);
-void reservarPecaAcao(Fila *f, Pilha *p);
-void usarPecaReservadaAcao(Pilha *p, Fila *f);
-void trocarPecaUnicaAcao(Fila *f, Pilha *p);
-void trocarPecasMultiplaAcao(Fila *f, Pilha *p);
+void relatarAcao(const EventoAcao *ev, Fila *f, Pilha *p);
+void colocarNoTabuleiro(const EventoAcao *ev);
+void desfazerOuRefazer(int codigo, Fila *f, Pilha *p);
 void menuPrincipal(Fila *f, Pilha *p);
+int executarLote(int fd, Fila *f, Pilha *p);
+int executarTempoReal(Fila *f, Pilha *p);
 
 
 // =========================================================================
 //                       IMPLEMENTACAO DAS FUNCOES
 // =========================================================================
+// Fila, Pilha e as acoes vem do nucleo (pecas.h); aqui ficam apenas a tela, as
+// mensagens de cada acao, o menu, o modo em lote e o modo em tempo real.
 
-// --- 1. Funcoes de Utilitario ---
-
-/**
- * @brief Gera uma nova peca com um tipo aleatorio e um ID unico.
- * @return Retorna a estrutura Peca gerada.
- */
-Peca gerarPeca() {
-    Peca nova_peca;
-    char tipos[] = {'I', 'O', 'T', 'L', 'J', 'S', 'Z'};
-    int num_tipos = sizeof(tipos) / sizeof(tipos[0]);
-    
-    // Inicializa o gerador de numeros aleatorios (garantindo que seja chamado uma vez)
-    static int rand_inicializado = 0;
-    if (!rand_inicializado) {
-        srand(time(NULL));
-        rand_inicializado = 1;
-    }
-
-    // Escolhe um tipo aleatorio
-    nova_peca.nome = tipos[rand() % num_tipos];
-    
-    // Atribui o ID unico e incrementa o contador global
-    nova_peca.id = proximo_id++;
-    
-    return nova_peca;
-}
+// --- 1. Funcoes de Exibicao ---
 
 /**
- * @brief Exibe o estado atual da fila e da pilha.
+ * @brief Monta o estado atual da fila e da pilha no quadro da tela.
  * @param f Ponteiro para a Fila.
  * @param p Ponteiro para a Pilha.
  */
 void exibirEstado(Fila *f, Pilha *p) {
+    char linha[TELA_MAX_COLUNAS + 1];
+    size_t usado;
+
+    tela_linha(&tela, "--- 🧩 ESTADO ATUAL DAS ESTRUTURAS 🧩 ---");
+
     // --- Visualizacao da Fila ---
-    printf("\n--- 🧩 ESTADO ATUAL DAS ESTRUTURAS 🧩 ---\n");
-    printf("Fila de Pecas (Frente -> Tras) [%d/%d]: ", f->tamanho_atual, CAP_FILA);
+    uint32_t tamanho = fila_tamanho(f);
+    usado = (size_t)snprintf(linha, sizeof(linha), "Fila de Pecas (Frente -> Tras) [%u/%u]: ", tamanho, f->limite);
     if (fila_estaVazia(f)) {
-        printf("[VAZIA]");
+        snprintf(linha + usado, sizeof(linha) - usado, "[VAZIA]");
     } else {
-        for (int i = 0; i < f->tamanho_atual; i++) {
+        // Para quando a linha enche: o resto nao caberia na tela
+        for (uint32_t i = 0; i < tamanho && usado < sizeof(linha) - 1; i++) {
             // Calcula o indice na fila circular
-            int idx = (f->inicio + i) % CAP_FILA;
-            printf("[%c %d]", f->elementos[idx].nome, f->elementos[idx].id);
-            if (i < f->tamanho_atual - 1) printf(" -> ");
+            uint32_t idx = (f->cabeca + i) & f->mascara;
+            usado += (size_t)snprintf(linha + usado, sizeof(linha) - usado, "[%c %lld]%s",
+                                      f->elementos[idx].nome, (long long)f->elementos[idx].id,
+                                      i < tamanho - 1 ? " -> " : "");
         }
     }
+    tela_linha(&tela, "%s", linha);
 
     // --- Visualizacao da Pilha ---
-    printf("\nPilha de Reserva (Topo -> Base) [%d/%d]: ", p->topo + 1, CAP_PILHA);
+    usado = (size_t)snprintf(linha, sizeof(linha), "Pilha de Reserva (Topo -> Base) [%d/%d]: ", p->topo + 1, p->capacidade);
     if (pilha_estaVazia(p)) {
-        printf("[VAZIA]");
+        snprintf(linha + usado, sizeof(linha) - usado, "[VAZIA]");
     } else {
         // Itera do topo (maior indice) ate a base (indice 0)
-        for (int i = p->topo; i >= 0; i--) {
-            printf("[%c %d]", p->elementos[i].nome, p->elementos[i].id);
-            if (i > 0) printf(" -> ");
+        for (int i = p->topo; i >= 0 && usado < sizeof(linha) - 1; i--) {
+            usado += (size_t)snprintf(linha + usado, sizeof(linha) - usado, "[%c %lld]%s",
+                                      p->elementos[i].nome, (long long)p->elementos[i].id, i > 0 ? " -> " : "");
         }
     }
-    printf("\n--------------------------------------------\n");
+    tela_linha(&tela, "%s", linha);
+
+    // --- Dicas do indice de tipos: quantas de cada tipo e a distancia ate a primeira ---
+    if (f->indice && p->indice) {
+        usado = (size_t)snprintf(linha, sizeof(linha), "Previsao (qtd@distancia):");
+        for (int t = 0; t < GERADOR_NUM_TIPOS && usado < sizeof(linha) - 1; t++) {
+            char nome = GERADOR_TIPOS[t];
+            int distancia = fila_distanciaTipo(f, nome);
+            if (distancia >= 0) {
+                usado += (size_t)snprintf(linha + usado, sizeof(linha) - usado, " %c %u@%d", nome,
+                                          fila_contarTipo(f, nome), distancia);
+            } else {
+                usado += (size_t)snprintf(linha + usado, sizeof(linha) - usado, " %c 0", nome);
+            }
+        }
+        if (usado < sizeof(linha) - 1) {
+            usado += (size_t)snprintf(linha + usado, sizeof(linha) - usado, " | Reserva tem:");
+        }
+        for (int t = 0; t < GERADOR_NUM_TIPOS && usado < sizeof(linha) - 1; t++) {
+            if (pilha_contemTipo(p, GERADOR_TIPOS[t])) {
+                usado += (size_t)snprintf(linha + usado, sizeof(linha) - usado, " %c", GERADOR_TIPOS[t]);
+            }
+        }
+        tela_linha(&tela, "%s", linha);
+    }
+
+    // --- Tabuleiro: duas linhas por linha de texto, com meios blocos ---
+    if (tabuleiro_sessao) {
+        const Tabuleiro *t = tabuleiro_sessao;
+        Colocacao colocacoes[2 * TABULEIRO_MAX_COLOCACOES];
+        int n = gerarColocacoesJogada(t, f, p, colocacoes);
+        Tabuleiro vista;
+        if (peca_caindo.ativa) { // Desenha a peca que cai sobre uma copia do tabuleiro
+            const PecaCaindo *c = &peca_caindo;
+            uint64_t forma = FORMAS_PECA[c->tipo][c->rotacao] << c->coluna;
+            vista = *t;
+            for (int r = 0; r < TABULEIRO_LINHAS_PECA; r++) vista.linhas[c->linha + r] |= (uint16_t)(forma >> (16 * r));
+            t = &vista;
+        }
+        int da_fila = 0;
+        while (da_fila < n && colocacoes[da_fila].acao == 1) da_fila++;
+        tela_linha(&tela, "Tabuleiro %dx%d: pecas=%llu linhas=%llu fins=%lld | colocacoes: fila %d, reserva %d",
+                   t->largura, t->altura, (unsigned long long)t->pecas, (unsigned long long)t->eliminadas,
+                   fins_de_jogo, da_fila, n - da_fila);
+        for (int y = t->altura - 1; y >= 0; y -= 2) {
+            uint16_t cima = t->linhas[y];
+            uint16_t baixo = y > 0 ? t->linhas[y - 1] : t->vazia;
+            usado = (size_t)snprintf(linha, sizeof(linha), "|");
+            for (int c = 0; c < t->largura; c++) {
+                int a = (cima >> c) & 1, b = (baixo >> c) & 1;
+                usado += (size_t)snprintf(linha + usado, sizeof(linha) - usado, "%s",
+                                          a ? (b ? "█" : "▀") : (b ? "▄" : " "));
+            }
+            snprintf(linha + usado, sizeof(linha) - usado, "|");
+            tela_linha(&tela, "%s", linha);
+        }
+    }
+    tela_linha(&tela, "--------------------------------------------");
 }
 
+/**
+ * @brief Escreve na area de status as mensagens de uma acao, a partir do seu evento.
+ * @param f Fila apos a acao (para as contagens das mensagens de erro).
+ * @param p Pilha apos a acao.
+ */
+void relatarAcao(const EventoAcao *ev, Fila *f, Pilha *p) {
+    const Peca *a = &ev->peca;
+    const Peca *b = &ev->outra;
 
-// --- 2. Implementacao da Fila Circular ---
+    if (ev->reabastecida) {
+        LOG_REABASTECIMENTO("[REABASTECIMENTO] Nova peca [%c %lld] adicionada ao final da fila.\n", ev->nova.nome, (long long)ev->nova.id);
+    }
+    if (ev->resultado == ACAO_FALHA_INTERNA) {
+        LOG_ACAO("\n❌ ERRO: Falha no re-push apos a troca. Estado das estruturas pode estar comprometido.\n");
+        return;
+    }
+    switch (ev->codigo) {
+        case 1:
+            if (ev->resultado == ACAO_OK) {
+                LOG_ACAO("\n✅ ACAO: Peca [%c %lld] foi JOGADA (removida da frente da fila).\n", a->nome, (long long)a->id);
+            } else {
+                LOG_ACAO("\n❌ ERRO: Nao e possivel jogar. Fila de pecas futuras esta vazia.\n");
+            }
+            break;
+        case 2:
+            if (ev->resultado == ACAO_OK) {
+                LOG_ACAO("\n✅ ACAO: Peca [%c %lld] foi RESERVADA (movida da Fila para a Pilha).\n", a->nome, (long long)a->id);
+            } else if (ev->resultado == ACAO_PILHA_CHEIA) {
+                LOG_ACAO("\n❌ ERRO: A Pilha de Reserva esta CHEIA (%d/%d). Nao e possivel reservar.\n", p->capacidade, p->capacidade);
+            } else {
+                LOG_ACAO("\n❌ ERRO: A Fila de pecas esta VAZIA. Nao ha o que reservar.\n");
+            }
+            break;
+        case 3:
+            if (ev->resultado == ACAO_OK) {
+                LOG_ACAO("\n✅ ACAO: Peca [%c %lld] foi USADA (removida do topo da Pilha).\n", a->nome, (long long)a->id);
+            } else {
+                LOG_ACAO("\n❌ ERRO: Nao e possivel usar. Pilha de reserva esta vazia.\n");
+            }
+            break;
+        case 4:
+            if (ev->resultado == ACAO_OK) {
+                LOG_ACAO("\n✅ ACAO: TROCA UNICA realizada.\n");
+                LOG_ACAO("  - Fila (frente): [%c %lld] -> [%c %lld]\n", a->nome, (long long)a->id, b->nome, (long long)b->id);
+                LOG_ACAO("  - Pilha (topo): [%c %lld] -> [%c %lld]\n", b->nome, (long long)b->id, a->nome, (long long)a->id);
+            } else if (ev->resultado == ACAO_PILHA_VAZIA) {
+                LOG_ACAO("\n❌ ERRO: Pilha de reserva vazia. Nao ha o que trocar.\n");
+            } else {
+                LOG_ACAO("\n❌ ERRO: Fila de pecas vazia. Nao ha o que trocar.\n");
+            }
+            break;
+        case 5:
+            if (ev->resultado == ACAO_OK) {
+                LOG_ACAO("\n>>> 5. TROCA MULTIPLA INICIADA (3x3) <<<\n");
+                LOG_ACAO("✅ ACAO: Troca em BLOCO (3 pecas) realizada com sucesso.\n");
+            } else if (ev->resultado == ACAO_FILA_CURTA) {
+                LOG_ACAO("\n❌ ERRO: A Fila deve ter pelo menos %d pecas. (Atual: %u)\n", NUM_TROCA_MULTIPLA, fila_tamanho(f));
+            } else {
+                LOG_ACAO("\n❌ ERRO: A Pilha deve ter pelo menos %d pecas. (Atual: %d)\n", NUM_TROCA_MULTIPLA, p->topo + 1);
+            }
+            break;
+    }
+}
 
-void inicializarFila(Fila *f) {
-    f->inicio = 0;
-    f->fim = -1; // Com a fila circular, -1 indica que nao ha elementos
-    f->tamanho_atual = 0;
+/**
+ * @brief Coloca no tabuleiro a peca que uma acao tirou do jogo (jogada ou reserva usada).
+ * Se ela nao cabe, e fim de jogo: o tabuleiro e esvaziado e a partida continua.
+ */
+void colocarNoTabuleiro(const EventoAcao *ev) {
+    if (!tabuleiro_sessao || ev->resultado != ACAO_OK || (ev->codigo != 1 && ev->codigo != 3)) return;
+
+    int eliminadas = tabuleiro_colocarPeca(tabuleiro_sessao, ev->peca);
+    if (eliminadas < 0) {
+        fins_de_jogo++;
+        tabuleiro_limpar(tabuleiro_sessao);
+        LOG_ACAO("💥 FIM DE JOGO: a peca [%c %lld] nao coube. Tabuleiro esvaziado.\n", ev->peca.nome, (long long)ev->peca.id);
+    } else if (eliminadas > 0) {
+        LOG_ACAO("🧱 %d linha(s) completa(s) eliminada(s).\n", eliminadas);
+    }
 }
 
-int fila_estaVazia(Fila *f) {
-    return (f->tamanho_atual == 0);
+/**
+ * @brief Opcoes 6 (desfazer) e 7 (refazer) do menu.
+ */
+void desfazerOuRefazer(int codigo, Fila *f, Pilha *p) {
+    static const char *nomes[] = {"", "JOGAR", "RESERVAR", "USAR", "TROCA UNICA", "TROCA MULTIPLA"};
+    DeltaAcao desfeita;
+    EventoAcao ev;
+
+    if (codigo == 6) {
+        if (historico_desfazer(historico_sessao, f, p, &desfeita)) {
+            if (desfeita.codigo <= 3) {
+                LOG_ACAO("\n↩️  DESFEITO: %s da peca [%c %lld].\n", nomes[desfeita.codigo], desfeita.peca.nome,
+                         (long long)desfeita.peca.id);
+            } else {
+                LOG_ACAO("\n↩️  DESFEITO: %s.\n", nomes[desfeita.codigo]);
+            }
+        } else {
+            tela_status(&tela, "[ALERTA] Nao ha acao para desfazer.\n");
+        }
+    } else if (historico_refazer(historico_sessao, f, p, &ev)) {
+        LOG_ACAO("\n↪️  REFEITO: %s\n", nomes[ev.codigo]);
+        relatarAcao(&ev, f, p);
+    } else {
+        tela_status(&tela, "[ALERTA] Nao ha acao para refazer.\n");
+    }
 }
 
-int fila_estaCheia(Fila *f) {
-    return (f->tamanho_atual == CAP_FILA);
+
+// --- 2. Menu Principal ---
+
+/**
+ * @brief Monta o quadro completo do menu (estado, status e opcoes) e o desenha.
+ */
+static void desenharMenu(Fila *f, Pilha *p) {
+    tela_iniciarQuadro(&tela);
+    exibirEstado(f, p);
+    tela_areaStatus(&tela, LINHAS_STATUS);
+    tela_linha(&tela, "================ OPCOES ESTRATEGICAS ================");
+    tela_linha(&tela, "Codigo | Acao");
+    tela_linha(&tela, "---------------------------------------------------");
+    tela_linha(&tela, "  1    | Jogar peca da fila (Dequeue e Reabastecer)");
+    tela_linha(&tela, "  2    | Reservar peca (Fila -> Pilha)");
+    tela_linha(&tela, "  3    | Usar peca reservada (Pop Pilha)");
+    tela_linha(&tela, "  4    | Trocar peca atual (Frente Fila <-> Topo Pilha)");
+    tela_linha(&tela, "  5    | Trocar 3 pecas (3 Fila <-> 3 Pilha)");
+    if (historico_sessao) {
+        tela_linha(&tela, "  6    | Desfazer a ultima acao");
+        tela_linha(&tela, "  7    | Refazer a acao desfeita");
+    }
+    tela_linha(&tela, "  0    | Sair do Programa");
+    tela_linha(&tela, "===================================================");
+    tela_linha(&tela, "Escolha o Codigo da Acao: ");
+    tela_desenhar(&tela);
 }
 
 /**
- * @brief Insere uma nova peca no final da fila (enqueue).
+ * @brief Menu interativo. Os codigos chegam em lotes (entrada.h): tudo o que ja foi
+ * digitado ou enviado por pipe e aplicado, e so entao o quadro e redesenhado.
  */
-int enqueue(Fila *f, Peca p) {
-    if (fila_estaCheia(f)) {
-        return 0; // Falha: Fila Cheia
-    }
-    
-    f->fim = (f->fim + 1) % CAP_FILA;
-    f->elementos[f->fim] = p;
-    f->tamanho_atual++;
-    return 1; // Sucesso
+void menuPrincipal(Fila *f, Pilha *p) {
+    static LeitorEntrada leitor;
+    ComandoEntrada lote[ENTRADA_MAX_LOTE];
+    EventoAcao ev;
+    int sair = 0;
+
+    fflush(stdout); // O que ja foi impresso com printf vem antes do primeiro quadro
+    entrada_iniciar(&leitor, STDIN_FILENO);
+    while (!sair) {
+        desenharMenu(f, p);
+
+        int n = entrada_lerComandos(&leitor, lote, ENTRADA_MAX_LOTE);
+        if (n <= 0) break; // Fim da entrada (ou erro de leitura)
+        for (int i = 0; i < n && !sair; i++) {
+            if (!lote[i].valido) {
+                // Erros de entrada aparecem em qualquer nivel de saida
+                tela_status(&tela, "[ERRO] Entrada invalida. Por favor, digite um numero.\n");
+            } else if (lote[i].codigo == 0) {
+                // Mensagens de comandos anteriores do mesmo lote ainda nao foram mostradas
+                if (tela.tam_status > 0) desenharMenu(f, p);
+                printf("\n👋 Gerenciador de Pecas Encerrado. Bom jogo!\n");
+                sair = 1;
+            } else if (lote[i].codigo == 6 || lote[i].codigo == 7) {
+                if (historico_sessao) {
+                    desfazerOuRefazer(lote[i].codigo, f, p);
+                } else {
+                    tela_status(&tela, "[ALERTA] Desfazer/refazer nao vale com --diario, --tabuleiro ou --produtor.\n");
+                }
+            } else if ((historico_sessao ? historico_executar(historico_sessao, lote[i].codigo, f, p, &ev)
+                                         : executarAcaoDiario(diario_sessao, lote[i].codigo, f, p, &ev)) == ACAO_INVALIDA) {
+                tela_status(&tela, "[ALERTA] Opcao invalida. Tente novamente.\n");
+            } else {
+                relatarAcao(&ev, f, p);
+                colocarNoTabuleiro(&ev);
+            }
+        }
+    }
 }
 
+
+// --- 3. Modo em Lote (sem menu) ---
+
 /**
- * @brief Remove a peca da frente da fila (dequeue).
+ * @brief Le codigos de acao de um descritor em blocos grandes e os aplica sem nenhuma saida por acao.
+ * Cada digito '1'-'5' e uma acao; espacos e quebras de linha sao ignorados; '0' encerra o lote.
+ * Ao final imprime apenas o resumo do estado e a vazao (acoes/s).
+ * @param fd Descritor de onde as acoes sao lidas (arquivo ou stdin).
+ * @return 0 em caso de sucesso, 1 se houve erro de leitura.
  */
-Peca dequeue(Fila *f) {
-    Peca peca_removida = {' ', -1}; // Peca de erro
-    
-    if (fila_estaVazia(f)) {
-        return peca_removida; // Falha: Fila Vazia
-    }
-    
-    peca_removida = f->elementos[f->inicio];
-    f->inicio = (f->inicio + 1) % CAP_FILA;
-    f->tamanho_atual--;
-
-    // Auto-reabastecimento: tenta inserir uma nova peça
-    if (f->tamanho_atual < CAP_FILA) {
-        Peca nova = gerarPeca();
-        if (enqueue(f, nova)) {
-             printf("[REABASTECIMENTO] Nova peca [%c %d] adicionada ao final da fila.\n", nova.nome, nova.id);
+int executarLote(int fd, Fila *f, Pilha *p) {
+    static char bloco[TAM_BLOCO_LOTE];
+    long long total = 0, falhas = 0, invalidos = 0;
+    EventoAcao ev;
+    int encerrar = 0;
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while (!encerrar) {
+        ssize_t lidos = read(fd, bloco, sizeof(bloco));
+        if (lidos == 0) break;
+        if (lidos < 0) {
+            perror("read");
+            return 1;
+        }
+        for (ssize_t i = 0; i < lidos; i++) {
+            char c = bloco[i];
+            if (c >= '1' && c <= '5') {
+                falhas += executarAcaoDiario(diario_sessao, c - '0', f, p, &ev) != ACAO_OK;
+                colocarNoTabuleiro(&ev);
+                total++;
+            } else if (c == '0') {
+                encerrar = 1;
+                break;
+            } else if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+                invalidos++;
+            }
         }
     }
-    return peca_removida;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double segundos = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("acoes=%lld falhas=%lld invalidos=%lld semente=%llu\n", total, falhas, invalidos,
+           (unsigned long long)f->fonte->semente);
+    printf("fila=%u/%u pilha=%d/%d proximo_id=%lld hash=%016llx\n",
+           fila_tamanho(f), f->limite, p->topo + 1, p->capacidade, (long long)proximoIdJogo(f->fonte),
+           (unsigned long long)hashEstado(f, p));
+    printf("tempo=%.6fs vazao=%.0f acoes/s\n", segundos, segundos > 0 ? total / segundos : 0.0);
+    return 0;
 }
 
-// --- 3. Implementacao da Pilha Estatica ---
 
-void inicializarPilha(Pilha *p) {
-    p->topo = -1; // -1 indica que a pilha esta vazia
+// --- 4. Modo em Tempo Real ---
+//
+// Laco de eventos: o terminal fica em modo bruto e cada tecla e tratada assim que
+// chega (ppoll sobre stdin, sem Enter). O jogo avanca em ticks de duracao fixa,
+// agendados no relogio monotono: gravidade, trava da peca apoiada e, ao travar, a
+// acao que a tira do jogo e reabastece a fila. Um quadro so e desenhado quando algo
+// mudou. Sao medidos o tempo entre a chegada de uma tecla e o fim do quadro que a
+// mostra, e o atraso de cada tick em relacao ao horario agendado (jitter).
+
+#define TR_TICKS_POR_SEGUNDO 60
+#define TR_TICK_NS (1000000000ULL / TR_TICKS_POR_SEGUNDO)
+#define TR_GRAVIDADE_MS 500      // Padrao de --gravidade: uma linha a cada 0.5 s
+#define TR_TRAVA_TICKS 30        // Ticks apoiada ate travar (lock delay)
+#define TR_MAX_ADIAMENTOS 15     // Movimentos que ainda reiniciam a trava
+#define TR_MAX_ATRASO_TICKS 5    // Ticks atrasados recuperados de uma vez; alem disso o agendamento e realinhado
+#define TR_BALDES 40             // Balde b conta tempos em [2^b, 2^(b+1)) nanossegundos
+
+int gravidade_ticks = TR_GRAVIDADE_MS * TR_TICKS_POR_SEGUNDO / 1000; // Ticks por linha de queda
+
+// Tempos medidos no laco (latencia da entrada ou jitter dos ticks)
+typedef struct {
+    uint64_t amostras;
+    uint64_t soma_ns;
+    uint64_t max_ns;
+    uint64_t baldes[TR_BALDES];
+} MedidaTempo;
+
+static void medirTempo(MedidaTempo *m, uint64_t ns) {
+    int balde = 63 - __builtin_clzll(ns | 1);
+    if (balde >= TR_BALDES) balde = TR_BALDES - 1;
+    m->amostras++;
+    m->soma_ns += ns;
+    if (ns > m->max_ns) m->max_ns = ns;
+    m->baldes[balde]++;
 }
 
-int pilha_estaVazia(Pilha *p) {
-    return (p->topo == -1);
+/**
+ * @brief Limite superior (ns) do balde onde cai o percentil 'q' (no maximo o maior tempo medido).
+ */
+static uint64_t percentilTempo(const MedidaTempo *m, double q) {
+    uint64_t alvo = (uint64_t)(q * (double)m->amostras), acumulado = 0;
+    for (int b = 0; b < TR_BALDES; b++) {
+        acumulado += m->baldes[b];
+        if (acumulado > alvo) return (2ULL << b) < m->max_ns ? 2ULL << b : m->max_ns;
+    }
+    return 0;
 }
 
-int pilha_estaCheia(Pilha *p) {
-    return (p->topo == CAP_PILHA - 1);
+static double mediaMs(const MedidaTempo *m) {
+    return m->amostras ? (double)m->soma_ns / (double)m->amostras / 1e6 : 0.0;
 }
 
 /**
- * @brief Insere uma peca no topo da pilha (push).
+ * @brief Peca da origem: frente da fila (1) ou topo da reserva (3); NULL se vazia.
  */
-int push(Pilha *p, Peca peca) {
-    if (pilha_estaCheia(p)) {
-        return 0; // Falha: Pilha Cheia
-    }
-    
-    p->topo++;
-    p->elementos[p->topo] = peca;
-    return 1; // Sucesso
+static const Peca *pecaDaOrigem(const Fila *f, const Pilha *p, int origem) {
+    if (origem == 3) return pilha_estaVazia(p) ? NULL : &p->elementos[p->topo];
+    return fila_estaVazia(f) ? NULL : &f->elementos[f->cabeca & f->mascara];
 }
 
 /**
- * @brief Remove uma peca do topo da pilha (pop).
+ * @brief Poe no topo do tabuleiro a peca da origem atual (ou da fila, se a reserva
+ * esvaziou). Se ela nao cabe, e fim de jogo: o tabuleiro e esvaziado.
  */
-Peca pop(Pilha *p) {
-    Peca peca_removida = {' ', -1}; // Peca de erro
-    
-    if (pilha_estaVazia(p)) {
-        return peca_removida; // Falha: Pilha Vazia
+static void surgirPeca(const Fila *f, const Pilha *p) {
+    PecaCaindo *c = &peca_caindo;
+    Tabuleiro *t = tabuleiro_sessao;
+
+    if (c->origem != 3 || pilha_estaVazia(p)) c->origem = 1;
+    const Peca *peca = pecaDaOrigem(f, p, c->origem);
+    c->ativa = peca && tipoIndice(peca->nome) < GERADOR_NUM_TIPOS;
+    if (!c->ativa) return;
+
+    c->id = peca->id;
+    c->tipo = tipoIndice(peca->nome);
+    c->rotacao = 0;
+    c->coluna = tabuleiro_colunaEntrada(t, c->tipo, 0);
+    c->linha = t->altura - ALTURA_FORMA[c->tipo][0];
+    c->ticks_queda = c->ticks_apoiada = c->adiamentos = 0;
+    if (!tabuleiro_cabe(t, c->tipo, 0, c->coluna, c->linha)) {
+        fins_de_jogo++;
+        tabuleiro_limpar(t);
+        LOG_ACAO("💥 FIM DE JOGO: a peca [%c %lld] nao coube. Tabuleiro esvaziado.\n", peca->nome, (long long)peca->id);
     }
-    
-    peca_removida = p->elementos[p->topo];
-    p->topo--;
-    return peca_removida;
 }
 
-
-// --- 4. Funcoes de Acao Estrategica (Logica do Jogo) ---
+/**
+ * @brief Surge uma peca nova se uma acao trocou a peca da origem (reservar, trocar).
+ */
+static void sincronizarPeca(const Fila *f, const Pilha *p) {
+    const Peca *peca = pecaDaOrigem(f, p, peca_caindo.origem);
+    if (!peca_caindo.ativa || !peca || peca->id != peca_caindo.id) surgirPeca(f, p);
+}
 
 /**
- * @brief Joga a peca da frente da fila (dequeue).
+ * @brief Move e/ou gira a peca se a nova posicao cabe. Girar junto a parede direita
+ * puxa a peca para dentro. Um movimento da peca apoiada reinicia a trava (ate
+ * TR_MAX_ADIAMENTOS vezes).
+ * @return 1 se a peca mudou de posicao.
  */
-void jogarPecaAcao(Fila *f) {
-    Peca p = dequeue(f);
-    if (p.id != -1) {
-        printf("\n✅ ACAO: Peca [%c %d] foi JOGADA (removida da frente da fila).\n", p.nome, p.id);
-    } else {
-        printf("\n❌ ERRO: Nao e possivel jogar. Fila de pecas futuras esta vazia.\n");
+static int moverPeca(int colunas, int linhas, int giros) {
+    PecaCaindo *c = &peca_caindo;
+    const Tabuleiro *t = tabuleiro_sessao;
+    int rotacao = (c->rotacao + giros) % TABULEIRO_ROTACOES;
+    int coluna = c->coluna + colunas, linha = c->linha + linhas;
+
+    if (coluna + LARGURA_FORMA[c->tipo][rotacao] > t->largura) coluna = t->largura - LARGURA_FORMA[c->tipo][rotacao];
+    if (coluna < 0 || !tabuleiro_cabe(t, c->tipo, rotacao, coluna, linha)) return 0;
+    c->rotacao = rotacao;
+    c->coluna = coluna;
+    c->linha = linha;
+    if (c->ticks_apoiada > 0 && c->adiamentos < TR_MAX_ADIAMENTOS) {
+        c->ticks_apoiada = 0;
+        c->adiamentos++;
     }
+    return 1;
 }
 
 /**
- * @brief Move a peca da frente da fila para o topo da pilha (Reservar).
+ * @brief Fixa a peca onde ela esta, aplica a acao que a tira do jogo (jogar ou usar,
+ * com o reabastecimento da fila) e faz surgir a proxima.
  */
-void reservarPecaAcao(Fila *f, Pilha *p) {
-    if (pilha_estaCheia(p)) {
-        printf("\n❌ ERRO: A Pilha de Reserva esta CHEIA (%d/%d). Nao e possivel reservar.\n", CAP_PILHA, CAP_PILHA);
-        return;
+static void travarPeca(Fila *f, Pilha *p) {
+    PecaCaindo *c = &peca_caindo;
+    EventoAcao ev;
+
+    int eliminadas = tabuleiro_fixar(tabuleiro_sessao, c->tipo, c->rotacao, c->coluna, c->linha);
+    executarAcaoDiario(diario_sessao, c->origem, f, p, &ev);
+    relatarAcao(&ev, f, p);
+    if (eliminadas > 0) LOG_ACAO("🧱 %d linha(s) completa(s) eliminada(s).\n", eliminadas);
+    c->origem = 1;
+    surgirPeca(f, p);
+}
+
+/**
+ * @brief Um tick do jogo: gravidade e trava da peca apoiada.
+ * @return 1 se o estado mudou (o quadro precisa ser redesenhado).
+ */
+static int tickTempoReal(Fila *f, Pilha *p) {
+    PecaCaindo *c = &peca_caindo;
+
+    if (!c->ativa) {
+        surgirPeca(f, p);
+        return c->ativa;
     }
-    if (fila_estaVazia(f)) {
-        printf("\n❌ ERRO: A Fila de pecas esta VAZIA. Nao ha o que reservar.\n");
-        return;
+    if (tabuleiro_cabe(tabuleiro_sessao, c->tipo, c->rotacao, c->coluna, c->linha - 1)) {
+        c->ticks_apoiada = 0;
+        if (++c->ticks_queda < gravidade_ticks) return 0;
+        c->ticks_queda = 0;
+        c->linha--;
+        return 1;
     }
-    
-    // 1. Remove da frente da fila
-    Peca peca_fila = dequeue(f);
-    
-    // 2. Coloca no topo da pilha
-    if (push(p, peca_fila)) {
-        printf("\n✅ ACAO: Peca [%c %d] foi RESERVADA (movida da Fila para a Pilha).\n", peca_fila.nome, peca_fila.id);
-    } 
-    // OBS: O dequeue ja tenta reabastecer a fila automaticamente.
+    if (++c->ticks_apoiada < TR_TRAVA_TICKS) return 0;
+    travarPeca(f, p);
+    return 1;
 }
 
 /**
- * @brief Remove a peca do topo da pilha (Usar Pecas Reservadas).
+ * @brief Trata uma tecla.
+ * @return 0 se a tecla encerra o jogo.
  */
-void usarPecaReservadaAcao(Pilha *p, Fila *f) {
-    Peca peca_pilha = pop(p);
-    
-    if (peca_pilha.id != -1) {
-        printf("\n✅ ACAO: Peca [%c %d] foi USADA (removida do topo da Pilha).\n", peca_pilha.nome, peca_pilha.id);
-    } else {
-        printf("\n❌ ERRO: Nao e possivel usar. Pilha de reserva esta vazia.\n");
+static int teclaTempoReal(int tecla, Fila *f, Pilha *p) {
+    PecaCaindo *c = &peca_caindo;
+    EventoAcao ev;
+
+    switch (tecla) {
+        case 'q': case 'Q': case '0': case 3: // 3 = Ctrl-C em modo bruto
+            return 0;
+        case 'a': case TECLA_ESQUERDA:
+            if (c->ativa) moverPeca(-1, 0, 0);
+            break;
+        case 'd': case TECLA_DIREITA:
+            if (c->ativa) moverPeca(1, 0, 0);
+            break;
+        case 'w': case TECLA_CIMA:
+            if (c->ativa) moverPeca(0, 0, 1);
+            break;
+        case 's': case TECLA_BAIXO:
+            if (c->ativa && moverPeca(0, -1, 0)) c->ticks_queda = 0;
+            break;
+        case ' ': case '1': // Queda imediata
+            if (!c->ativa) break;
+            while (tabuleiro_cabe(tabuleiro_sessao, c->tipo, c->rotacao, c->coluna, c->linha - 1)) c->linha--;
+            travarPeca(f, p);
+            break;
+        case '3': // Alterna a peca que cai entre a frente da fila e o topo da reserva
+            if (c->origem == 3 || !pilha_estaVazia(p)) {
+                c->origem = 4 - c->origem;
+                surgirPeca(f, p);
+            } else {
+                tela_status(&tela, "[ALERTA] A reserva esta vazia.\n");
+            }
+            break;
+        case '2': case '4': case '5':
+            executarAcaoDiario(diario_sessao, tecla - '0', f, p, &ev);
+            relatarAcao(&ev, f, p);
+            sincronizarPeca(f, p);
+            break;
+        default:
+            break;
     }
+    return 1;
+}
+
+static void desenharTempoReal(Fila *f, Pilha *p, const MedidaTempo *latencia, const MedidaTempo *jitter) {
+    tela_iniciarQuadro(&tela);
+    exibirEstado(f, p);
+    tela_areaStatusRolante(&tela, LINHAS_STATUS);
+    tela_linha(&tela, "===================== TEMPO REAL =====================");
+    tela_linha(&tela, "Setas/WASD: mover, girar, descer | Espaco ou 1: soltar");
+    tela_linha(&tela, "2: reservar | 3: cair da fila/reserva | 4: trocar | 5: trocar 3 | Q: sair");
+    tela_linha(&tela, "Cai agora: %s | entrada->quadro %.2f ms (max %.2f) | jitter %.3f ms (max %.3f)",
+               peca_caindo.origem == 3 ? "reserva" : "fila", mediaMs(latencia), latencia->max_ns / 1e6,
+               mediaMs(jitter), jitter->max_ns / 1e6);
+    tela_desenhar(&tela);
+}
+
+static void imprimirMedida(const char *rotulo, const MedidaTempo *m) {
+    printf("  %s: amostras=%llu media=%.3fms p50<=%.3fms p99<=%.3fms max=%.3fms\n", rotulo,
+           (unsigned long long)m->amostras, mediaMs(m), percentilTempo(m, 0.50) / 1e6,
+           percentilTempo(m, 0.99) / 1e6, m->max_ns / 1e6);
 }
 
 /**
- * @brief Substitui a peca da frente da fila com o topo da pilha.
- * O elemento removido da fila vai para o topo da pilha.
+ * @brief Laco de eventos do modo em tempo real (ver o inicio da secao).
+ * Entre um tick e o proximo, espera por teclas com ppoll ate o horario do tick; os
+ * ticks atrasados sao executados em seguida, ate TR_MAX_ATRASO_TICKS por vez.
+ * @return 0 em caso de sucesso, 1 se o terminal nao pode ser configurado ou houve erro de leitura.
  */
-void trocarPecaUnicaAcao(Fila *f, Pilha *p) {
-    if (pilha_estaVazia(p)) {
-        printf("\n❌ ERRO: Pilha de reserva vazia. Nao ha o que trocar.\n");
-        return;
+int executarTempoReal(Fila *f, Pilha *p) {
+    Teclado teclado;
+    MedidaTempo latencia = {0}, jitter = {0};
+    uint64_t ticks = 0, quadros = 0, teclas = 0, realinhamentos = 0;
+    int status = 0, rodando = 1;
+
+    fflush(stdout); // O que ja foi impresso com printf vem antes do primeiro quadro
+    if (!teclado_iniciar(&teclado, STDIN_FILENO)) {
+        perror("tcsetattr");
+        return 1;
     }
-    if (fila_estaVazia(f)) {
-         printf("\n❌ ERRO: Fila de pecas vazia. Nao ha o que trocar.\n");
-        return;
-    }
-    
-    // 1. Pega a peca da frente da fila, mas NAO a remove (peek simplificado)
-    Peca peca_fila_frente = f->elementos[f->inicio];
-    
-    // 2. Remove a peca do topo da pilha (pop)
-    Peca peca_pilha_topo = pop(p);
-    
-    // 3. Coloca a peca do topo da pilha na frente da fila
-    f->elementos[f->inicio] = peca_pilha_topo;
-    
-    // 4. Coloca a peca que estava na frente da fila no topo da pilha (push)
-    if (push(p, peca_fila_frente)) {
-        printf("\n✅ ACAO: TROCA UNICA realizada.\n");
-        printf("  - Fila (frente): [%c %d] -> [%c %d]\n", peca_fila_frente.nome, peca_fila_frente.id, peca_pilha_topo.nome, peca_pilha_topo.id);
-        printf("  - Pilha (topo): [%c %d] -> [%c %d]\n", peca_pilha_topo.nome, peca_pilha_topo.id, peca_fila_frente.nome, peca_fila_frente.id);
-    } else {
-        // Isso nao deveria acontecer se a pilha nao estava vazia, mas e um bom guardrail
-        printf("\n❌ ERRO: Falha no re-push apos a troca. Estado das estruturas pode estar comprometido.\n");
+    surgirPeca(f, p);
+    desenharTempoReal(f, p, &latencia, &jitter);
+    quadros++;
+
+    uint64_t proximo_tick = relogio_ns() + TR_TICK_NS;
+    while (rodando) {
+        uint64_t agora = relogio_ns();
+        uint64_t espera = proximo_tick > agora ? proximo_tick - agora : 0;
+        struct timespec limite = {(time_t)(espera / 1000000000ULL), (long)(espera % 1000000000ULL)};
+        struct pollfd pfd = {.fd = STDIN_FILENO, .events = POLLIN};
+        uint64_t entrada = 0; // Chegada das teclas que o proximo quadro vai mostrar
+        int mudou = 0;
+
+        int prontos = ppoll(&pfd, 1, &limite, NULL);
+        if (prontos < 0 && errno != EINTR) {
+            perror("ppoll");
+            status = 1;
+            break;
+        }
+        if (prontos > 0) {
+            entrada = relogio_ns();
+            int lidos = teclado_ler(&teclado);
+            if (lidos <= 0) { // Fim da entrada ou erro
+                if (lidos < 0) status = 1;
+                rodando = 0;
+            }
+        }
+        int tecla; // Tambem sem entrada nova: um ESC incompleto pode ter expirado
+        while (rodando && (tecla = teclado_proxima(&teclado)) >= 0) {
+            teclas++;
+            rodando = teclaTempoReal(tecla, f, p);
+            mudou = 1;
+        }
+
+        agora = relogio_ns();
+        for (int executados = 0; rodando && agora >= proximo_tick; executados++) {
+            if (executados == TR_MAX_ATRASO_TICKS) { // Muito atrasado: descarta os ticks perdidos
+                proximo_tick = agora + TR_TICK_NS;
+                realinhamentos++;
+                break;
+            }
+            medirTempo(&jitter, agora - proximo_tick);
+            mudou |= tickTempoReal(f, p);
+            ticks++;
+            proximo_tick += TR_TICK_NS;
+        }
+
+        if (rodando && mudou) {
+            desenharTempoReal(f, p, &latencia, &jitter);
+            quadros++;
+            if (entrada) medirTempo(&latencia, relogio_ns() - entrada);
+        }
     }
+    teclado_restaurar(&teclado);
+    peca_caindo.ativa = 0;
+
+    printf("\n👋 Gerenciador de Pecas Encerrado. Bom jogo!\n");
+    printf("tempo real: ticks=%llu quadros=%llu teclas=%llu realinhamentos=%llu\n", (unsigned long long)ticks,
+           (unsigned long long)quadros, (unsigned long long)teclas, (unsigned long long)realinhamentos);
+    imprimirMedida("entrada->quadro", &latencia);
+    imprimirMedida("jitter do tick ", &jitter);
+    return status;
 }
 
+
+// --- Funcao Principal ---
+
 /**
- * @brief Alterna as 3 primeiras pecas da fila com as 3 pecas da pilha.
+ * @brief Uso: mestre [--fila N] [--pilha N] [--pilha-cresce] [--semente S] [--saco7] [--produtor]
+ *                    [--nivel N | --silencioso] [--diario arq] [--carregar arq] [--salvar arq]
+ *                    [--estatisticas arq] [--tabuleiro [LxA]] [--tempo-real] [--gravidade MS]
+ *                    [--lote [arquivo]]
+ *   --fila N         capacidade da fila de pecas futuras (padrao CAP_FILA)
+ *   --pilha N        capacidade da pilha de reserva (padrao CAP_PILHA)
+ *   --pilha-cresce   a pilha dobra de capacidade quando enche, em vez de recusar a reserva
+ *   --semente S      semente do gerador de pecas (padrao: relogio e PID)
+ *   --saco7          sorteia as pecas em sacos de 7 (todos os tipos a cada 7 pecas)
+ *   --produtor       gera as pecas em uma thread separada (anel SPSC)
+ *   --nivel N        mensagens no menu: 0 nenhuma, 1 acoes, 2 acoes e reabastecimento (padrao)
+ *   --silencioso     o mesmo que --nivel 0
+ *   --diario arq     grava todas as acoes no diario binario 'arq' (ver reproduzir.c)
+ *   --carregar arq   continua a partir do estado salvo em 'arq' (ignora --fila/--pilha/--semente/--saco7)
+ *   --salvar arq     grava o estado final em 'arq' ao sair
+ *   --estatisticas arq  grava contadores e latencias das acoes em 'arq' (texto, ou JSON
+ *                    se terminar em .json) ao sair e a cada SIGUSR1
+ *   --tabuleiro [LxA] coloca as pecas jogadas e usadas em um tabuleiro de L colunas e A linhas
+ *                    (padrao 10x20), eliminando as linhas completas
+ *   --tempo-real     jogo em tempo real no tabuleiro: teclas sem Enter, gravidade e trava por
+ *                    ticks (liga --tabuleiro); ao sair mostra a latencia entrada->quadro e o jitter
+ *   --gravidade MS   tempo de queda de uma linha no modo em tempo real (padrao 500)
+ *   --lote [arquivo] aplica as acoes do arquivo (ou de stdin se omitido/"-") sem menu
  */
-void trocarPecasMultiplaAcao(Fila *f, Pilha *p) {
-    const int NUM_TROCA = 3;
-    
-    if (f->tamanho_atual < NUM_TROCA) {
-        printf("\n❌ ERRO: A Fila deve ter pelo menos %d pecas. (Atual: %d)\n", NUM_TROCA, f->tamanho_atual);
-        return;
+int main(int argc, char *argv[]) {
+    static ProdutorPecas produtor;
+    static Diario diario;
+    static Tabuleiro tabuleiro;
+    Fila fila_pecas;
+    Pilha pilha_reserva;
+    uint32_t limite_fila = CAP_FILA;
+    int capacidade_pilha = CAP_PILHA;
+    int pilha_cresce = 0;
+    int usar_produtor = 0;
+    ModoGerador modo_gerador = GERADOR_UNIFORME;
+    const char *arquivo_lote = NULL;
+    const char *arquivo_diario = NULL;
+    const char *arquivo_carregar = NULL;
+    const char *arquivo_salvar = NULL;
+    const char *arquivo_estatisticas = NULL;
+    int modo_lote = 0;
+    int usar_tabuleiro = 0;
+    int tempo_real = 0;
+    int largura_tabuleiro = TABULEIRO_LARGURA, altura_tabuleiro = TABULEIRO_ALTURA;
+    uint64_t semente = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--lote") == 0) {
+            modo_lote = 1;
+            nivel_saida = SAIDA_SILENCIOSA;
+            if (i + 1 < argc && (argv[i + 1][0] != '-' || strcmp(argv[i + 1], "-") == 0)) {
+                arquivo_lote = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--fila") == 0 && i + 1 < argc) {
+            limite_fila = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--pilha") == 0 && i + 1 < argc) {
+            capacidade_pilha = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pilha-cresce") == 0) {
+            pilha_cresce = 1;
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--saco7") == 0) {
+            modo_gerador = GERADOR_SACO7;
+        } else if (strcmp(argv[i], "--produtor") == 0) {
+            usar_produtor = 1;
+        } else if (strcmp(argv[i], "--nivel") == 0 && i + 1 < argc) {
+            nivel_saida = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--silencioso") == 0) {
+            nivel_saida = SAIDA_SILENCIOSA;
+        } else if (strcmp(argv[i], "--diario") == 0 && i + 1 < argc) {
+            arquivo_diario = argv[++i];
+        } else if (strcmp(argv[i], "--carregar") == 0 && i + 1 < argc) {
+            arquivo_carregar = argv[++i];
+        } else if (strcmp(argv[i], "--salvar") == 0 && i + 1 < argc) {
+            arquivo_salvar = argv[++i];
+        } else if (strcmp(argv[i], "--estatisticas") == 0 && i + 1 < argc) {
+            arquivo_estatisticas = argv[++i];
+        } else if (strcmp(argv[i], "--tabuleiro") == 0) {
+            usar_tabuleiro = 1;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                if (sscanf(argv[++i], "%dx%d", &largura_tabuleiro, &altura_tabuleiro) != 2) {
+                    fprintf(stderr, "Tamanho de tabuleiro invalido: %s (ex.: 10x20)\n", argv[i]);
+                    return 1;
+                }
+            }
+        } else if (strcmp(argv[i], "--tempo-real") == 0) {
+            tempo_real = 1;
+            usar_tabuleiro = 1;
+        } else if (strcmp(argv[i], "--gravidade") == 0 && i + 1 < argc) {
+            gravidade_ticks = atoi(argv[++i]) * TR_TICKS_POR_SEGUNDO / 1000;
+            if (gravidade_ticks < 1) gravidade_ticks = 1;
+        } else {
+            fprintf(stderr, "Uso: %s [--fila N] [--pilha N] [--pilha-cresce] [--semente S] [--saco7] [--produtor]\n"
+                            "          [--nivel N | --silencioso] [--diario arq] [--carregar arq] [--salvar arq]\n"
+                            "          [--estatisticas arq] [--tabuleiro [LxA]] [--tempo-real] [--gravidade MS]\n"
+                            "          [--lote [arquivo]]\n", argv[0]);
+            return 1;
+        }
     }
-    if (p->topo + 1 < NUM_TROCA) {
-        printf("\n❌ ERRO: A Pilha deve ter pelo menos %d pecas. (Atual: %d)\n", NUM_TROCA, p->topo + 1);
-        return;
+    // O diario so sabe reproduzir a partir da semente; o anel do produtor guarda pecas
+    // que ja sairam do gerador e nao entrariam no estado salvo
+    if (arquivo_carregar && arquivo_diario) {
+        fprintf(stderr, "--diario nao pode ser usado junto com --carregar.\n");
+        return 1;
+    }
+    if (arquivo_salvar && usar_produtor) {
+        fprintf(stderr, "--salvar nao pode ser usado junto com --produtor.\n");
+        return 1;
+    }
+    if (tempo_real && modo_lote) {
+        fprintf(stderr, "--tempo-real nao pode ser usado junto com --lote.\n");
+        return 1;
     }
 
-    Peca temp_pilha[NUM_TROCA];
-    Peca temp_fila[NUM_TROCA];
-    
-    printf("\n>>> 5. TROCA MULTIPLA INICIADA (3x3) <<<\n");
-
-    // 1. Guarda as pecas da pilha (pop) e da fila
-    for (int i = 0; i < NUM_TROCA; i++) {
-        // Guarda as pecas da fila (indices da fila circular)
-        int idx_fila = (f->inicio + i) % CAP_FILA;
-        temp_fila[i] = f->elementos[idx_fila];
-        
-        // Guarda as pecas da pilha (pop)
-        temp_pilha[NUM_TROCA - 1 - i] = pop(p); // Inverte a ordem para manter a pilha correta
+    if (usar_tabuleiro) {
+        if (!tabuleiro_inicializar(&tabuleiro, largura_tabuleiro, altura_tabuleiro)) {
+            fprintf(stderr, "Tabuleiro invalido: %dx%d (largura %d-%d, altura %d-%d)\n", largura_tabuleiro,
+                    altura_tabuleiro, TABULEIRO_MIN_LARGURA, TABULEIRO_MAX_LARGURA, TABULEIRO_MIN_ALTURA,
+                    TABULEIRO_MAX_ALTURA);
+            return 1;
+        }
+        tabuleiro_sessao = &tabuleiro;
     }
 
-    // 2. Coloca as peças da pilha (guardadas) na frente da fila
-    for (int i = 0; i < NUM_TROCA; i++) {
-        int idx_fila = (f->inicio + i) % CAP_FILA;
-        f->elementos[idx_fila] = temp_pilha[i];
+    if (arquivo_estatisticas && !iniciarEstatisticas(arquivo_estatisticas)) {
+        arquivo_estatisticas = NULL;
     }
 
-    // 3. Coloca as peças da fila (guardadas) na pilha (push)
-    for (int i = 0; i < NUM_TROCA; i++) {
-        push(p, temp_fila[i]);
+    if (arquivo_carregar) {
+        if (!carregarEstado(arquivo_carregar, &fila_pecas, &pilha_reserva)) return 1;
+        limite_fila = fila_pecas.limite;
+    } else {
+        if (!criarFila(&fila_pecas, limite_fila)) {
+            fprintf(stderr, "Capacidade de fila invalida: %u\n", limite_fila);
+            return 1;
+        }
+        if (!criarPilha(&pilha_reserva, arena_daThread(), capacidade_pilha, pilha_cresce)) {
+            fprintf(stderr, "Capacidade de pilha invalida: %d\n", capacidade_pilha);
+            destruirFila(&fila_pecas);
+            return 1;
+        }
+        inicializarFonte(&fonte_padrao, semente, modo_gerador);
     }
 
-    printf("✅ ACAO: Troca em BLOCO (3 pecas) realizada com sucesso.\n");
-}
+    if (arquivo_diario) {
+        if (!abrirDiario(&diario, arquivo_diario, semente, modo_gerador, limite_fila, &pilha_reserva)) {
+            destruirFila(&fila_pecas);
+            return 1;
+        }
+        diario_sessao = &diario;
+    }
 
+    if (usar_produtor) {
+        if (!iniciarProdutor(&produtor, &fonte_padrao)) {
+            fprintf(stderr, "Nao foi possivel iniciar a thread produtora.\n");
+            destruirFila(&fila_pecas);
+            return 1;
+        }
+    }
 
-// --- 5. Menu Principal ---
+    // 1. Inicializar a fila de pecas com um numero fixo de elementos (limite da fila)
+    // (um estado carregado ja traz a fila exatamente como foi salva)
+    if (!arquivo_carregar) {
+        if (!modo_lote) printf("Iniciando Gerenciador de Pecas: Preenchendo Fila Inicial...\n");
+        preencherFila(&fila_pecas);
+    }
 
-void menuPrincipal(Fila *f, Pilha *p) {
-    int escolha;
-    
-    do {
-        exibirEstado(f, p);
-
-        printf("\n================ OPCOES ESTRATEGICAS ================\n");
-        printf("Codigo | Acao\n");
-        printf("---------------------------------------------------\n");
-        printf("  1    | Jogar peca da fila (Dequeue e Reabastecer)\n");
-        printf("  2    | Reservar peca (Fila -> Pilha)\n");
-        printf("  3    | Usar peca reservada (Pop Pilha)\n");
-        printf("  4    | Trocar peca atual (Frente Fila <-> Topo Pilha)\n");
-        printf("  5    | Trocar 3 pecas (3 Fila <-> 3 Pilha)\n");
-        printf("  0    | Sair do Programa\n");
-        printf("===================================================\n");
-        printf("Escolha o Codigo da Acao: ");
-        
-        if (scanf("%d", &escolha) != 1) {
-            printf("\n[ERRO] Entrada invalida. Por favor, digite um numero.\n");
-            while (getchar() != '\n'); 
-            continue;
+    int status = 0;
+    if (modo_lote) {
+        int fd = STDIN_FILENO;
+        if (arquivo_lote && strcmp(arquivo_lote, "-") != 0) {
+            fd = open(arquivo_lote, O_RDONLY);
+            if (fd < 0) {
+                perror(arquivo_lote);
+                destruirFila(&fila_pecas);
+                return 1;
+            }
         }
-
-        switch (escolha) {
-            case 1: jogarPecaAcao(f); break;
-            case 2: reservarPecaAcao(f, p); break;
-            case 3: usarPecaReservadaAcao(p, f); break;
-            case 4: trocarPecaUnicaAcao(f, p); break;
-            case 5: trocarPecasMultiplaAcao(f, p); break;
-            case 0: printf("\n👋 Gerenciador de Pecas Encerrado. Bom jogo!\n"); break;
-            default: printf("\n[ALERTA] Opcao invalida. Tente novamente.\n"); break;
+        status = executarLote(fd, &fila_pecas, &pilha_reserva);
+        if (fd != STDIN_FILENO) close(fd);
+        if (tabuleiro_sessao) {
+            printf("tabuleiro=%dx%d pecas=%llu linhas=%llu fins=%lld\n", tabuleiro.largura, tabuleiro.altura,
+                   (unsigned long long)tabuleiro.pecas, (unsigned long long)tabuleiro.eliminadas, fins_de_jogo);
+        }
+    } else {
+        tela_inicializar(&tela, STDOUT_FILENO);
+        // As dicas da tela consultam o indice de tipos; o modo em lote nao paga por ele
+        if (!indexarFila(&fila_pecas) || !indexarPilha(&pilha_reserva)) {
+            desindexarFila(&fila_pecas);
+        }
+        // Desfazer nao volta o diario, o tabuleiro nem as pecas que ja sairam do anel do produtor
+        static Historico historico;
+        if (!diario_sessao && !tabuleiro_sessao && !fonte_padrao.produtor && !tempo_real &&
+            historico_criar(&historico, HISTORICO_ACOES)) {
+            historico_sessao = &historico;
+        }
+        if (arquivo_carregar) {
+            tela_status(&tela, "Estado carregado de %s (semente %llu).\n", arquivo_carregar,
+                        (unsigned long long)fonte_padrao.semente);
+        } else {
+            tela_status(&tela, "Fila inicial preenchida com %u pecas (semente %llu).\n", fila_pecas.limite,
+                        (unsigned long long)fonte_padrao.semente);
         }
-        
-    } while (escolha != 0);
-}
-
-// --- Funcao Principal ---
 
-int main() {
-    Fila fila_pecas;
-    Pilha pilha_reserva;
+        // Inicia o menu de acoes (ou o laco de eventos do modo em tempo real)
+        if (tempo_real) {
+            status = executarTempoReal(&fila_pecas, &pilha_reserva);
+        } else {
+            menuPrincipal(&fila_pecas, &pilha_reserva);
+        }
+    }
 
-    inicializarFila(&fila_pecas);
-    inicializarPilha(&pilha_reserva);
+    if (diario_sessao) {
+        if (!fecharDiario(diario_sessao, &fila_pecas, &pilha_reserva)) status = 1;
+        diario_sessao = NULL;
+    }
+    if (arquivo_estatisticas && !escreverEstatisticas(arquivo_estatisticas)) status = 1;
+    if (arquivo_salvar && !salvarEstado(arquivo_salvar, &fila_pecas, &pilha_reserva)) {
+        fprintf(stderr, "Nao foi possivel salvar o estado em %s.\n", arquivo_salvar);
+        status = 1;
+    }
 
-    // 1. Inicializar a fila de pecas com um numero fixo de elementos (CAP_FILA)
-    printf("Iniciando Gerenciador de Pecas: Preenchendo Fila Inicial...\n");
-    while (!fila_estaCheia(&fila_pecas)) {
-        Peca p = gerarPeca();
-        enqueue(&fila_pecas, p);
+    if (fonte_padrao.produtor) {
+        pararProdutor(fonte_padrao.produtor);
+        printf("produtor: pecas=%llu anel_vazio=%llu (%.4f%%)\n",
+               (unsigned long long)produtor.leituras, (unsigned long long)produtor.vazias,
+               produtor.leituras ? 100.0 * (double)produtor.vazias / (double)produtor.leituras : 0.0);
     }
-    printf("Fila inicial preenchida com %d pecas.\n", CAP_FILA);
-    
-    // Inicia o menu de acoes
-    menuPrincipal(&fila_pecas, &pilha_reserva);
 
-    return 0;
-}
\ No newline at end of file
+    if (historico_sessao) {
+        historico_destruir(historico_sessao);
+        historico_sessao = NULL;
+    }
+    destruirFila(&fila_pecas);
+    desindexarPilha(&pilha_reserva);
+    arena_liberar(arena_daThread());
+    return status;
+}
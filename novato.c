@@ -2,136 +2,55 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 
-// Definicao da capacidade maxima da fila de pecas futuras
-#define CAPACIDADE_MAXIMA 5
-
-// Variavel global para o ID unico das pecas
-int proximo_id = 0;
-
-// --- Estruturas de Dados ---
+#include "pecas.h"
+#include "entrada.h"
 
-// Atributos das pecas: nome (tipo) e id
-typedef struct {
-    char nome; // Tipo da peca: 'I', 'O', 'T', 'L', 'J', 'S', 'Z'
-    int id;    // Identificador unico
-} Peca;
+// Definicao da capacidade maxima da fila de pecas futuras
+#define CAPACIDADE_MAXIMA CAP_FILA
 
-// Estrutura para a Fila Estatica (Circular/Linear Simplificada)
-typedef struct {
-    Peca elementos[CAPACIDADE_MAXIMA]; // Array para armazenar as pecas
-    int inicio;                        // Indice da primeira peca (saida/dequeue)
-    int fim;                           // Indice da ultima peca (entrada/enqueue)
-    int tamanho_atual;                 // Numero atual de elementos na fila
-} Fila;
+// Neste nivel a fila nao se reabastece: o jogador insere pecas novas (ENQUEUE)
+// e joga as da frente (DEQUEUE). Fila e pecas vem do nucleo (pecas.h).
 
 // --- Prototipos de Funcoes ---
-void inicializarFila(Fila *f);
-Peca gerarPeca();
 void exibirFila(Fila *f);
-int estaVazia(Fila *f);
-int estaCheia(Fila *f);
-int enqueue(Fila *f, Peca p);
-Peca dequeue(Fila *f);
+int inserirPeca(Fila *f, Peca p);
+Peca jogarPeca(Fila *f);
 void menuAcoes(Fila *fila_pecas);
 
 // --- Implementacao das Funcoes ---
 
 /**
- * @brief Inicializa a fila definindo inicio, fim e tamanho_atual para zero.
- * @param f Ponteiro para a estrutura Fila.
- */
-void inicializarFila(Fila *f) {
-    f->inicio = 0;
-    f->fim = -1; // -1 indica que a fila esta vazia e o proximo item entra no indice 0
-    f->tamanho_atual = 0;
-}
-
-/**
- * @brief Gera uma nova peca com um tipo aleatorio e um ID unico.
- * @return Retorna a estrutura Peca gerada.
- */
-Peca gerarPeca() {
-    Peca nova_peca;
-    char tipos[] = {'I', 'O', 'T', 'L', 'J', 'S', 'Z'};
-    int num_tipos = sizeof(tipos) / sizeof(tipos[0]);
-    
-    // Escolhe um tipo aleatorio
-    nova_peca.nome = tipos[rand() % num_tipos];
-    
-    // Atribui o ID unico e incrementa o contador global
-    nova_peca.id = proximo_id++;
-    
-    return nova_peca;
-}
-
-/**
- * @brief Verifica se a fila esta vazia.
- * @param f Ponteiro para a estrutura Fila.
- * @return 1 se vazia, 0 caso contrario.
- */
-int estaVazia(Fila *f) {
-    return (f->tamanho_atual == 0);
-}
-
-/**
- * @brief Verifica se a fila esta cheia.
- * @param f Ponteiro para a estrutura Fila.
- * @return 1 se cheia, 0 caso contrario.
- */
-int estaCheia(Fila *f) {
-    return (f->tamanho_atual == CAPACIDADE_MAXIMA);
-}
-
-/**
- * @brief Insere uma nova peca no final da fila (enqueue).
- * A logica de fila linear (nao-circular) e simplificada para fins didaticos.
+ * @brief Insere uma nova peca no final da fila (enqueue) e informa o resultado.
  * @param f Ponteiro para a estrutura Fila.
  * @param p A peca a ser inserida.
  * @return 1 se a insercao for bem-sucedida, 0 caso a fila esteja cheia.
  */
-int enqueue(Fila *f, Peca p) {
-    if (estaCheia(f)) {
-        printf("\n❌ ERRO: A fila de pecas futuras esta cheia (%d/%d). Nao e possivel inserir.\n", f->tamanho_atual, CAPACIDADE_MAXIMA);
+int inserirPeca(Fila *f, Peca p) {
+    if (!enqueue(f, p)) {
+        printf("\n❌ ERRO: A fila de pecas futuras esta cheia (%u/%d). Nao e possivel inserir.\n", fila_tamanho(f), CAPACIDADE_MAXIMA);
         return 0;
     }
-    
-    // Como a fila e linear, o novo elemento sempre entra na proxima posicao apos o ultimo elemento (fim)
-    f->fim++;
-    f->elementos[f->fim] = p;
-    f->tamanho_atual++;
-    
-    printf("\n✅ Inserido (ENQUEUE): Peca [%c %d] adicionada ao FINAL da fila.\n", p.nome, p.id);
+
+    printf("\n✅ Inserido (ENQUEUE): Peca [%c %lld] adicionada ao FINAL da fila.\n", p.nome, (long long)p.id);
     return 1;
 }
 
 /**
- * @brief Remove a peca da frente da fila (dequeue).
- * Implementa um shift simples de todos os elementos apos a remocao.
+ * @brief Remove a peca da frente da fila (dequeue, sem reabastecer) e informa o resultado.
  * @param f Ponteiro para a estrutura Fila.
- * @return A peca removida. Retorna uma peca vazia se a fila estiver vazia.
+ * @return A peca removida. Retorna uma peca com id -1 se a fila estiver vazia.
  */
-Peca dequeue(Fila *f) {
-    Peca peca_removida = {' ', -1}; // Inicializa peca vazia para retorno de erro
-    
-    if (estaVazia(f)) {
+Peca jogarPeca(Fila *f) {
+    Peca peca_removida = dequeueSimples(f);
+
+    if (peca_removida.id == -1) {
         printf("\n❌ ERRO: A fila de pecas futuras esta vazia. Nao ha pecas para 'jogar'.\n");
         return peca_removida;
     }
-    
-    // 1. Pega a peca do inicio (indice 'inicio')
-    peca_removida = f->elementos[f->inicio];
-    
-    // 2. Desloca todos os elementos uma posicao para a frente (simulando a remocao do inicio)
-    for (int i = f->inicio; i < f->fim; i++) {
-        f->elementos[i] = f->elementos[i + 1];
-    }
-    
-    // 3. Ajusta os ponteiros e o tamanho
-    f->fim--; // O ultimo elemento valido agora e a posicao anterior
-    f->tamanho_atual--;
-    
-    printf("\n✅ Removido (DEQUEUE): Peca [%c %d] foi 'jogada' (removida do INICIO).\n", peca_removida.nome, peca_removida.id);
+
+    printf("\n✅ Removido (DEQUEUE): Peca [%c %lld] foi 'jogada' (removida do INICIO).\n", peca_removida.nome, (long long)peca_removida.id);
     return peca_removida;
 }
 
@@ -141,28 +60,32 @@ Peca dequeue(Fila *f) {
  */
 void exibirFila(Fila *f) {
     printf("\n--- 🧩 FILA DE PECAS FUTURAS (Capacidade: %d) 🧩 ---\n", CAPACIDADE_MAXIMA);
-    
-    if (estaVazia(f)) {
+
+    if (fila_estaVazia(f)) {
         printf(">>> FILA VAZIA <<<\n");
         printf("Tamanho atual: 0\n");
         return;
     }
 
     // Exibe o formato 'Tetris Stack'
+    uint32_t tamanho = fila_tamanho(f);
+    Peca *inicio = &f->elementos[f->cabeca & f->mascara];
+    Peca *fim = &f->elementos[(f->cauda - 1) & f->mascara];
     printf("Fila de Pecas: ");
-    for (int i = f->inicio; i <= f->fim; i++) {
+    for (uint32_t i = 0; i < tamanho; i++) {
         // [T 0]
-        printf("[%c %d]", f->elementos[i].nome, f->elementos[i].id);
-        if (i < f->fim) {
+        Peca *p = &f->elementos[(f->cabeca + i) & f->mascara];
+        printf("[%c %lld]", p->nome, (long long)p->id);
+        if (i < tamanho - 1) {
             printf(" -> ");
         }
     }
     printf("\n");
-    
+
     // Exibe a informacao de estado da fila
-    printf("Tamanho atual: %d\n", f->tamanho_atual);
-    printf("Proxima a sair (INICIO): [%c %d]\n", f->elementos[f->inicio].nome, f->elementos[f->inicio].id);
-    printf("Ultima a entrar (FIM): [%c %d]\n", f->elementos[f->fim].nome, f->elementos[f->fim].id);
+    printf("Tamanho atual: %u\n", tamanho);
+    printf("Proxima a sair (INICIO): [%c %lld]\n", inicio->nome, (long long)inicio->id);
+    printf("Ultima a entrar (FIM): [%c %lld]\n", fim->nome, (long long)fim->id);
     printf("------------------------------------------------------\n");
 }
 
@@ -170,12 +93,16 @@ void exibirFila(Fila *f) {
 // --- Funcao Principal e Menu ---
 
 /**
- * @brief Gerencia o menu de acoes e o fluxo do programa.
+ * @brief Gerencia o menu de acoes e o fluxo do programa. Os codigos chegam em lotes
+ * (entrada.h): todos os que ja foram digitados sao aplicados antes de o menu voltar.
  * @param fila_pecas Ponteiro para a fila principal.
  */
 void menuAcoes(Fila *fila_pecas) {
-    int escolha;
-    
+    static LeitorEntrada leitor;
+    ComandoEntrada lote[ENTRADA_MAX_LOTE];
+    int escolha = -1;
+
+    entrada_iniciar(&leitor, STDIN_FILENO);
     do {
         // Exibe o estado atual da fila
         exibirFila(fila_pecas);
@@ -188,38 +115,38 @@ void menuAcoes(Fila *fila_pecas) {
         printf("  0    | Sair\n");
         printf("=======================================================\n");
         printf("Escolha o Codigo da Acao: ");
-        
-        if (scanf("%d", &escolha) != 1) {
-            printf("\n[ERRO] Entrada invalida. Por favor, digite um numero.\n");
-            // Limpa o buffer de entrada
-            while (getchar() != '\n'); 
-            continue;
+        fflush(stdout); // A entrada e lida com read(), fora do stdio
+
+        int n = entrada_lerComandos(&leitor, lote, ENTRADA_MAX_LOTE);
+        if (n <= 0) break; // Fim da entrada
+
+        for (int i = 0; i < n && escolha != 0; i++) {
+            if (!lote[i].valido) {
+                printf("\n[ERRO] Entrada invalida. Por favor, digite um numero.\n");
+                continue;
+            }
+            escolha = lote[i].codigo;
+            switch (escolha) {
+                case 1:
+                    // DEQUEUE: Jogar a peça
+                    jogarPeca(fila_pecas);
+                    break;
+
+                case 2:
+                    // ENQUEUE: Inserir nova peça
+                    inserirPeca(fila_pecas, gerarPeca());
+                    break;
+
+                case 0:
+                    printf("\n👋 Jogo Tetris Stack Encerrado. Ate a proxima rodada!\n");
+                    break;
+
+                default:
+                    printf("\n[ALERTA] Opcao invalida. Tente novamente.\n");
+                    break;
+            }
         }
 
-        Peca peca_removida;
-        Peca nova_peca;
-
-        switch (escolha) {
-            case 1:
-                // DEQUEUE: Jogar a peça
-                peca_removida = dequeue(fila_pecas);
-                break;
-                
-            case 2:
-                // ENQUEUE: Inserir nova peça
-                nova_peca = gerarPeca();
-                enqueue(fila_pecas, nova_peca);
-                break;
-                
-            case 0:
-                printf("\n👋 Jogo Tetris Stack Encerrado. Ate a proxima rodada!\n");
-                break;
-                
-            default:
-                printf("\n[ALERTA] Opcao invalida. Tente novamente.\n");
-                break;
-        }
-        
     } while (escolha != 0);
 }
 
@@ -228,25 +155,26 @@ void menuAcoes(Fila *fila_pecas) {
  */
 int main() {
     // Inicializa o gerador de numeros aleatorios para as pecas
-    srand(time(NULL));
+    inicializarFonte(&fonte_padrao, (uint64_t)time(NULL), GERADOR_UNIFORME);
 
     // Inicializa a fila de pecas
     Fila fila_pecas;
-    inicializarFila(&fila_pecas);
+    if (!criarFila(&fila_pecas, CAPACIDADE_MAXIMA)) {
+        fprintf(stderr, "Sem memoria para a fila.\n");
+        return 1;
+    }
 
     // 1. Inicializar a fila de pecas com um numero fixo de elementos (Ex: 5)
     // Preenche a fila inicial
     printf("Iniciando Tetris Stack: Preenchendo Fila Inicial (Capacidade %d)\n", CAPACIDADE_MAXIMA);
-    while (!estaCheia(&fila_pecas)) {
-        Peca p = gerarPeca();
-        // Apenas insere sem exibir a mensagem de sucesso no inicio
-        fputs("", stdout); // Truque para evitar aviso de retorno nao-usado de enqueue
-        enqueue(&fila_pecas, p);
+    while (!fila_estaCheia(&fila_pecas)) {
+        inserirPeca(&fila_pecas, gerarPeca());
     }
     printf("\nFila inicial preenchida. Prepare-se para jogar!\n");
-    
+
     // Inicia o menu de acoes
     menuAcoes(&fila_pecas);
 
+    destruirFila(&fila_pecas);
     return 0;
-}
\ No newline at end of file
+}
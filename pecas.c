@@ -0,0 +1,657 @@
+// Nucleo de gerenciamento de pecas (ver pecas.h): fonte de pecas, criacao da fila,
+// reabastecimento e acoes estrategicas. Nenhuma funcao daqui imprime: o resultado
+// volta como ResultadoAcao e os detalhes em um EventoAcao.
+
+#include <stdlib.h>
+
+#include "pecas.h"
+#include "arena.h"
+#include "produtor.h"
+#include "estatisticas.h"
+
+// Fonte de pecas do programa; cada programa a inicializa em main()
+FontePecas fonte_padrao;
+
+
+// --- 1. Funcoes de Utilitario ---
+
+/**
+ * @brief Prepara uma fonte de pecas com IDs proprios a partir de 0.
+ */
+void inicializarFonte(FontePecas *fonte, uint64_t semente, ModoGerador modo) {
+    gerador_inicializar(&fonte->gerador, semente, modo);
+    fonte->proximo_id = 0;
+    fonte->fim_bloco = INT64_MAX;
+    fonte->alocador = NULL;
+    fonte->semente = semente;
+    fonte->produtor = NULL;
+}
+
+/**
+ * @brief Prepara um alocador compartilhado cujo primeiro ID e 'primeiro'.
+ */
+void inicializarAlocadorIds(AlocadorIds *a, int64_t primeiro) {
+    atomic_init(&a->proximo, primeiro);
+}
+
+/**
+ * @brief Passa a tirar os IDs da fonte do alocador compartilhado; o primeiro bloco e
+ * reservado na proxima peca gerada.
+ */
+void usarAlocadorIds(FontePecas *fonte, AlocadorIds *a) {
+    fonte->alocador = a;
+    fonte->fim_bloco = fonte->proximo_id;
+}
+
+/**
+ * @brief Reserva o proximo bloco de BLOCO_IDS IDs para a fonte (fora do caminho quente:
+ * uma vez a cada BLOCO_IDS pecas). Os blocos saem de um contador que so cresce, entao os
+ * IDs da sessao continuam crescentes.
+ */
+void renovarBlocoIds(FontePecas *fonte) {
+    if (!fonte->alocador) {
+        fonte->fim_bloco = INT64_MAX; // IDs proprios: o bloco e a faixa inteira
+        return;
+    }
+    fonte->proximo_id = atomic_fetch_add_explicit(&fonte->alocador->proximo, BLOCO_IDS, memory_order_relaxed);
+    fonte->fim_bloco = fonte->proximo_id + BLOCO_IDS;
+}
+
+/**
+ * @brief Gera uma nova peca com um tipo aleatorio e um ID unico da fonte.
+ * @return Retorna a estrutura Peca gerada.
+ */
+Peca gerarPecaDe(FontePecas *fonte) {
+    Peca nova_peca;
+
+    // Escolhe um tipo aleatorio com o gerador da sessao
+    nova_peca.nome = GERADOR_TIPOS[gerador_proximoTipo(&fonte->gerador)];
+
+    // Atribui o ID unico e incrementa o contador da sessao
+    if (fonte->proximo_id == fonte->fim_bloco) {
+        renovarBlocoIds(fonte);
+    }
+    nova_peca.id = fonte->proximo_id++;
+
+    return nova_peca;
+}
+
+/**
+ * @brief Gera n pecas em blocos contiguos de IDs (gerador_gerar_n), renovando o bloco
+ * de IDs da fonte quando ele acaba.
+ */
+void gerarPecasDe(FontePecas *fonte, Peca *destino, uint32_t n) {
+    while (n > 0) {
+        if (fonte->proximo_id == fonte->fim_bloco) {
+            renovarBlocoIds(fonte);
+        }
+        int64_t livres = fonte->fim_bloco - fonte->proximo_id;
+        uint32_t parte = livres < (int64_t)n ? (uint32_t)livres : n;
+        gerador_gerar_n(&fonte->gerador, destino, parte, &fonte->proximo_id);
+        destino += parte;
+        n -= parte;
+    }
+}
+
+/**
+ * @brief Gera uma nova peca da fonte padrao (sessao do programa).
+ */
+Peca gerarPeca(void) {
+    return gerarPecaDe(&fonte_padrao);
+}
+
+/**
+ * @brief Obtem a proxima peca para o reabastecimento de uma fila.
+ * Com o produtor ativo e apenas uma leitura do anel SPSC; caso contrario gera a peca aqui.
+ */
+Peca proximaPeca(FontePecas *fonte) {
+    if (fonte->produtor) {
+        return consumirPecaProdutor(fonte->produtor);
+    }
+    return gerarPecaDe(fonte);
+}
+
+/**
+ * @brief ID que a proxima peca entregue ao jogo tera.
+ * Com o produtor ativo, o contador da thread ja esta a frente (pecas pre-geradas no anel).
+ */
+int64_t proximoIdJogo(FontePecas *fonte) {
+    if (fonte->produtor) {
+        return espiarPecaProdutor(fonte->produtor).id;
+    }
+    return fonte->proximo_id;
+}
+
+/**
+ * @brief Codigo de 3 bits (0-6) de um tipo de peca, na ordem de GERADOR_TIPOS.
+ * @return O codigo, ou -1 se o nome nao for um tipo valido.
+ */
+int codigoTipo(char nome) {
+    switch (nome) {
+        case 'I': return 0;
+        case 'O': return 1;
+        case 'T': return 2;
+        case 'L': return 3;
+        case 'J': return 4;
+        case 'S': return 5;
+        case 'Z': return 6;
+        default: return -1;
+    }
+}
+
+/**
+ * @brief Calcula um resumo (FNV-1a de 64 bits) do estado da fila, da pilha e do contador de IDs.
+ * Duas execucoes com a mesma sequencia de pecas e acoes produzem o mesmo valor.
+ * A metade alta de um ID so entra no resumo quando nao e zero: IDs abaixo de 2^32
+ * dao o mesmo resumo de quando os IDs tinham 32 bits.
+ */
+uint64_t hashEstado(Fila *f, Pilha *p) {
+    uint64_t h = 1469598103934665603ULL;
+    #define MISTURA(v) do { h ^= (uint64_t)(uint32_t)(v); h *= 1099511628211ULL; } while (0)
+    #define MISTURA_ID(v) do { int64_t id_ = (v); MISTURA(id_); if (id_ >> 32) MISTURA(id_ >> 32); } while (0)
+    uint32_t tamanho = fila_tamanho(f);
+    MISTURA(tamanho);
+    for (uint32_t i = 0; i < tamanho; i++) {
+        uint32_t idx = (f->cabeca + i) & f->mascara;
+        MISTURA(f->elementos[idx].nome);
+        MISTURA_ID(f->elementos[idx].id);
+    }
+    MISTURA(p->topo);
+    for (int i = 0; i <= p->topo; i++) {
+        MISTURA(p->elementos[i].nome);
+        MISTURA_ID(p->elementos[i].id);
+    }
+    MISTURA_ID(proximoIdJogo(f->fonte));
+    #undef MISTURA_ID
+    #undef MISTURA
+    return h;
+}
+
+
+// --- 2. Criacao e Reabastecimento da Fila ---
+
+/**
+ * @brief Quantas posicoes o armazenamento de uma fila com este limite ocupa
+ * (o limite arredondado para potencia de dois).
+ */
+uint32_t fila_tamanhoArmazenamento(uint32_t limite) {
+    uint32_t tamanho = 1;
+    while (tamanho < limite) {
+        tamanho <<= 1;
+    }
+    return tamanho;
+}
+
+/**
+ * @brief Prepara a fila sobre um armazenamento fornecido pelo chamador, com
+ * fila_tamanhoArmazenamento(limite) posicoes. A fila reabastece da fonte padrao.
+ */
+void criarFilaEm(Fila *f, Peca *armazenamento, uint32_t limite) {
+    f->elementos = armazenamento;
+    f->mascara = fila_tamanhoArmazenamento(limite) - 1;
+    f->limite = limite;
+    f->fonte = &fonte_padrao;
+    f->indice = NULL;
+    inicializarFila(f);
+}
+
+/**
+ * @brief Aloca o armazenamento da fila para 'limite' pecas, arredondado para potencia de dois.
+ * @return 1 se a alocacao foi bem-sucedida, 0 caso contrario.
+ */
+int criarFila(Fila *f, uint32_t limite) {
+    if (limite == 0 || limite > (1u << 30)) {
+        return 0; // Falha: limite invalido
+    }
+    Peca *armazenamento = malloc(fila_tamanhoArmazenamento(limite) * sizeof(Peca));
+    if (!armazenamento) {
+        return 0; // Falha: sem memoria
+    }
+    criarFilaEm(f, armazenamento, limite);
+    return 1;
+}
+
+void destruirFila(Fila *f) {
+    desindexarFila(f);
+    free(f->elementos);
+    f->elementos = NULL;
+}
+
+/**
+ * @brief Remove a peca da frente da fila e reabastece o final com a proxima peca da fonte.
+ * @param ev Recebe a peca do reabastecimento (reabastecida/nova); pode ser NULL.
+ * @return A peca removida, ou uma peca com id -1 se a fila esta vazia.
+ */
+Peca dequeueEvento(Fila *f, EventoAcao *ev) {
+    Peca peca_removida = dequeueSimples(f);
+
+    if (peca_removida.id == -1) {
+        return peca_removida; // Falha: Fila Vazia
+    }
+
+    // Auto-reabastecimento: tenta inserir uma nova peça
+    if (!fila_estaCheia(f)) {
+        Peca nova = proximaPeca(f->fonte);
+        if (enqueue(f, nova)) {
+            EST_EVENTO(EVENTO_REABASTECIMENTO);
+            if (ev) {
+                ev->reabastecida = 1;
+                ev->nova = nova;
+            }
+        }
+    }
+    return peca_removida;
+}
+
+/**
+ * @brief Remove a peca da frente da fila (dequeue) e reabastece.
+ */
+Peca dequeue(Fila *f) {
+    return dequeueEvento(f, NULL);
+}
+
+/**
+ * @brief Completa a fila ate o limite com pecas novas, em blocos.
+ */
+void preencherFila(Fila *f) {
+    Peca bloco[256];
+
+    while (!fila_estaCheia(f)) {
+        uint32_t n = f->limite - fila_tamanho(f);
+        if (n > 256) n = 256;
+        if (f->fonte->produtor) {
+            for (uint32_t i = 0; i < n; i++) bloco[i] = consumirPecaProdutor(f->fonte->produtor);
+        } else {
+            gerarPecasDe(f->fonte, bloco, n);
+        }
+        fila_enqueue_n(f, bloco, n);
+    }
+}
+
+
+// --- 3. Criacao e Crescimento da Pilha ---
+
+/**
+ * @brief Prepara uma pilha vazia de capacidade fixa sobre um armazenamento do chamador
+ * (pelo menos 'capacidade' posicoes).
+ */
+void criarPilhaEm(Pilha *p, Peca *armazenamento, int capacidade) {
+    p->elementos = armazenamento;
+    p->capacidade = capacidade;
+    p->crescer = NULL;
+    p->indice = NULL;
+    inicializarPilha(p);
+}
+
+/**
+ * @brief Cria uma pilha vazia com o armazenamento tirado da arena (sem malloc por pilha).
+ * O armazenamento vale ate a arena ser reiniciada ou liberada.
+ * @param crescer 1 para a pilha dobrar de capacidade (na mesma arena) quando encher.
+ * @return 1 se a pilha foi criada, 0 se a capacidade e invalida ou faltou memoria.
+ */
+int criarPilha(Pilha *p, Arena *arena, int capacidade, int crescer) {
+    if (capacidade <= 0 || capacidade > (1 << 30)) {
+        return 0; // Falha: capacidade invalida
+    }
+    Peca *armazenamento = arena_alocar(arena, (size_t)capacidade * sizeof(Peca));
+    if (!armazenamento) {
+        return 0; // Falha: sem memoria
+    }
+    criarPilhaEm(p, armazenamento, capacidade);
+    p->crescer = crescer ? arena : NULL;
+    return 1;
+}
+
+static IndiceTipos *criarIndice(uint32_t posicoes); // Secao 4
+
+/**
+ * @brief Garante espaco para 'capacidade' pecas, copiando a pilha para um armazenamento
+ * maior da arena se ela puder crescer. O armazenamento antigo so volta com a arena.
+ * @return 1 se a pilha ja comporta (ou passou a comportar) 'capacidade' pecas, 0 caso
+ * contrario (a pilha e o seu indice ficam como estavam).
+ */
+int pilha_reservar(Pilha *p, int capacidade) {
+    if (capacidade <= p->capacidade) return 1;
+    if (!p->crescer || capacidade > (1 << 30)) return 0;
+
+    IndiceTipos *indice = NULL; // O indice cresce junto; alocado antes de mudar a pilha
+    if (p->indice && !(indice = criarIndice((uint32_t)capacidade))) return 0;
+    Peca *armazenamento = arena_alocar(p->crescer, (size_t)capacidade * sizeof(Peca));
+    if (!armazenamento) {
+        free(indice);
+        return 0;
+    }
+    memcpy(armazenamento, p->elementos, (size_t)(p->topo + 1) * sizeof(Peca));
+    p->elementos = armazenamento;
+    p->capacidade = capacidade;
+    if (indice) {
+        desindexarPilha(p);
+        p->indice = indice;
+        pilha_reconstruirIndice(p);
+    }
+    return 1;
+}
+
+/**
+ * @brief Dobra a capacidade de uma pilha cheia (push e reserva com crescimento).
+ * @return 1 se a pilha cresceu, 0 se ela tem capacidade fixa ou faltou memoria.
+ */
+int pilha_crescer(Pilha *p) {
+    if (p->capacidade > (1 << 29)) return 0;
+    return pilha_reservar(p, p->capacidade * 2);
+}
+
+
+// --- 4. Indice de Tipos ---
+
+/**
+ * @brief Aloca um indice vazio (estrutura e mascaras em um unico bloco) para 'posicoes' posicoes.
+ */
+static IndiceTipos *criarIndice(uint32_t posicoes) {
+    uint32_t palavras = (posicoes + 63) / 64;
+    IndiceTipos *ix = malloc(sizeof(IndiceTipos) + (size_t)INDICE_TIPOS * palavras * sizeof(uint64_t));
+    if (!ix) return NULL;
+    ix->palavras = palavras;
+    ix->bits = (uint64_t *)(ix + 1);
+    indice_limpar(ix);
+    return ix;
+}
+
+void indice_limpar(IndiceTipos *ix) {
+    memset(ix->contagem, 0, sizeof(ix->contagem));
+    memset(ix->bits, 0, (size_t)INDICE_TIPOS * ix->palavras * sizeof(uint64_t));
+}
+
+/**
+ * @brief Cria (ou recria) o indice de tipos da fila a partir do conteudo atual.
+ * Dai em diante toda operacao da fila o mantem atualizado.
+ * @return 1 em caso de sucesso, 0 se faltou memoria (a fila fica sem indice).
+ */
+int indexarFila(Fila *f) {
+    desindexarFila(f);
+    f->indice = criarIndice(f->mascara + 1);
+    if (!f->indice) return 0;
+    fila_reconstruirIndice(f);
+    return 1;
+}
+
+/**
+ * @brief Cria (ou recria, quando a pilha cresce) o indice de tipos da pilha.
+ * @return 1 em caso de sucesso, 0 se faltou memoria (a pilha fica sem indice).
+ */
+int indexarPilha(Pilha *p) {
+    desindexarPilha(p);
+    p->indice = criarIndice((uint32_t)p->capacidade);
+    if (!p->indice) return 0;
+    pilha_reconstruirIndice(p);
+    return 1;
+}
+
+void desindexarFila(Fila *f) {
+    free(f->indice);
+    f->indice = NULL;
+}
+
+void desindexarPilha(Pilha *p) {
+    free(p->indice);
+    p->indice = NULL;
+}
+
+/**
+ * @brief Refaz o indice a partir das pecas (apos escrita direta no armazenamento).
+ */
+void fila_reconstruirIndice(Fila *f) {
+    indice_limpar(f->indice);
+    indice_filaInserir(f, f->cabeca, fila_tamanho(f));
+}
+
+void pilha_reconstruirIndice(Pilha *p) {
+    indice_limpar(p->indice);
+    indice_pilhaInserir(p, 0, p->topo + 1);
+}
+
+/**
+ * @brief Marca no indice n pecas ja gravadas no anel a partir do contador 'pos'.
+ */
+void indice_filaInserir(Fila *f, uint32_t pos, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t idx = (pos + i) & f->mascara;
+        indice_marcar(f->indice, f->elementos[idx].nome, idx);
+    }
+}
+
+/**
+ * @brief Desmarca n pecas do anel a partir do contador 'pos' (ainda no armazenamento).
+ */
+void indice_filaRemover(Fila *f, uint32_t pos, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t idx = (pos + i) & f->mascara;
+        indice_desmarcar(f->indice, f->elementos[idx].nome, idx);
+    }
+}
+
+void indice_pilhaInserir(Pilha *p, int base, int n) {
+    for (int i = base; i < base + n; i++) {
+        indice_marcar(p->indice, p->elementos[i].nome, (uint32_t)i);
+    }
+}
+
+void indice_pilhaRemover(Pilha *p, int base, int n) {
+    for (int i = base; i < base + n; i++) {
+        indice_desmarcar(p->indice, p->elementos[i].nome, (uint32_t)i);
+    }
+}
+
+/**
+ * @brief Acerta os indices depois de fila_pilha_trocar_n: cada posicao trocada tem
+ * agora o tipo que estava na outra estrutura.
+ */
+void indice_trocaEmBloco(Fila *f, Pilha *p, uint32_t k) {
+    int base = p->topo + 1 - (int)k;
+    for (uint32_t i = 0; i < k; i++) {
+        uint32_t idx = (f->cabeca + i) & f->mascara;
+        char na_fila = f->elementos[idx].nome;            // Veio da pilha
+        char na_pilha = p->elementos[base + (int)i].nome; // Veio da fila
+        if (na_fila == na_pilha) continue;
+        if (f->indice) {
+            indice_desmarcar(f->indice, na_pilha, idx);
+            indice_marcar(f->indice, na_fila, idx);
+        }
+        if (p->indice) {
+            indice_desmarcar(p->indice, na_fila, (uint32_t)(base + (int)i));
+            indice_marcar(p->indice, na_pilha, (uint32_t)(base + (int)i));
+        }
+    }
+}
+
+/**
+ * @brief fila_distanciaTipo para aneis com mais de 64 posicoes: percorre as palavras
+ * da mascara a partir da frente, dando a volta no anel.
+ */
+int fila_distanciaTipoLonga(const Fila *f, int tipo) {
+    const uint64_t *m = f->indice->bits + (size_t)tipo * f->indice->palavras;
+    uint32_t posicoes = f->mascara + 1;
+    uint32_t frente = f->cabeca & f->mascara;
+    uint32_t palavra = frente >> 6;
+
+    // Primeira palavra: apenas os bits a partir da frente
+    uint64_t bits = m[palavra] & (~0ULL << (frente & 63));
+    for (uint32_t visitadas = 0; visitadas <= f->indice->palavras; visitadas++) {
+        if (bits) {
+            uint32_t idx = (palavra << 6) + (uint32_t)__builtin_ctzll(bits);
+            return (int)((idx - frente) & (posicoes - 1));
+        }
+        palavra = (palavra + 1 == f->indice->palavras) ? 0 : palavra + 1;
+        bits = m[palavra];
+    }
+    return -1;
+}
+
+/**
+ * @brief pilha_profundidadeTipo para pilhas com mais de 64 posicoes: percorre as
+ * palavras da mascara do topo para a base.
+ */
+int pilha_profundidadeTipoLonga(const Pilha *p, int tipo) {
+    const uint64_t *m = p->indice->bits + (size_t)tipo * p->indice->palavras;
+    for (int palavra = p->topo >> 6; palavra >= 0; palavra--) {
+        if (m[palavra]) {
+            return p->topo - ((palavra << 6) + (63 - __builtin_clzll(m[palavra])));
+        }
+    }
+    return -1;
+}
+
+
+// --- 5. Funcoes de Acao Estrategica (Logica do Jogo) ---
+// Cada acao preenche 'ev' com as pecas envolvidas; ev->reabastecida deve chegar
+// zerado (executarAcao cuida disso).
+
+/**
+ * @brief Joga a peca da frente da fila (dequeue com reabastecimento).
+ */
+ResultadoAcao jogarPecaAcao(Fila *f, EventoAcao *ev) {
+    Peca p = dequeueEvento(f, ev);
+    if (p.id != -1) {
+        ev->peca = p;
+        return ACAO_OK;
+    }
+    EST_EVENTO(EVENTO_FILA_VAZIA);
+    return ACAO_FILA_VAZIA;
+}
+
+/**
+ * @brief Move a peca da frente da fila para o topo da pilha (Reservar).
+ */
+ResultadoAcao reservarPecaAcao(Fila *f, Pilha *p, EventoAcao *ev) {
+    if (fila_estaVazia(f)) { // Antes da pilha: uma reserva que falha nao a faz crescer
+        EST_EVENTO(EVENTO_FILA_VAZIA);
+        return ACAO_FILA_VAZIA;
+    }
+    if (pilha_estaCheia(p) && !pilha_crescer(p)) {
+        EST_EVENTO(EVENTO_PILHA_CHEIA);
+        return ACAO_PILHA_CHEIA;
+    }
+
+    // 1. Remove da frente da fila (o dequeue ja reabastece a fila)
+    Peca peca_fila = dequeueEvento(f, ev);
+
+    // 2. Coloca no topo da pilha
+    if (push(p, peca_fila)) {
+        ev->peca = peca_fila;
+        return ACAO_OK;
+    }
+    return ACAO_FALHA_INTERNA;
+}
+
+/**
+ * @brief Remove a peca do topo da pilha (Usar Pecas Reservadas).
+ */
+ResultadoAcao usarPecaReservadaAcao(Pilha *p, Fila *f, EventoAcao *ev) {
+    (void)f;
+    Peca peca_pilha = pop(p);
+
+    if (peca_pilha.id != -1) {
+        ev->peca = peca_pilha;
+        return ACAO_OK;
+    }
+    EST_EVENTO(EVENTO_PILHA_VAZIA);
+    return ACAO_PILHA_VAZIA;
+}
+
+/**
+ * @brief Substitui a peca da frente da fila com o topo da pilha.
+ * O elemento removido da fila vai para o topo da pilha.
+ * Em ev: 'peca' e a antiga frente da fila e 'outra' o antigo topo da pilha.
+ */
+ResultadoAcao trocarPecaUnicaAcao(Fila *f, Pilha *p, EventoAcao *ev) {
+    if (pilha_estaVazia(p)) {
+        EST_EVENTO(EVENTO_PILHA_VAZIA);
+        return ACAO_PILHA_VAZIA;
+    }
+    if (fila_estaVazia(f)) {
+        EST_EVENTO(EVENTO_FILA_VAZIA);
+        return ACAO_FILA_VAZIA;
+    }
+
+    // 1. Pega a peca da frente da fila, mas NAO a remove (peek simplificado)
+    Peca *frente = &f->elementos[f->cabeca & f->mascara];
+    Peca peca_fila_frente = *frente;
+
+    // 2. Remove a peca do topo da pilha (pop)
+    Peca peca_pilha_topo = pop(p);
+
+    // 3. Coloca a peca do topo da pilha na frente da fila
+    *frente = peca_pilha_topo;
+    if (f->indice) {
+        uint32_t idx = f->cabeca & f->mascara;
+        indice_desmarcar(f->indice, peca_fila_frente.nome, idx);
+        indice_marcar(f->indice, peca_pilha_topo.nome, idx);
+    }
+
+    // 4. Coloca a peca que estava na frente da fila no topo da pilha (push)
+    if (push(p, peca_fila_frente)) {
+        ev->peca = peca_fila_frente;
+        ev->outra = peca_pilha_topo;
+        return ACAO_OK;
+    }
+    // Isso nao deveria acontecer se a pilha nao estava vazia, mas e um bom guardrail
+    return ACAO_FALHA_INTERNA;
+}
+
+/**
+ * @brief Alterna as k primeiras pecas da fila com as k pecas do topo da pilha, no lugar.
+ */
+ResultadoAcao trocarPecasBlocoAcao(Fila *f, Pilha *p, uint32_t k, EventoAcao *ev) {
+    (void)ev;
+
+    if (fila_tamanho(f) < k) {
+        EST_EVENTO(EVENTO_TROCA_INSUFICIENTE);
+        return ACAO_FILA_CURTA;
+    }
+    if ((uint32_t)(p->topo + 1) < k) {
+        EST_EVENTO(EVENTO_TROCA_INSUFICIENTE);
+        return ACAO_PILHA_CURTA;
+    }
+
+    fila_pilha_trocar_n(f, p, k);
+    return ACAO_OK;
+}
+
+/**
+ * @brief Alterna as 3 primeiras pecas da fila com as 3 pecas da pilha.
+ */
+ResultadoAcao trocarPecasMultiplaAcao(Fila *f, Pilha *p, EventoAcao *ev) {
+    return trocarPecasBlocoAcao(f, p, NUM_TROCA_MULTIPLA, ev);
+}
+
+/**
+ * @brief Despacha um codigo de acao (1-5) para a funcao correspondente e preenche 'ev'.
+ * Usado pelo menu interativo, pelo modo em lote, pelo diario e pelas ferramentas.
+ * @return O resultado da acao (tambem em ev->resultado).
+ */
+ResultadoAcao executarAcao(int codigo, Fila *f, Pilha *p, EventoAcao *ev) {
+    EST_INICIO(inicio);
+    ev->codigo = codigo;
+    ev->reabastecida = 0;
+    switch (codigo) {
+        case 1: ev->resultado = jogarPecaAcao(f, ev); break;
+        case 2: ev->resultado = reservarPecaAcao(f, p, ev); break;
+        case 3: ev->resultado = usarPecaReservadaAcao(p, f, ev); break;
+        case 4: ev->resultado = trocarPecaUnicaAcao(f, p, ev); break;
+        case 5: ev->resultado = trocarPecasMultiplaAcao(f, p, ev); break;
+        default: ev->resultado = ACAO_INVALIDA; break;
+    }
+    EST_ACAO(codigo, ev->resultado == ACAO_OK, inicio);
+    return ev->resultado;
+}
+
+/**
+ * @brief executarAcao() para quem so precisa saber se a acao foi aplicada.
+ * @return 1 se a acao foi aplicada, 0 em caso de falha, -1 se o codigo e invalido.
+ */
+int aplicarAcao(int codigo, Fila *f, Pilha *p) {
+    EventoAcao ev;
+    ResultadoAcao resultado = executarAcao(codigo, f, p, &ev);
+    if (resultado == ACAO_INVALIDA) return -1;
+    return resultado == ACAO_OK;
+}
@@ -0,0 +1,515 @@
+// Nucleo de gerenciamento de pecas: Peca, Fila circular, Pilha de reserva e as
+// acoes estrategicas, compartilhado por novato.c, aventureiro.c e mestre.c (e pelas
+// ferramentas bench.c, simulacao.c e reproduzir.c).
+//
+// O nucleo nao imprime nada: cada operacao devolve um codigo de retorno e as acoes
+// descrevem o que fizeram em um EventoAcao, que cada programa formata a seu modo.
+// As operacoes de Fila/Pilha do caminho quente sao static inline neste cabecalho;
+// o restante fica em pecas.c (biblioteca libpecas.a, ver Makefile).
+
+#ifndef PECAS_H
+#define PECAS_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+// Definições de Capacidade
+#define CAP_FILA 5   // Capacidade padrao da fila circular (configuravel na criacao)
+#define CAP_PILHA 3  // Capacidade padrao da pilha de reserva (configuravel na criacao)
+#define NUM_TROCA_MULTIPLA 3 // Pecas trocadas pela acao 5 (troca em bloco)
+
+// Separa dados escritos por threads diferentes em linhas de cache distintas
+#define TAM_LINHA_CACHE 64
+
+// IDs de peca: 56 bits com sinal, para caberem junto do tipo em 8 bytes (-1 = nenhuma peca)
+#define ID_PECA_MAX (((int64_t)1 << 55) - 1)
+#define BLOCO_IDS 4096 // IDs que uma sessao reserva de cada vez no alocador compartilhado
+
+// --- Estruturas de Dados ---
+
+// Atributos das pecas: nome (tipo) e id
+typedef struct {
+    char nome;       // Tipo da peca: 'I', 'O', 'T', 'L', 'J', 'S', 'Z'
+    int64_t id : 56; // Identificador unico (ate ID_PECA_MAX)
+} Peca;
+
+#include "gerador.h"
+
+typedef struct ProdutorPecas ProdutorPecas;
+typedef struct Arena Arena;
+
+// Contador de IDs compartilhado por varias sessoes (e threads). Cada sessao reserva
+// BLOCO_IDS IDs de uma vez, entao o contador recebe um fetch_add a cada BLOCO_IDS
+// pecas, e nao a cada peca. Os IDs sao unicos entre as sessoes e crescentes dentro
+// de cada uma. O contador ocupa sozinho uma linha de cache.
+typedef struct {
+    _Alignas(TAM_LINHA_CACHE) _Atomic int64_t proximo; // Primeiro ID ainda nao reservado
+} AlocadorIds;
+
+// Indice de tipos de uma fila ou pilha (opcional, ver indexarFila/indexarPilha):
+// quantas pecas de cada tipo ha e em que posicoes, mantido a cada insercao, remocao
+// e troca. Na fila a posicao e o indice no anel (contador & mascara); na pilha, a
+// distancia da base. As consultas (secao 4) sao contagens e operacoes de bits.
+#define INDICE_TIPOS (GERADOR_NUM_TIPOS + 1) // Os 7 tipos e uma entrada para letras desconhecidas
+typedef struct {
+    uint32_t contagem[INDICE_TIPOS];
+    uint32_t palavras;  // Palavras de 64 bits de cada mascara
+    uint64_t *bits;     // Mascara do tipo t: bits[t * palavras ...]; posicao i e o bit i % 64 da palavra i / 64
+} IndiceTipos;
+
+// Origem das pecas de uma sessao: o gerador de tipos e o contador de IDs.
+// Sem alocador, os IDs sao da sessao (0, 1, 2, ...); com alocador, vem de blocos dele.
+// Com 'produtor' preenchido, as pecas vem da thread produtora (ver produtor.h).
+typedef struct {
+    GeradorPecas gerador;   // Tipos da sessao
+    int64_t proximo_id;     // ID unico da proxima peca gerada
+    int64_t fim_bloco;      // Primeiro ID fora do bloco reservado (sem alocador: INT64_MAX)
+    AlocadorIds *alocador;  // De onde vem os blocos de IDs (NULL: IDs proprios da sessao)
+    uint64_t semente;       // Semente usada em inicializarFonte (apenas informativa)
+    ProdutorPecas *produtor;
+} FontePecas;
+
+// Estrutura para a Fila Circular
+// O armazenamento tem tamanho potencia de dois, entao o indice e uma mascara (& mascara)
+// em vez de um resto de divisao. 'cabeca' e 'cauda' sao contadores livres: nunca voltam
+// a zero, e o tamanho atual e sempre (cauda - cabeca), mesmo apos estourar 32 bits.
+typedef struct {
+    Peca *elementos;  // Armazenamento circular com (mascara + 1) posicoes
+    uint32_t mascara; // Tamanho do armazenamento - 1
+    uint32_t limite;  // Quantas pecas a fila aceita (ex.: CAP_FILA)
+    uint32_t cabeca;  // Total de remocoes (a frente esta em cabeca & mascara)
+    uint32_t cauda;   // Total de insercoes (a proxima insercao vai em cauda & mascara)
+    FontePecas *fonte; // De onde vem as pecas do reabastecimento
+    IndiceTipos *indice; // NULL: fila sem indice de tipos
+} Fila;
+
+// Estrutura para a Pilha de Reserva (Peças Reservadas)
+// A capacidade e escolhida na criacao. O armazenamento vem de uma arena (criarPilha)
+// ou do chamador (criarPilhaEm) e nunca e liberado pela pilha.
+typedef struct {
+    Peca *elementos;  // Armazenamento com 'capacidade' posicoes
+    int topo;         // Indice do ultimo elemento (topo da pilha)
+    int capacidade;   // Quantas pecas a pilha aceita (ex.: CAP_PILHA)
+    Arena *crescer;   // Com a pilha cheia, push dobra a capacidade nesta arena (NULL: capacidade fixa)
+    IndiceTipos *indice; // NULL: pilha sem indice de tipos
+} Pilha;
+
+// Resultado de uma acao estrategica
+typedef enum {
+    ACAO_OK = 0,
+    ACAO_FILA_VAZIA,     // Nao ha peca na fila
+    ACAO_PILHA_CHEIA,    // Reserva recusada: pilha cheia
+    ACAO_PILHA_VAZIA,    // Nao ha peca na pilha
+    ACAO_FILA_CURTA,     // Troca em bloco: menos pecas na fila que o tamanho da troca
+    ACAO_PILHA_CURTA,    // Troca em bloco: menos pecas na pilha que o tamanho da troca
+    ACAO_FALHA_INTERNA,  // Estado inconsistente (nao deveria acontecer)
+    ACAO_INVALIDA        // Codigo de acao desconhecido
+} ResultadoAcao;
+
+// O que uma acao fez, para quem for relatar (menu, diario, testes)
+typedef struct {
+    int codigo;              // Codigo da acao (1-5)
+    ResultadoAcao resultado;
+    Peca peca;               // Peca jogada, reservada ou usada; na troca, a que saiu da frente da fila
+    Peca outra;              // Na troca unica, a que saiu do topo da pilha
+    int reabastecida;        // 1 se o dequeue inseriu 'nova' no final da fila
+    Peca nova;
+} EventoAcao;
+
+// Fonte de pecas do programa (gerarPeca e filas criadas com criarFila/criarFilaEm)
+extern FontePecas fonte_padrao;
+
+// --- Prototipos de Funcoes de Utilitario ---
+void inicializarFonte(FontePecas *fonte, uint64_t semente, ModoGerador modo);
+void inicializarAlocadorIds(AlocadorIds *a, int64_t primeiro);
+void usarAlocadorIds(FontePecas *fonte, AlocadorIds *a);
+void renovarBlocoIds(FontePecas *fonte);
+Peca gerarPecaDe(FontePecas *fonte);
+void gerarPecasDe(FontePecas *fonte, Peca *destino, uint32_t n);
+Peca gerarPeca(void);
+Peca proximaPeca(FontePecas *fonte);
+int64_t proximoIdJogo(FontePecas *fonte);
+int codigoTipo(char nome);
+uint64_t hashEstado(Fila *f, Pilha *p);
+
+// --- Prototipos de Funcoes da Fila ---
+uint32_t fila_tamanhoArmazenamento(uint32_t limite);
+void criarFilaEm(Fila *f, Peca *armazenamento, uint32_t limite);
+int criarFila(Fila *f, uint32_t limite);
+void destruirFila(Fila *f);
+Peca dequeueEvento(Fila *f, EventoAcao *ev);
+Peca dequeue(Fila *f);
+void preencherFila(Fila *f);
+
+// --- Prototipos de Funcoes da Pilha ---
+void criarPilhaEm(Pilha *p, Peca *armazenamento, int capacidade);
+int criarPilha(Pilha *p, Arena *arena, int capacidade, int crescer);
+int pilha_reservar(Pilha *p, int capacidade);
+int pilha_crescer(Pilha *p);
+
+// --- Prototipos de Funcoes do Indice de Tipos ---
+int indexarFila(Fila *f);
+int indexarPilha(Pilha *p);
+void desindexarFila(Fila *f);
+void desindexarPilha(Pilha *p);
+void fila_reconstruirIndice(Fila *f);
+void pilha_reconstruirIndice(Pilha *p);
+void indice_limpar(IndiceTipos *ix);
+void indice_filaInserir(Fila *f, uint32_t pos, uint32_t n);
+void indice_filaRemover(Fila *f, uint32_t pos, uint32_t n);
+void indice_pilhaInserir(Pilha *p, int base, int n);
+void indice_pilhaRemover(Pilha *p, int base, int n);
+void indice_trocaEmBloco(Fila *f, Pilha *p, uint32_t k);
+int fila_distanciaTipoLonga(const Fila *f, int tipo);
+int pilha_profundidadeTipoLonga(const Pilha *p, int tipo);
+
+// --- Prototipos de Funcoes de Acao Estrategica ---
+ResultadoAcao jogarPecaAcao(Fila *f, EventoAcao *ev);
+ResultadoAcao reservarPecaAcao(Fila *f, Pilha *p, EventoAcao *ev);
+ResultadoAcao usarPecaReservadaAcao(Pilha *p, Fila *f, EventoAcao *ev);
+ResultadoAcao trocarPecaUnicaAcao(Fila *f, Pilha *p, EventoAcao *ev);
+ResultadoAcao trocarPecasBlocoAcao(Fila *f, Pilha *p, uint32_t k, EventoAcao *ev);
+ResultadoAcao trocarPecasMultiplaAcao(Fila *f, Pilha *p, EventoAcao *ev);
+ResultadoAcao executarAcao(int codigo, Fila *f, Pilha *p, EventoAcao *ev);
+int aplicarAcao(int codigo, Fila *f, Pilha *p);
+
+
+// --- Indice de Tipos: atualizacao (usada pelas secoes 1 a 3) ---
+
+// Codigo do tipo (0-6, ordem de GERADOR_TIPOS) pelos 5 bits baixos da letra; as demais
+// letras caem na entrada 7 do indice
+static const uint8_t CODIGO_TIPO_LETRA[32] = {
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 0, 4, 7, 3, 7, 7, 1, // 'I'=9, 'J'=10, 'L'=12, 'O'=15
+    7, 7, 7, 5, 2, 7, 7, 7, 7, 7, 6, 7, 7, 7, 7, 7, // 'S'=19, 'T'=20, 'Z'=26
+};
+
+static inline int tipoIndice(char nome) {
+    return CODIGO_TIPO_LETRA[(unsigned char)nome & 31];
+}
+
+static inline void indice_marcar(IndiceTipos *ix, char nome, uint32_t pos) {
+    int t = tipoIndice(nome);
+    ix->contagem[t]++;
+    ix->bits[(size_t)t * ix->palavras + (pos >> 6)] |= 1ULL << (pos & 63);
+}
+
+static inline void indice_desmarcar(IndiceTipos *ix, char nome, uint32_t pos) {
+    int t = tipoIndice(nome);
+    ix->contagem[t]--;
+    ix->bits[(size_t)t * ix->palavras + (pos >> 6)] &= ~(1ULL << (pos & 63));
+}
+
+
+// --- 1. Fila Circular (caminho quente) ---
+
+static inline void inicializarFila(Fila *f) {
+    f->cabeca = 0;
+    f->cauda = 0;
+    if (f->indice) indice_limpar(f->indice);
+}
+
+static inline uint32_t fila_tamanho(const Fila *f) {
+    return f->cauda - f->cabeca;
+}
+
+static inline int fila_estaVazia(const Fila *f) {
+    return (f->cauda == f->cabeca);
+}
+
+static inline int fila_estaCheia(const Fila *f) {
+    return (fila_tamanho(f) == f->limite);
+}
+
+/**
+ * @brief Insere uma nova peca no final da fila (enqueue).
+ * @return 1 em caso de sucesso, 0 se a fila esta cheia.
+ */
+static inline int enqueue(Fila *f, Peca p) {
+    if (fila_estaCheia(f)) {
+        return 0; // Falha: Fila Cheia
+    }
+
+    f->elementos[f->cauda & f->mascara] = p;
+    if (f->indice) indice_marcar(f->indice, p.nome, f->cauda & f->mascara);
+    f->cauda++;
+    return 1; // Sucesso
+}
+
+/**
+ * @brief Remove a peca da frente da fila sem reabastecer.
+ * @return A peca removida, ou uma peca com id -1 se a fila esta vazia.
+ */
+static inline Peca dequeueSimples(Fila *f) {
+    Peca peca_removida = {' ', -1}; // Peca de erro
+
+    if (fila_estaVazia(f)) {
+        return peca_removida; // Falha: Fila Vazia
+    }
+
+    peca_removida = f->elementos[f->cabeca & f->mascara];
+    if (f->indice) indice_desmarcar(f->indice, peca_removida.nome, f->cabeca & f->mascara);
+    f->cabeca++;
+    return peca_removida;
+}
+
+// --- 1.1 Operacoes em Bloco da Fila ---
+// Uma janela de n pecas a partir de um contador ocupa no maximo dois trechos
+// contiguos do armazenamento: ate o fim do array e, se der a volta, a partir do
+// indice 0. Cada operacao faz entao no maximo duas copias (memcpy), sem mascara
+// por elemento.
+
+/**
+ * @brief Copia n pecas do anel, a partir do contador 'pos', para 'destino'.
+ */
+static inline void copiarDoAnel(const Fila *f, uint32_t pos, Peca *destino, uint32_t n) {
+    uint32_t idx = pos & f->mascara;
+    uint32_t ate_o_fim = f->mascara + 1 - idx;
+    uint32_t primeiro = n < ate_o_fim ? n : ate_o_fim;
+
+    memcpy(destino, &f->elementos[idx], primeiro * sizeof(Peca));
+    memcpy(destino + primeiro, f->elementos, (n - primeiro) * sizeof(Peca));
+}
+
+/**
+ * @brief Copia n pecas de 'origem' para o anel, a partir do contador 'pos'.
+ */
+static inline void copiarParaAnel(Fila *f, uint32_t pos, const Peca *origem, uint32_t n) {
+    uint32_t idx = pos & f->mascara;
+    uint32_t ate_o_fim = f->mascara + 1 - idx;
+    uint32_t primeiro = n < ate_o_fim ? n : ate_o_fim;
+
+    memcpy(&f->elementos[idx], origem, primeiro * sizeof(Peca));
+    memcpy(f->elementos, origem + primeiro, (n - primeiro) * sizeof(Peca));
+}
+
+/**
+ * @brief Insere ate n pecas no final da fila, na ordem de 'origem'.
+ * @return Quantas pecas foram inseridas (menos que n se a fila encher).
+ */
+static inline uint32_t fila_enqueue_n(Fila *f, const Peca *origem, uint32_t n) {
+    uint32_t livres = f->limite - fila_tamanho(f);
+    if (n > livres) n = livres;
+
+    copiarParaAnel(f, f->cauda, origem, n);
+    if (f->indice) indice_filaInserir(f, f->cauda, n);
+    f->cauda += n;
+    return n;
+}
+
+/**
+ * @brief Remove ate n pecas da frente da fila, sem reabastecer.
+ * @return Quantas pecas foram removidas e copiadas para 'destino'.
+ */
+static inline uint32_t fila_dequeue_n(Fila *f, Peca *destino, uint32_t n) {
+    uint32_t tamanho = fila_tamanho(f);
+    if (n > tamanho) n = tamanho;
+
+    copiarDoAnel(f, f->cabeca, destino, n);
+    if (f->indice) indice_filaRemover(f, f->cabeca, n);
+    f->cabeca += n;
+    return n;
+}
+
+/**
+ * @brief Copia ate n pecas da frente da fila sem remove-las.
+ * @return Quantas pecas foram copiadas para 'destino'.
+ */
+static inline uint32_t fila_peek_n(const Fila *f, Peca *destino, uint32_t n) {
+    uint32_t tamanho = fila_tamanho(f);
+    if (n > tamanho) n = tamanho;
+
+    copiarDoAnel(f, f->cabeca, destino, n);
+    return n;
+}
+
+
+// --- 2. Pilha de Reserva (caminho quente) ---
+
+static inline void inicializarPilha(Pilha *p) {
+    p->topo = -1; // -1 indica que a pilha esta vazia
+    if (p->indice) indice_limpar(p->indice);
+}
+
+static inline int pilha_estaVazia(const Pilha *p) {
+    return (p->topo == -1);
+}
+
+static inline int pilha_estaCheia(const Pilha *p) {
+    return (p->topo == p->capacidade - 1);
+}
+
+/**
+ * @brief Insere uma peca no topo da pilha (push). Uma pilha criada com crescimento
+ * dobra de capacidade em vez de recusar (pilha_crescer, fora do caminho quente).
+ * @return 1 em caso de sucesso, 0 se a pilha esta cheia e nao pode crescer.
+ */
+static inline int push(Pilha *p, Peca peca) {
+    if (pilha_estaCheia(p) && !pilha_crescer(p)) {
+        return 0; // Falha: Pilha Cheia
+    }
+
+    p->topo++;
+    p->elementos[p->topo] = peca;
+    if (p->indice) indice_marcar(p->indice, peca.nome, (uint32_t)p->topo);
+    return 1; // Sucesso
+}
+
+/**
+ * @brief Remove uma peca do topo da pilha (pop).
+ * @return A peca removida, ou uma peca com id -1 se a pilha esta vazia.
+ */
+static inline Peca pop(Pilha *p) {
+    Peca peca_removida = {' ', -1}; // Peca de erro
+
+    if (pilha_estaVazia(p)) {
+        return peca_removida; // Falha: Pilha Vazia
+    }
+
+    peca_removida = p->elementos[p->topo];
+    if (p->indice) indice_desmarcar(p->indice, peca_removida.nome, (uint32_t)p->topo);
+    p->topo--;
+    return peca_removida;
+}
+
+/**
+ * @brief Empilha ate n pecas de uma vez; origem[n - 1] fica no topo.
+ * Uma pilha com crescimento aumenta de uma vez so para caber as n pecas.
+ * @return Quantas pecas foram empilhadas (menos que n se a pilha encher).
+ */
+static inline int pilha_push_n(Pilha *p, const Peca *origem, int n) {
+    if (n > p->capacidade - (p->topo + 1) && p->crescer) {
+        pilha_reservar(p, p->topo + 1 + n);
+    }
+    int livres = p->capacidade - (p->topo + 1);
+    if (n > livres) n = livres;
+    if (n <= 0) return 0;
+
+    memcpy(&p->elementos[p->topo + 1], origem, (size_t)n * sizeof(Peca));
+    if (p->indice) indice_pilhaInserir(p, p->topo + 1, n);
+    p->topo += n;
+    return n;
+}
+
+/**
+ * @brief Desempilha ate n pecas de uma vez, copiando-as na ordem da pilha
+ * (destino[n - 1] recebe o antigo topo). pilha_push_n com o mesmo bloco desfaz a operacao.
+ * @return Quantas pecas foram desempilhadas.
+ */
+static inline int pilha_pop_n(Pilha *p, Peca *destino, int n) {
+    int tamanho = p->topo + 1;
+    if (n > tamanho) n = tamanho;
+    if (n <= 0) return 0;
+
+    p->topo -= n;
+    memcpy(destino, &p->elementos[p->topo + 1], (size_t)n * sizeof(Peca));
+    if (p->indice) indice_pilhaRemover(p, p->topo + 1, n);
+    return n;
+}
+
+
+
+// --- 3. Troca em Bloco entre Fila e Pilha ---
+
+/**
+ * @brief Troca n pecas entre dois trechos que nao se sobrepoem (a[i] <-> b[i]).
+ * Anda de 4 em 4 pecas (32 bytes): cada bloco vai e volta por registradores com
+ * copias de tamanho fixo, que o compilador faz com instrucoes vetoriais mesmo em -O2.
+ */
+static inline void trocarTrechos(Peca *restrict a, Peca *restrict b, uint32_t n) {
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        Peca x[4], y[4];
+        memcpy(x, a + i, sizeof(x));
+        memcpy(y, b + i, sizeof(y));
+        memcpy(a + i, y, sizeof(y));
+        memcpy(b + i, x, sizeof(x));
+    }
+    for (; i < n; i++) {
+        Peca t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+    }
+}
+
+/**
+ * @brief Troca, no lugar, as k primeiras pecas da fila com as k pecas do topo da pilha.
+ * A i-esima peca da fila (a partir da frente) troca de lugar com a i-esima do trecho
+ * da pilha (a partir da base do trecho), entao o topo da pilha vai para a posicao
+ * k - 1 da fila. No anel o trecho ocupa no maximo dois segmentos contiguos.
+ * Os indices de tipos (se houver) sao acertados depois, fora do caminho quente.
+ * @return k se a troca foi feita, 0 se a fila ou a pilha tem menos de k pecas.
+ */
+static inline uint32_t fila_pilha_trocar_n(Fila *f, Pilha *p, uint32_t k) {
+    if (k > fila_tamanho(f) || (int)k > p->topo + 1) return 0;
+
+    Peca *trecho_pilha = &p->elementos[p->topo + 1 - (int)k];
+    uint32_t idx = f->cabeca & f->mascara;
+    uint32_t ate_o_fim = f->mascara + 1 - idx;
+    uint32_t primeiro = k < ate_o_fim ? k : ate_o_fim;
+
+    trocarTrechos(&f->elementos[idx], trecho_pilha, primeiro);
+    trocarTrechos(f->elementos, trecho_pilha + primeiro, k - primeiro);
+    if (f->indice || p->indice) indice_trocaEmBloco(f, p, k);
+    return k;
+}
+
+
+// --- 4. Consultas ao Indice de Tipos ---
+// A fila ou a pilha consultada precisa estar indexada (indexarFila/indexarPilha).
+// Os tipos sao dados pela letra ('I', 'O', ...).
+
+/**
+ * @brief Quantas pecas do tipo ha na fila (pre-visualizacao).
+ */
+static inline uint32_t fila_contarTipo(const Fila *f, char nome) {
+    return f->indice->contagem[tipoIndice(nome)];
+}
+
+/**
+ * @brief Quantas pecas do tipo ha na pilha de reserva.
+ */
+static inline uint32_t pilha_contarTipo(const Pilha *p, char nome) {
+    return p->indice->contagem[tipoIndice(nome)];
+}
+
+static inline int pilha_contemTipo(const Pilha *p, char nome) {
+    return pilha_contarTipo(p, nome) > 0;
+}
+
+/**
+ * @brief Distancia da frente da fila ate a primeira peca do tipo (0 = a propria frente).
+ * Com o anel em uma palavra (ate 64 posicoes) e uma rotacao e um ctz; filas maiores
+ * percorrem as palavras a partir da frente (fila_distanciaTipoLonga).
+ * @return A distancia, ou -1 se nao ha peca do tipo na fila.
+ */
+static inline int fila_distanciaTipo(const Fila *f, char nome) {
+    const IndiceTipos *ix = f->indice;
+    int t = tipoIndice(nome);
+    if (ix->contagem[t] == 0) return -1;
+    if (ix->palavras > 1) return fila_distanciaTipoLonga(f, t);
+
+    uint32_t posicoes = f->mascara + 1;
+    uint32_t frente = f->cabeca & f->mascara;
+    uint64_t m = ix->bits[t];
+    // Gira a mascara para a frente ficar no bit 0 (o anel tem 'posicoes' bits)
+    uint64_t girada = (m >> frente) | (frente ? m << (posicoes - frente) : 0);
+    if (posicoes < 64) girada &= (1ULL << posicoes) - 1;
+    return girada ? __builtin_ctzll(girada) : -1;
+}
+
+/**
+ * @brief Distancia do topo da pilha ate a peca do tipo mais proxima (0 = o proprio topo).
+ * @return A distancia, ou -1 se nao ha peca do tipo na pilha.
+ */
+static inline int pilha_profundidadeTipo(const Pilha *p, char nome) {
+    const IndiceTipos *ix = p->indice;
+    int t = tipoIndice(nome);
+    if (ix->contagem[t] == 0) return -1;
+    if (ix->palavras > 1) return pilha_profundidadeTipoLonga(p, t);
+
+    // So ha bits ate o topo: o mais alto e a peca do tipo mais perto do topo
+    return p->topo - (63 - __builtin_clzll(ix->bits[t]));
+}
+
+#endif // PECAS_H
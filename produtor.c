@@ -0,0 +1,102 @@
+// Produtor de pecas em segundo plano (ver produtor.h).
+
+#include <sched.h>
+
+#include "produtor.h"
+
+/**
+ * @brief Laco da thread produtora: gera pecas enquanto houver espaco no anel.
+ * Usa apenas a sua propria copia da fonte ('origem'), sem compartilhar estado com o jogo.
+ */
+static void *lacoProdutor(void *arg) {
+    ProdutorPecas *pr = arg;
+    uint32_t cauda = atomic_load_explicit(&pr->cauda, memory_order_relaxed);
+
+    while (atomic_load_explicit(&pr->executando, memory_order_relaxed)) {
+        uint32_t livres = CAP_PRODUTOR - (cauda - pr->cabeca_vista);
+        if (livres == 0) {
+            pr->cabeca_vista = atomic_load_explicit(&pr->cabeca, memory_order_acquire);
+            livres = CAP_PRODUTOR - (cauda - pr->cabeca_vista);
+            if (livres == 0) {
+                sched_yield(); // Anel cheio: o jogo esta atrasado, cede a CPU
+                continue;
+            }
+        }
+        // Publica em lotes para diluir o custo do store-release; o espaco livre
+        // ocupa no maximo dois trechos contiguos do anel
+        uint32_t pos = cauda & (CAP_PRODUTOR - 1);
+        uint32_t primeiro = CAP_PRODUTOR - pos < livres ? CAP_PRODUTOR - pos : livres;
+        gerarPecasDe(&pr->origem, &pr->elementos[pos], primeiro);
+        gerarPecasDe(&pr->origem, pr->elementos, livres - primeiro);
+        cauda += livres;
+        atomic_store_explicit(&pr->cauda, cauda, memory_order_release);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Inicia a thread produtora com o anel vazio e liga a fonte a ela.
+ * A thread continua a sequencia da fonte (mesmo gerador e mesmos IDs); dai em
+ * diante a fonte so entrega pecas lidas do anel.
+ * @return 1 se a thread foi criada, 0 caso contrario.
+ */
+int iniciarProdutor(ProdutorPecas *pr, FontePecas *fonte) {
+    atomic_init(&pr->cabeca, 0);
+    atomic_init(&pr->cauda, 0);
+    atomic_init(&pr->executando, 1);
+    pr->cauda_vista = 0;
+    pr->cabeca_vista = 0;
+    pr->leituras = 0;
+    pr->vazias = 0;
+    pr->origem = *fonte;
+    if (pthread_create(&pr->thread, NULL, lacoProdutor, pr) != 0) {
+        return 0;
+    }
+    fonte->produtor = pr;
+    return 1;
+}
+
+void pararProdutor(ProdutorPecas *pr) {
+    atomic_store_explicit(&pr->executando, 0, memory_order_relaxed);
+    pthread_join(pr->thread, NULL);
+}
+
+/**
+ * @brief Espera ate que o anel tenha ao menos uma peca (lado do jogo).
+ * Cada espera conta como um evento de anel vazio.
+ */
+static uint32_t aguardarPecaProdutor(ProdutorPecas *pr) {
+    uint32_t cabeca = atomic_load_explicit(&pr->cabeca, memory_order_relaxed);
+
+    if (cabeca == pr->cauda_vista) {
+        pr->cauda_vista = atomic_load_explicit(&pr->cauda, memory_order_acquire);
+        if (cabeca == pr->cauda_vista) {
+            pr->vazias++;
+            do {
+                sched_yield();
+                pr->cauda_vista = atomic_load_explicit(&pr->cauda, memory_order_acquire);
+            } while (cabeca == pr->cauda_vista);
+        }
+    }
+    return cabeca;
+}
+
+/**
+ * @brief Retira uma peca do anel (lado do jogo).
+ */
+Peca consumirPecaProdutor(ProdutorPecas *pr) {
+    uint32_t cabeca = aguardarPecaProdutor(pr);
+    Peca p = pr->elementos[cabeca & (CAP_PRODUTOR - 1)];
+    atomic_store_explicit(&pr->cabeca, cabeca + 1, memory_order_release);
+    pr->leituras++;
+    return p;
+}
+
+/**
+ * @brief Le a proxima peca do anel sem retira-la.
+ */
+Peca espiarPecaProdutor(ProdutorPecas *pr) {
+    return pr->elementos[aguardarPecaProdutor(pr) & (CAP_PRODUTOR - 1)];
+}
+
+
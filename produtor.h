@@ -0,0 +1,39 @@
+// Produtor de pecas em segundo plano (mestre --produtor).
+//
+// Uma thread gera as pecas da sessao e as publica em um anel lock-free de produtor
+// unico / consumidor unico (SPSC); o jogo so le do anel. Ver iniciarProdutor().
+
+#ifndef PRODUTOR_H
+#define PRODUTOR_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "pecas.h"
+
+#define CAP_PRODUTOR 4096    // Capacidade do anel produtor -> jogo (potencia de dois)
+
+// Anel lock-free de produtor unico / consumidor unico (SPSC).
+// A thread produtora so escreve 'cauda' e o jogo so escreve 'cabeca'; cada lado
+// guarda uma copia local do contador do outro para evitar reler a linha de cache
+// compartilhada a cada peca.
+struct ProdutorPecas {
+    _Alignas(TAM_LINHA_CACHE) _Atomic uint32_t cabeca; // Escrito pelo consumidor (jogo)
+    uint32_t cauda_vista;                              // Copia local do consumidor
+    uint64_t leituras;                                 // Pecas consumidas
+    uint64_t vazias;                                   // Vezes em que o anel estava vazio
+    _Alignas(TAM_LINHA_CACHE) _Atomic uint32_t cauda;  // Escrito pelo produtor (thread)
+    uint32_t cabeca_vista;                             // Copia local do produtor
+    FontePecas origem;                                 // Gerador usado apenas pela thread
+    _Atomic int executando;
+    pthread_t thread;
+    _Alignas(TAM_LINHA_CACHE) Peca elementos[CAP_PRODUTOR];
+};
+
+int iniciarProdutor(ProdutorPecas *pr, FontePecas *fonte);
+void pararProdutor(ProdutorPecas *pr);
+Peca consumirPecaProdutor(ProdutorPecas *pr);
+Peca espiarPecaProdutor(ProdutorPecas *pr);
+
+#endif // PRODUTOR_H
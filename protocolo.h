@@ -0,0 +1,139 @@
+// Protocolo binario do servidor de sessoes (servidor.c) e do gerador de carga (carga.c).
+//
+// Cada conexao e uma sessao de Fila/Pilha propria. O cliente envia comandos e cada
+// comando tem exatamente uma resposta, na mesma ordem: o cliente pode enviar varios
+// sem esperar (pipeline) e sabe o tamanho de cada resposta pelo comando que enviou.
+// Inteiros em little-endian.
+//
+//   Comando                                   Bytes   Resposta                         Bytes
+//   Acao: o proprio codigo (1-5)                1     ResultadoAcao                      1
+//   PROTO_ESTADO                                1     estado da sessao (abaixo)         24
+//   PROTO_INICIAR semente:u64 modo:u8           12    0 = ok, 1 = parametros invalidos   1
+//                 fila:u8 pilha:u8
+//   PROTO_SERVIDOR                              1     cpu_ns:u64 threads:u32            16
+//                                                     sessoes_ativas:u32
+//
+// Estado: hash:u64 (hashEstado) proximo_id:u64 acoes:u32 fila:u8 pilha:u8
+// frente:u8 topo:u8 (nome das pecas, 0 se vazia). Uma conexao nova ja tem uma sessao
+// padrao (CAP_FILA, CAP_PILHA, gerador uniforme); PROTO_INICIAR a recomeca.
+
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stdint.h>
+
+#include "pecas.h"
+
+#define PROTO_SOCKET_PADRAO "/tmp/tetris.sock"
+
+#define PROTO_ESTADO 0x10
+#define PROTO_INICIAR 0x11
+#define PROTO_SERVIDOR 0x12
+
+#define PROTO_TAM_INICIAR 12
+#define PROTO_TAM_ESTADO 24
+#define PROTO_TAM_SERVIDOR 16
+#define PROTO_MAX_RESPOSTA PROTO_TAM_ESTADO
+
+#define PROTO_MAX_FILA 32   // Maior fila de uma sessao remota (armazenamento proprio)
+#define PROTO_MAX_PILHA 16
+
+// Sessao de uma conexao: fila, pilha e fonte sobre armazenamento proprio, sem alocacao
+typedef struct {
+    Fila fila;
+    Pilha pilha;
+    FontePecas fonte;
+    uint32_t acoes;
+    Peca armazenamento_fila[PROTO_MAX_FILA];
+    Peca armazenamento_pilha[PROTO_MAX_PILHA];
+} SessaoProto;
+
+
+// --- 1. Inteiros em Little-Endian ---
+
+static inline void proto_gravar32(uint8_t *d, uint32_t v) {
+    for (int i = 0; i < 4; i++) d[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline void proto_gravar64(uint8_t *d, uint64_t v) {
+    for (int i = 0; i < 8; i++) d[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint32_t proto_ler32(const uint8_t *d) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)d[i] << (8 * i);
+    return v;
+}
+
+static inline uint64_t proto_ler64(const uint8_t *d) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)d[i] << (8 * i);
+    return v;
+}
+
+
+// --- 2. Sessao e Comandos ---
+
+/**
+ * @brief Tamanho do comando que comeca com o byte 'tipo' (0 se o byte e invalido).
+ */
+static inline int proto_tamanhoComando(uint8_t tipo) {
+    if (tipo >= 1 && tipo <= 5) return 1;
+    if (tipo == PROTO_ESTADO || tipo == PROTO_SERVIDOR) return 1;
+    if (tipo == PROTO_INICIAR) return PROTO_TAM_INICIAR;
+    return 0;
+}
+
+/**
+ * @brief Tamanho da resposta ao comando 'tipo'.
+ */
+static inline int proto_tamanhoResposta(uint8_t tipo) {
+    if (tipo == PROTO_ESTADO) return PROTO_TAM_ESTADO;
+    if (tipo == PROTO_SERVIDOR) return PROTO_TAM_SERVIDOR;
+    return 1;
+}
+
+/**
+ * @brief (Re)comeca a sessao com a fila cheia.
+ * @return 1 em caso de sucesso, 0 se os parametros estao fora dos limites.
+ */
+static inline int proto_iniciarSessao(SessaoProto *s, uint64_t semente, int modo, uint32_t limite_fila,
+                                      int capacidade_pilha) {
+    if (modo != GERADOR_UNIFORME && modo != GERADOR_SACO7) return 0;
+    if (limite_fila == 0 || fila_tamanhoArmazenamento(limite_fila) > PROTO_MAX_FILA) return 0;
+    if (capacidade_pilha < 1 || capacidade_pilha > PROTO_MAX_PILHA) return 0;
+    inicializarFonte(&s->fonte, semente, (ModoGerador)modo);
+    criarFilaEm(&s->fila, s->armazenamento_fila, limite_fila);
+    s->fila.fonte = &s->fonte;
+    criarPilhaEm(&s->pilha, s->armazenamento_pilha, capacidade_pilha);
+    s->acoes = 0;
+    preencherFila(&s->fila);
+    return 1;
+}
+
+/**
+ * @brief Monta o comando PROTO_INICIAR em d (PROTO_TAM_INICIAR bytes).
+ */
+static inline void proto_comandoIniciar(uint8_t *d, uint64_t semente, int modo, uint32_t limite_fila,
+                                        int capacidade_pilha) {
+    d[0] = PROTO_INICIAR;
+    proto_gravar64(d + 1, semente);
+    d[9] = (uint8_t)modo;
+    d[10] = (uint8_t)limite_fila;
+    d[11] = (uint8_t)capacidade_pilha;
+}
+
+/**
+ * @brief Escreve a resposta de PROTO_ESTADO (PROTO_TAM_ESTADO bytes).
+ */
+static inline void proto_respostaEstado(uint8_t *d, SessaoProto *s) {
+    proto_gravar64(d, hashEstado(&s->fila, &s->pilha));
+    proto_gravar64(d + 8, (uint64_t)proximoIdJogo(&s->fonte));
+    proto_gravar32(d + 16, s->acoes);
+    d[20] = (uint8_t)fila_tamanho(&s->fila);
+    d[21] = (uint8_t)(s->pilha.topo + 1);
+    d[22] = fila_estaVazia(&s->fila) ? 0 : (uint8_t)s->fila.elementos[s->fila.cabeca & s->fila.mascara].nome;
+    d[23] = pilha_estaVazia(&s->pilha) ? 0 : (uint8_t)s->pilha.elementos[s->pilha.topo].nome;
+}
+
+#endif // PROTOCOLO_H
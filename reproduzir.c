@@ -0,0 +1,193 @@
+// Reproducao de um diario de acoes gravado com `mestre --diario arquivo`.
+//
+// O diario e mapeado em memoria (mmap) e cada acao e reexecutada com as mesmas
+// funcoes de Fila/Pilha do nucleo (pecas.h), a partir da semente gravada no cabecalho.
+// O resultado de cada acao e a peca gerada no reabastecimento sao conferidos com o
+// que foi gravado, e o hash do estado e conferido em cada ponto de verificacao: a
+// primeira divergencia interrompe a reproducao.
+//
+// Compilar: make reproduzir
+// Uso:      reproduzir diario.bin [-v]
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "pecas.h"
+#include "arena.h"
+#include "diario.h"
+
+/**
+ * @brief Informa a primeira divergencia entre o diario e a reproducao.
+ */
+static void relatarDivergencia(uint64_t acao, const char *motivo, long long gravado, long long obtido) {
+    fprintf(stderr, "DIVERGENCIA na acao %llu: %s (gravado %lld, reproduzido %lld)\n",
+            (unsigned long long)acao, motivo, gravado, obtido);
+}
+
+/**
+ * @brief Reexecuta as acoes do diario sobre a fila e a pilha.
+ * @return 0 se tudo conferiu, 2 em caso de divergencia, 1 se o diario esta corrompido.
+ */
+static int reproduzirDiario(const uint8_t *dados, size_t tamanho, Fila *f, Pilha *p, int detalhado,
+                            uint64_t *acoes, uint64_t *verificacoes) {
+    size_t pos = sizeof(CabecalhoDiario);
+    *acoes = 0;
+    *verificacoes = 0;
+
+    while (pos < tamanho) {
+        uint8_t byte = dados[pos];
+
+        if (byte == DIARIO_VERIFICACAO) {
+            int64_t proximo_id;
+            uint64_t hash;
+            if (pos + TAM_VERIFICACAO_DIARIO > tamanho) {
+                fprintf(stderr, "Diario truncado no ponto de verificacao (byte %zu).\n", pos);
+                return 1;
+            }
+            memcpy(&proximo_id, dados + pos + 1, sizeof(proximo_id));
+            memcpy(&hash, dados + pos + 1 + sizeof(proximo_id), sizeof(hash));
+            pos += TAM_VERIFICACAO_DIARIO;
+            (*verificacoes)++;
+
+            if (proximoIdJogo(f->fonte) != proximo_id) {
+                relatarDivergencia(*acoes, "proximo_id", proximo_id, proximoIdJogo(f->fonte));
+                return 2;
+            }
+            uint64_t obtido = hashEstado(f, p);
+            if (obtido != hash) {
+                fprintf(stderr, "DIVERGENCIA na acao %llu: hash gravado %016llx, reproduzido %016llx\n",
+                        (unsigned long long)*acoes, (unsigned long long)hash, (unsigned long long)obtido);
+                return 2;
+            }
+            if (detalhado) {
+                printf("verificacao %llu: acao=%llu proximo_id=%lld hash=%016llx ok\n",
+                       (unsigned long long)*verificacoes, (unsigned long long)*acoes, (long long)proximo_id,
+                       (unsigned long long)hash);
+            }
+            continue;
+        }
+
+        int codigo = byte & 7;
+        int tipo_gravado = ((byte >> 3) & 7) - 1;
+        int sucesso_gravado = (byte >> 6) & 1;
+        if ((byte & 0x80) || codigo < 1 || codigo > 5 || tipo_gravado >= GERADOR_NUM_TIPOS) {
+            fprintf(stderr, "Byte invalido 0x%02x no diario (byte %zu).\n", byte, pos);
+            return 1;
+        }
+        pos++;
+
+        EventoAcao ev;
+        int sucesso = executarAcao(codigo, f, p, &ev) == ACAO_OK;
+        int tipo = ev.reabastecida ? codigoTipo(ev.nova.nome) : -1;
+        (*acoes)++;
+
+        if (sucesso != sucesso_gravado) {
+            relatarDivergencia(*acoes, "resultado da acao", sucesso_gravado, sucesso);
+            return 2;
+        }
+        if (tipo != tipo_gravado) {
+            relatarDivergencia(*acoes, "tipo da peca gerada", tipo_gravado, tipo);
+            return 2;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *caminho = NULL;
+    int detalhado = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            detalhado = 1;
+        } else if (!caminho) {
+            caminho = argv[i];
+        } else {
+            caminho = NULL;
+            break;
+        }
+    }
+    if (!caminho) {
+        fprintf(stderr, "Uso: %s diario.bin [-v]\n", argv[0]);
+        return 1;
+    }
+
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        perror(caminho);
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(caminho);
+        close(fd);
+        return 1;
+    }
+    size_t tamanho = (size_t)st.st_size;
+    if (tamanho < sizeof(CabecalhoDiario)) {
+        fprintf(stderr, "%s: arquivo pequeno demais para um diario.\n", caminho);
+        close(fd);
+        return 1;
+    }
+    const uint8_t *dados = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (dados == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    madvise((void *)dados, tamanho, MADV_SEQUENTIAL);
+
+    CabecalhoDiario cab;
+    memcpy(&cab, dados, sizeof(cab));
+    if (memcmp(cab.magico, DIARIO_MAGICO, sizeof(cab.magico)) != 0 || cab.versao != DIARIO_VERSAO) {
+        fprintf(stderr, "%s: nao e um diario da versao %d.\n", caminho, DIARIO_VERSAO);
+        munmap((void *)dados, tamanho);
+        return 1;
+    }
+    if (cab.modo != GERADOR_UNIFORME && cab.modo != GERADOR_SACO7) {
+        fprintf(stderr, "Modo de gerador invalido no diario: %u\n", cab.modo);
+        munmap((void *)dados, tamanho);
+        return 1;
+    }
+
+    Fila fila;
+    Pilha pilha;
+    if (!criarFila(&fila, cab.limite_fila)) {
+        fprintf(stderr, "Capacidade de fila invalida no diario: %u\n", cab.limite_fila);
+        munmap((void *)dados, tamanho);
+        return 1;
+    }
+    if (!criarPilha(&pilha, arena_daThread(), (int)cab.cap_pilha, cab.flags_pilha & DIARIO_PILHA_CRESCE)) {
+        fprintf(stderr, "Capacidade de pilha invalida no diario: %u\n", cab.cap_pilha);
+        destruirFila(&fila);
+        munmap((void *)dados, tamanho);
+        return 1;
+    }
+    inicializarFonte(&fonte_padrao, cab.semente, (ModoGerador)cab.modo);
+    preencherFila(&fila);
+
+    struct timespec t0, t1;
+    uint64_t acoes, verificacoes;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int status = reproduzirDiario(dados, tamanho, &fila, &pilha, detalhado, &acoes, &verificacoes);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double segundos = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("acoes=%llu verificacoes=%llu semente=%llu bytes=%zu\n", (unsigned long long)acoes,
+           (unsigned long long)verificacoes, (unsigned long long)cab.semente, tamanho);
+    printf("fila=%u/%u pilha=%d/%d proximo_id=%lld hash=%016llx\n",
+           fila_tamanho(&fila), fila.limite, pilha.topo + 1, pilha.capacidade, (long long)proximoIdJogo(fila.fonte),
+           (unsigned long long)hashEstado(&fila, &pilha));
+    printf("tempo=%.6fs vazao=%.0f acoes/s %s\n", segundos, segundos > 0 ? acoes / segundos : 0.0,
+           status == 0 ? "OK" : "FALHOU");
+
+    munmap((void *)dados, tamanho);
+    destruirFila(&fila);
+    arena_liberar(arena_daThread());
+    return status;
+}
@@ -0,0 +1,410 @@
+// Servidor de sessoes: muitos jogadores em um processo, por um socket Unix.
+//
+// Cada conexao e uma sessao de Fila/Pilha propria e fala o protocolo binario de
+// protocolo.h. Um pool fixo de threads atende todas as conexoes: cada thread tem a
+// sua instancia de epoll, e o socket de escuta esta em todas elas com EPOLLEXCLUSIVE
+// (uma conexao nova acorda uma thread so). Quem aceita distribui as conexoes em
+// rodizio entre os epolls das threads, e cada conexao fica com a thread que a recebeu
+// ate fechar: a sessao so e tocada por essa thread, sem travas. Os comandos ja
+// recebidos sao processados em sequencia e as respostas saem com um unico send por
+// leitura; com a saida cheia, a conexao para de ler ate o cliente consumir as respostas.
+//
+// SIGINT/SIGTERM encerram o servidor: um eventfd presente em todas as instancias de
+// epoll acorda as threads, e o resumo (conexoes, comandos, CPU) e impresso ao sair.
+//
+// Compilar: make servidor
+// Uso:      servidor [--socket caminho] [-t threads]
+// Carga:    carga (ver carga.c)
+
+#define _GNU_SOURCE // accept4()
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "pecas.h"
+#include "protocolo.h"
+
+#define MAX_THREADS 64
+#define MAX_EVENTOS 64          // Eventos por epoll_wait
+#define TAM_ENTRADA 4096        // Comandos recebidos e ainda nao processados
+#define TAM_SAIDA 8192          // Respostas ainda nao enviadas
+
+// Conexao de um cliente, com a sua sessao. So a thread que a aceitou a usa.
+typedef struct {
+    int fd;
+    int esperando_escrita;      // 1: epoll espera EPOLLOUT (a leitura fica suspensa)
+    SessaoProto sessao;
+    size_t tam_entrada;
+    size_t inicio_saida, fim_saida;
+    uint8_t entrada[TAM_ENTRADA];
+    uint8_t saida[TAM_SAIDA];
+} Conexao;
+
+// Uma thread do pool. Os contadores so sao escritos pela propria thread.
+typedef struct {
+    _Alignas(TAM_LINHA_CACHE) int epoll;
+    int indice;
+    pthread_t thread;
+    uint64_t conexoes;          // Conexoes aceitas por esta thread (atendidas por qualquer uma)
+    uint64_t sessoes;
+    uint64_t comandos;
+    uint64_t acoes;
+    _Atomic uint32_t ativas;    // Conexoes abertas agora (lido por PROTO_SERVIDOR)
+} Trabalhador;
+
+static int socket_escuta = -1;
+static int evento_parar = -1;
+static int num_threads = 1;
+static Trabalhador trabalhadores[MAX_THREADS];
+static _Atomic uint64_t sementes = 1; // Semente da sessao padrao de cada conexao nova
+static _Atomic uint32_t rodizio = 0;  // Thread que recebe a proxima conexao
+
+// Marcadores de data.ptr no epoll (as conexoes usam o proprio ponteiro)
+static char marca_escuta, marca_parar;
+
+
+// --- 1. Comandos ---
+
+static uint64_t tempoCpuNs(void) {
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return ((uint64_t)uso.ru_utime.tv_sec + (uint64_t)uso.ru_stime.tv_sec) * 1000000000ULL +
+           ((uint64_t)uso.ru_utime.tv_usec + (uint64_t)uso.ru_stime.tv_usec) * 1000ULL;
+}
+
+/**
+ * @brief Processa os comandos completos da entrada enquanto houver espaco para a
+ * resposta. O que sobra (comando incompleto ou saida cheia) fica para depois.
+ * @return 0 se chegou um byte de comando invalido (a conexao e fechada).
+ */
+static int processarComandos(Trabalhador *t, Conexao *c) {
+    size_t pos = 0;
+    int valida = 1;
+
+    if (c->inicio_saida > 0) { // Abre espaco no fim da saida
+        memmove(c->saida, c->saida + c->inicio_saida, c->fim_saida - c->inicio_saida);
+        c->fim_saida -= c->inicio_saida;
+        c->inicio_saida = 0;
+    }
+    while (pos < c->tam_entrada && c->fim_saida + PROTO_MAX_RESPOSTA <= TAM_SAIDA) {
+        const uint8_t *cmd = c->entrada + pos;
+        int tamanho = proto_tamanhoComando(cmd[0]);
+        if (tamanho == 0) {
+            valida = 0;
+            break;
+        }
+        if (pos + (size_t)tamanho > c->tam_entrada) break;
+
+        uint8_t *resposta = c->saida + c->fim_saida;
+        SessaoProto *s = &c->sessao;
+        if (cmd[0] <= 5) {
+            EventoAcao ev;
+            resposta[0] = (uint8_t)executarAcao(cmd[0], &s->fila, &s->pilha, &ev);
+            s->acoes++;
+            t->acoes++;
+        } else if (cmd[0] == PROTO_ESTADO) {
+            proto_respostaEstado(resposta, s);
+        } else if (cmd[0] == PROTO_INICIAR) {
+            int ok = proto_iniciarSessao(s, proto_ler64(cmd + 1), cmd[9], cmd[10], cmd[11]);
+            resposta[0] = !ok;
+            t->sessoes += ok;
+        } else { // PROTO_SERVIDOR
+            uint32_t ativas = 0;
+            for (int i = 0; i < num_threads; i++) ativas += atomic_load_explicit(&trabalhadores[i].ativas, memory_order_relaxed);
+            proto_gravar64(resposta, tempoCpuNs());
+            proto_gravar32(resposta + 8, (uint32_t)num_threads);
+            proto_gravar32(resposta + 12, ativas);
+        }
+        c->fim_saida += (size_t)proto_tamanhoResposta(cmd[0]);
+        t->comandos++;
+        pos += (size_t)tamanho;
+    }
+    memmove(c->entrada, c->entrada + pos, c->tam_entrada - pos);
+    c->tam_entrada -= pos;
+    return valida;
+}
+
+
+// --- 2. Conexoes ---
+
+/**
+ * @brief Envia o que der da saida, sem bloquear.
+ * @return 0 se a conexao caiu.
+ */
+static int enviarSaida(Conexao *c) {
+    while (c->inicio_saida < c->fim_saida) {
+        ssize_t n = send(c->fd, c->saida + c->inicio_saida, c->fim_saida - c->inicio_saida, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        c->inicio_saida += (size_t)n;
+    }
+    c->inicio_saida = c->fim_saida = 0;
+    return 1;
+}
+
+static void fecharConexao(Trabalhador *t, Conexao *c) {
+    epoll_ctl(t->epoll, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    free(c);
+    atomic_fetch_sub_explicit(&t->ativas, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Aceita as conexoes pendentes, cada uma com uma sessao padrao, e as registra
+ * em rodizio no epoll das threads.
+ */
+static void aceitarConexoes(Trabalhador *t) {
+    for (;;) {
+        int fd = accept4(socket_escuta, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("accept4");
+            return;
+        }
+        Conexao *c = malloc(sizeof(Conexao));
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->esperando_escrita = 0;
+        c->tam_entrada = 0;
+        c->inicio_saida = c->fim_saida = 0;
+        proto_iniciarSessao(&c->sessao, atomic_fetch_add(&sementes, 1), GERADOR_UNIFORME, CAP_FILA, CAP_PILHA);
+
+        Trabalhador *destino = &trabalhadores[atomic_fetch_add(&rodizio, 1) % (uint32_t)num_threads];
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = c};
+        atomic_fetch_add_explicit(&destino->ativas, 1, memory_order_relaxed);
+        if (epoll_ctl(destino->epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            perror("epoll_ctl");
+            atomic_fetch_sub_explicit(&destino->ativas, 1, memory_order_relaxed);
+            close(fd);
+            free(c);
+            continue;
+        }
+        t->conexoes++;
+        t->sessoes++;
+    }
+}
+
+/**
+ * @brief Atende os eventos de uma conexao: le os comandos, processa e responde.
+ * Enquanto ha resposta pendente, so EPOLLOUT e pedido: a conexao nao le mais nada
+ * ate o cliente consumir as respostas.
+ * @return 0 se a conexao deve ser fechada.
+ */
+static int atenderConexao(Trabalhador *t, Conexao *c, uint32_t eventos) {
+    if (eventos & EPOLLERR) return 0;
+    if ((eventos & EPOLLOUT) && !enviarSaida(c)) return 0;
+    if ((eventos & (EPOLLIN | EPOLLHUP)) && c->tam_entrada < TAM_ENTRADA) {
+        ssize_t n;
+        do {
+            n = recv(c->fd, c->entrada + c->tam_entrada, TAM_ENTRADA - c->tam_entrada, 0);
+        } while (n < 0 && errno == EINTR);
+        if (n == 0) return 0;
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return 0;
+        } else {
+            c->tam_entrada += (size_t)n;
+        }
+    }
+    int valida = processarComandos(t, c);
+    if (!enviarSaida(c) || !valida) return 0; // Um comando invalido fecha a conexao depois das respostas anteriores
+
+    int pendente = c->fim_saida > c->inicio_saida;
+    if (pendente != c->esperando_escrita) {
+        struct epoll_event ev = {.events = pendente ? EPOLLOUT : EPOLLIN, .data.ptr = c};
+        if (epoll_ctl(t->epoll, EPOLL_CTL_MOD, c->fd, &ev) != 0) return 0;
+        c->esperando_escrita = pendente;
+    }
+    return 1;
+}
+
+static void *executarTrabalhador(void *arg) {
+    Trabalhador *t = arg;
+    struct epoll_event eventos[MAX_EVENTOS];
+
+    for (;;) {
+        int n = epoll_wait(t->epoll, eventos, MAX_EVENTOS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            void *ptr = eventos[i].data.ptr;
+            if (ptr == &marca_parar) return NULL; // As conexoes ainda abertas morrem com o processo
+            if (ptr == &marca_escuta) {
+                aceitarConexoes(t);
+            } else if (!atenderConexao(t, ptr, eventos[i].events)) {
+                fecharConexao(t, ptr);
+            }
+        }
+    }
+    return NULL;
+}
+
+
+// --- Funcao Principal ---
+
+static void pedirParada(int sinal) {
+    (void)sinal;
+    uint64_t um = 1;
+    ssize_t ignorado = write(evento_parar, &um, sizeof(um));
+    (void)ignorado;
+}
+
+/**
+ * @brief Libera 'caminho' para o bind: so remove um socket abandonado (ninguem aceita
+ * conexoes nele). Um arquivo que nao e socket ou um servidor ativo no caminho sao erro.
+ * @return 1 se o caminho esta livre, 0 caso contrario (ja avisado).
+ */
+static int liberarCaminho(const char *caminho, const struct sockaddr_un *endereco) {
+    struct stat st;
+    if (lstat(caminho, &st) != 0) {
+        if (errno == ENOENT) return 1;
+        perror(caminho);
+        return 0;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        fprintf(stderr, "%s: ja existe e nao e um socket.\n", caminho);
+        return 0;
+    }
+    int sonda = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sonda < 0) {
+        perror("socket");
+        return 0;
+    }
+    int ativo = connect(sonda, (const struct sockaddr *)endereco, sizeof(*endereco)) == 0;
+    int erro = errno;
+    close(sonda);
+    if (ativo) {
+        fprintf(stderr, "%s: ja ha um servidor atendendo neste socket.\n", caminho);
+        return 0;
+    }
+    if (erro != ECONNREFUSED) {
+        errno = erro;
+        perror(caminho);
+        return 0;
+    }
+    if (unlink(caminho) != 0 && errno != ENOENT) {
+        perror(caminho);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Cria o socket de escuta em 'caminho' (ver liberarCaminho: so um socket
+ * abandonado no caminho e removido).
+ * @return O descritor, ou -1 em caso de erro.
+ */
+static int criarEscuta(const char *caminho) {
+    struct sockaddr_un endereco;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Caminho do socket longo demais: %s\n", caminho);
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strcpy(endereco.sun_path, caminho);
+    if (!liberarCaminho(caminho, &endereco)) {
+        close(fd);
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *)&endereco, sizeof(endereco)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        perror(caminho);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char *argv[]) {
+    const char *caminho = PROTO_SOCKET_PADRAO;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            caminho = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Uso: %s [--socket caminho] [-t threads]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (num_threads < 1 || num_threads > MAX_THREADS) {
+        fprintf(stderr, "Numero de threads invalido (1 a %d).\n", MAX_THREADS);
+        return 1;
+    }
+
+    if ((socket_escuta = criarEscuta(caminho)) < 0) return 1;
+    if ((evento_parar = eventfd(0, EFD_CLOEXEC)) < 0) {
+        perror("eventfd");
+        return 1;
+    }
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = pedirParada;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+
+    int status = 0, iniciadas = 0;
+    for (; iniciadas < num_threads; iniciadas++) {
+        Trabalhador *t = &trabalhadores[iniciadas];
+        struct epoll_event escuta = {.events = EPOLLIN | EPOLLEXCLUSIVE, .data.ptr = &marca_escuta};
+        struct epoll_event parar = {.events = EPOLLIN, .data.ptr = &marca_parar};
+        t->indice = iniciadas;
+        t->epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (t->epoll < 0 || epoll_ctl(t->epoll, EPOLL_CTL_ADD, socket_escuta, &escuta) != 0 ||
+            epoll_ctl(t->epoll, EPOLL_CTL_ADD, evento_parar, &parar) != 0 ||
+            pthread_create(&t->thread, NULL, executarTrabalhador, t) != 0) {
+            perror("Nao foi possivel iniciar as threads");
+            status = 1;
+            pedirParada(0);
+            break;
+        }
+    }
+    if (status == 0) printf("Servidor em %s com %d thread(s). Ctrl-C encerra.\n", caminho, num_threads);
+    fflush(stdout);
+
+    uint64_t conexoes = 0, sessoes = 0, comandos = 0, acoes = 0;
+    for (int i = 0; i < iniciadas; i++) {
+        Trabalhador *t = &trabalhadores[i];
+        pthread_join(t->thread, NULL);
+        printf("thread %d: conexoes=%llu sessoes=%llu comandos=%llu\n", i, (unsigned long long)t->conexoes,
+               (unsigned long long)t->sessoes, (unsigned long long)t->comandos);
+        conexoes += t->conexoes;
+        sessoes += t->sessoes;
+        comandos += t->comandos;
+        acoes += t->acoes;
+    }
+    double cpu = tempoCpuNs() / 1e9;
+    printf("total: conexoes=%llu sessoes=%llu comandos=%llu acoes=%llu cpu=%.3fs sessoes/s de CPU=%.0f\n",
+           (unsigned long long)conexoes, (unsigned long long)sessoes, (unsigned long long)comandos,
+           (unsigned long long)acoes, cpu, cpu > 0 ? sessoes / cpu : 0.0);
+
+    close(socket_escuta);
+    unlink(caminho);
+    return status;
+}
@@ -0,0 +1,491 @@
+// Sessoes em estrutura de arrays e os nucleos vetoriais das acoes 1-4 (ver sessoes.h).
+
+#include <string.h>
+
+#include "sessoes.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SESSOES_X86 1
+#include <immintrin.h>
+// Os nucleos sao compilados para a extensao de cada um, sem mudar as flags do resto do
+// nucleo; sessoes_aplicar() so chama os que a CPU suporta
+#define ALVO_AVX2 __attribute__((target("avx2")))
+#define ALVO_SSE4 __attribute__((target("sse4.1")))
+#endif
+
+
+// --- 1. Criacao, Inicio e Exportacao ---
+
+/**
+ * @brief Cria n sessoes com o armazenamento tirado da arena. Todas (inclusive as que
+ * completam o ultimo bloco) comecam como sessoes_iniciar(i, 0).
+ * @return 1 se as sessoes foram criadas, 0 se os tamanhos sao invalidos ou faltou memoria.
+ */
+int sessoes_criar(SessoesSoA *s, Arena *arena, uint32_t n, uint32_t limite, int capacidade_pilha) {
+    if (n == 0 || n > (1u << 24) || limite == 0 || limite > SESSOES_MAX_FILA || capacidade_pilha < 1 ||
+        capacidade_pilha > SESSOES_MAX_PILHA) {
+        return 0;
+    }
+    size_t w = ((size_t)n + SESSOES_BLOCO - 1) & ~(size_t)(SESSOES_BLOCO - 1);
+    s->n = n;
+    s->largura = (uint32_t)w;
+    s->limite = limite;
+    s->capacidade_pilha = capacidade_pilha;
+    s->tipo_fila = arena_alocar(arena, limite * w);
+    s->id_fila = arena_alocar(arena, limite * w * sizeof(int64_t));
+    s->tipo_pilha = arena_alocar(arena, (size_t)capacidade_pilha * w);
+    s->id_pilha = arena_alocar(arena, (size_t)capacidade_pilha * w * sizeof(int64_t));
+    s->topo = arena_alocar(arena, w);
+    s->proximo_id = arena_alocar(arena, w * sizeof(int64_t));
+    s->gerador = arena_alocar(arena, 4 * w * sizeof(uint64_t));
+    if (!s->tipo_fila || !s->id_fila || !s->tipo_pilha || !s->id_pilha || !s->topo || !s->proximo_id ||
+        !s->gerador) {
+        return 0;
+    }
+
+    memset(s->tipo_pilha, 0, (size_t)capacidade_pilha * w);
+    memset(s->id_pilha, 0, (size_t)capacidade_pilha * w * sizeof(int64_t));
+    for (uint32_t i = 0; i < w; i++) sessoes_iniciar(s, i, 0);
+    return 1;
+}
+
+/**
+ * @brief (Re)comeca a sessao i como uma sessao nova com essa semente: pilha vazia e a
+ * fila cheia com as mesmas pecas de inicializarFonte() + preencherFila().
+ */
+void sessoes_iniciar(SessoesSoA *s, uint32_t i, uint64_t semente) {
+    FontePecas fonte;
+    Peca fila[SESSOES_MAX_FILA];
+    size_t w = s->largura;
+
+    inicializarFonte(&fonte, semente, GERADOR_UNIFORME);
+    gerarPecasDe(&fonte, fila, s->limite);
+    for (uint32_t j = 0; j < s->limite; j++) {
+        s->tipo_fila[j * w + i] = (uint8_t)codigoTipo(fila[j].nome);
+        s->id_fila[j * w + i] = fila[j].id;
+    }
+    s->topo[i] = -1;
+    s->proximo_id[i] = fonte.proximo_id;
+    for (int k = 0; k < 4; k++) s->gerador[k * w + i] = fonte.gerador.s[k];
+}
+
+/**
+ * @brief Copia a sessao i para uma fila e uma pilha comuns (por exemplo para hashEstado).
+ * @param f Fila com o mesmo limite e com fonte propria (f->fonte), que recebe o gerador.
+ * @param p Pilha com pelo menos capacidade_pilha posicoes.
+ */
+void sessoes_exportar(const SessoesSoA *s, uint32_t i, Fila *f, Pilha *p) {
+    size_t w = s->largura;
+
+    inicializarFila(f);
+    for (uint32_t j = 0; j < s->limite; j++) {
+        Peca peca = {GERADOR_TIPOS[s->tipo_fila[j * w + i]], s->id_fila[j * w + i]};
+        enqueue(f, peca);
+    }
+    inicializarPilha(p);
+    for (int k = 0; k <= s->topo[i]; k++) {
+        Peca peca = {GERADOR_TIPOS[s->tipo_pilha[k * w + i]], s->id_pilha[k * w + i]};
+        push(p, peca);
+    }
+    FontePecas *fonte = f->fonte;
+    for (int k = 0; k < 4; k++) fonte->gerador.s[k] = s->gerador[k * w + i];
+    fonte->gerador.restantes = 0;
+    fonte->gerador.modo = GERADOR_UNIFORME;
+    fonte->proximo_id = s->proximo_id[i];
+    fonte->fim_bloco = INT64_MAX;
+    fonte->alocador = NULL;
+    fonte->produtor = NULL;
+}
+
+
+// --- 2. Caminho Escalar ---
+
+/**
+ * @brief Aplica a acao a sessao i, com as mesmas regras (e resultados) de executarAcao().
+ */
+static ResultadoAcao aplicarSessao(SessoesSoA *s, int codigo, uint32_t i) {
+    size_t w = s->largura;
+    uint32_t limite = s->limite;
+    int topo = s->topo[i];
+
+    switch (codigo) {
+        case 1:
+            break;
+        case 2:
+            if (topo == s->capacidade_pilha - 1) return ACAO_PILHA_CHEIA;
+            topo++;
+            s->tipo_pilha[topo * w + i] = s->tipo_fila[i];
+            s->id_pilha[topo * w + i] = s->id_fila[i];
+            s->topo[i] = (int8_t)topo;
+            break;
+        case 3:
+            if (topo < 0) return ACAO_PILHA_VAZIA;
+            s->topo[i] = (int8_t)(topo - 1);
+            return ACAO_OK;
+        case 4:
+        case 5: {
+            uint32_t k = codigo == 4 ? 1 : NUM_TROCA_MULTIPLA;
+            if (codigo == 4 && topo < 0) return ACAO_PILHA_VAZIA;
+            if (limite < k) return ACAO_FILA_CURTA;
+            if ((uint32_t)(topo + 1) < k) return ACAO_PILHA_CURTA;
+            // A j-esima peca da fila troca com a j-esima do trecho do topo (fila_pilha_trocar_n)
+            for (uint32_t j = 0; j < k; j++) {
+                size_t a = j * w + i, b = (topo + 1 - k + j) * w + i;
+                uint8_t tipo = s->tipo_fila[a];
+                int64_t id = s->id_fila[a];
+                s->tipo_fila[a] = s->tipo_pilha[b];
+                s->id_fila[a] = s->id_pilha[b];
+                s->tipo_pilha[b] = tipo;
+                s->id_pilha[b] = id;
+            }
+            return ACAO_OK;
+        }
+        default:
+            return ACAO_INVALIDA;
+    }
+
+    // Jogar e reservar: a fila anda uma posicao e recebe uma peca nova no fim
+    for (uint32_t j = 0; j + 1 < limite; j++) {
+        s->tipo_fila[j * w + i] = s->tipo_fila[(j + 1) * w + i];
+        s->id_fila[j * w + i] = s->id_fila[(j + 1) * w + i];
+    }
+    GeradorPecas g;
+    for (int k = 0; k < 4; k++) g.s[k] = s->gerador[k * w + i];
+    s->tipo_fila[(limite - 1) * w + i] = (uint8_t)gerador_intervalo(&g, GERADOR_NUM_TIPOS);
+    s->id_fila[(limite - 1) * w + i] = s->proximo_id[i]++;
+    for (int k = 0; k < 4; k++) s->gerador[k * w + i] = g.s[k];
+    return ACAO_OK;
+}
+
+static void aplicarEscalar(SessoesSoA *s, int codigo, uint8_t *resultado) {
+    for (uint32_t i = 0; i < s->n; i++) {
+        ResultadoAcao r = aplicarSessao(s, codigo, i);
+        if (resultado) resultado[i] = (uint8_t)r;
+    }
+}
+
+
+#ifdef SESSOES_X86
+// --- 3. Nucleo AVX2 (32 sessoes por passo) ---
+// Tipos e topos andam em bytes (32 sessoes por registrador); IDs e o gerador em
+// palavras de 64 bits (4 sessoes), com a mascara de bytes estendida por grupo de 4.
+
+/**
+ * @brief Mascara de 64 bits das sessoes 4g..4g+3 a partir da mascara de bytes gravada em 'bytes'.
+ */
+ALVO_AVX2 static inline __m256i mascaraGrupoAvx2(const uint8_t *bytes, int g) {
+    int32_t q;
+    memcpy(&q, bytes + 4 * g, sizeof(q));
+    return _mm256_cvtepi8_epi64(_mm_cvtsi32_si128(q));
+}
+
+ALVO_AVX2 static inline __m256i rotlAvx2(__m256i x, int k) {
+    return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+}
+
+/**
+ * @brief Um passo do xoshiro256** e gerador_intervalo(7) em 4 sessoes; o estado so
+ * avanca onde 'ativa' esta ligada.
+ * @return Os 4 tipos sorteados, um por palavra de 64 bits.
+ */
+ALVO_AVX2 static inline __m256i sortearTiposAvx2(uint64_t *gerador, size_t w, __m256i ativa) {
+    __m256i s0 = _mm256_loadu_si256((const __m256i *)gerador);
+    __m256i s1 = _mm256_loadu_si256((const __m256i *)(gerador + w));
+    __m256i s2 = _mm256_loadu_si256((const __m256i *)(gerador + 2 * w));
+    __m256i s3 = _mm256_loadu_si256((const __m256i *)(gerador + 3 * w));
+
+    // rotl(s1 * 5, 7) * 9, com as multiplicacoes feitas por deslocamento e soma
+    __m256i x = rotlAvx2(_mm256_add_epi64(s1, _mm256_slli_epi64(s1, 2)), 7);
+    __m256i sorteado = _mm256_add_epi64(x, _mm256_slli_epi64(x, 3));
+    __m256i t = _mm256_slli_epi64(s1, 17);
+    __m256i n2 = _mm256_xor_si256(s2, s0);
+    __m256i n3 = _mm256_xor_si256(s3, s1);
+    __m256i n1 = _mm256_xor_si256(s1, n2);
+    __m256i n0 = _mm256_xor_si256(s0, n3);
+    n2 = _mm256_xor_si256(n2, t);
+    n3 = rotlAvx2(n3, 45);
+
+    _mm256_storeu_si256((__m256i *)gerador, _mm256_blendv_epi8(s0, n0, ativa));
+    _mm256_storeu_si256((__m256i *)(gerador + w), _mm256_blendv_epi8(s1, n1, ativa));
+    _mm256_storeu_si256((__m256i *)(gerador + 2 * w), _mm256_blendv_epi8(s2, n2, ativa));
+    _mm256_storeu_si256((__m256i *)(gerador + 3 * w), _mm256_blendv_epi8(s3, n3, ativa));
+
+    // ((sorteado >> 32) * 7) >> 32, como gerador_intervalo
+    __m256i alto = _mm256_srli_epi64(sorteado, 32);
+    return _mm256_srli_epi64(_mm256_mul_epu32(alto, _mm256_set1_epi64x(GERADOR_NUM_TIPOS)), 32);
+}
+
+/**
+ * @brief Troca tipo e ID entre a linha 'a' da fila e a linha 'b' da pilha onde 'm' esta
+ * ligada (jogar/reservar usam a mesma mascara para copiar so num sentido).
+ */
+ALVO_AVX2 static inline void trocarLinhasAvx2(uint8_t *tipo_a, int64_t *id_a, uint8_t *tipo_b, int64_t *id_b,
+                                              __m256i m, int copiar_so_para_b) {
+    uint8_t bytes[32];
+    __m256i a = _mm256_loadu_si256((const __m256i *)tipo_a);
+    __m256i b = _mm256_loadu_si256((const __m256i *)tipo_b);
+
+    _mm256_storeu_si256((__m256i *)tipo_b, _mm256_blendv_epi8(b, a, m));
+    if (!copiar_so_para_b) _mm256_storeu_si256((__m256i *)tipo_a, _mm256_blendv_epi8(a, b, m));
+    _mm256_storeu_si256((__m256i *)bytes, m);
+    for (int g = 0; g < 8; g++) {
+        __m256i m64 = mascaraGrupoAvx2(bytes, g);
+        __m256i ia = _mm256_loadu_si256((const __m256i *)(id_a + 4 * g));
+        __m256i ib = _mm256_loadu_si256((const __m256i *)(id_b + 4 * g));
+        _mm256_storeu_si256((__m256i *)(id_b + 4 * g), _mm256_blendv_epi8(ib, ia, m64));
+        if (!copiar_so_para_b) _mm256_storeu_si256((__m256i *)(id_a + 4 * g), _mm256_blendv_epi8(ia, ib, m64));
+    }
+}
+
+/**
+ * @brief Jogar/reservar nas sessoes ativas do bloco b: a fila anda uma linha e a ultima
+ * recebe a peca sorteada, com o proximo ID de cada sessao.
+ */
+ALVO_AVX2 static void reabastecerAvx2(SessoesSoA *s, size_t b, __m256i ativa) {
+    size_t w = s->largura;
+    uint32_t ultima = s->limite - 1;
+    uint8_t bytes[32], novos[32];
+    const __m256i juntar = _mm256_setr_epi8(0, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                            0, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    for (uint32_t j = 0; j < ultima; j++) {
+        trocarLinhasAvx2(s->tipo_fila + (j + 1) * w + b, s->id_fila + (j + 1) * w + b,
+                         s->tipo_fila + j * w + b, s->id_fila + j * w + b, ativa, 1);
+    }
+
+    _mm256_storeu_si256((__m256i *)bytes, ativa);
+    int64_t *id_ultima = s->id_fila + ultima * w + b;
+    for (int g = 0; g < 8; g++) {
+        __m256i m64 = mascaraGrupoAvx2(bytes, g);
+        __m256i tipos = sortearTiposAvx2(s->gerador + b + 4 * g, w, m64);
+        // Os 4 tipos estao no byte 0 de cada palavra: junta em 4 bytes seguidos
+        __m256i juntos = _mm256_shuffle_epi8(tipos, juntar);
+        uint32_t q = (uint32_t)_mm256_extract_epi16(juntos, 0) | ((uint32_t)_mm256_extract_epi16(juntos, 8) << 16);
+        memcpy(novos + 4 * g, &q, sizeof(q));
+
+        __m256i id = _mm256_loadu_si256((const __m256i *)(s->proximo_id + b + 4 * g));
+        __m256i antigo = _mm256_loadu_si256((const __m256i *)(id_ultima + 4 * g));
+        _mm256_storeu_si256((__m256i *)(id_ultima + 4 * g), _mm256_blendv_epi8(antigo, id, m64));
+        _mm256_storeu_si256((__m256i *)(s->proximo_id + b + 4 * g), _mm256_sub_epi64(id, m64));
+    }
+    uint8_t *tipo_ultima = s->tipo_fila + ultima * w + b;
+    __m256i antigo = _mm256_loadu_si256((const __m256i *)tipo_ultima);
+    __m256i novo = _mm256_loadu_si256((const __m256i *)novos);
+    _mm256_storeu_si256((__m256i *)tipo_ultima, _mm256_blendv_epi8(antigo, novo, ativa));
+}
+
+ALVO_AVX2 static void aplicarAvx2(SessoesSoA *s, int codigo, uint8_t *resultado) {
+    size_t w = s->largura;
+    const __m256i uns = _mm256_set1_epi8(-1);
+
+    for (size_t b = 0; b < s->n; b += 32) {
+        __m256i topo = _mm256_loadu_si256((const __m256i *)(s->topo + b));
+        __m256i falha = _mm256_setzero_si256();
+        int codigo_falha = ACAO_OK;
+        if (codigo == 2) {
+            falha = _mm256_cmpeq_epi8(topo, _mm256_set1_epi8((char)(s->capacidade_pilha - 1)));
+            codigo_falha = ACAO_PILHA_CHEIA;
+        } else if (codigo == 3 || codigo == 4) {
+            falha = _mm256_cmpeq_epi8(topo, uns);
+            codigo_falha = ACAO_PILHA_VAZIA;
+        }
+        __m256i ativa = _mm256_xor_si256(falha, uns);
+
+        if (resultado) {
+            uint8_t r[32];
+            _mm256_storeu_si256((__m256i *)r, _mm256_and_si256(falha, _mm256_set1_epi8((char)codigo_falha)));
+            memcpy(resultado + b, r, s->n - b < 32 ? s->n - b : 32);
+        }
+
+        if (codigo == 2 || codigo == 4) {
+            // Reservar empilha a frente em topo + 1; a troca usa a posicao do topo
+            __m256i destino = codigo == 2 ? _mm256_sub_epi8(topo, uns) : topo;
+            for (int k = 0; k < s->capacidade_pilha; k++) {
+                __m256i m = _mm256_and_si256(ativa, _mm256_cmpeq_epi8(destino, _mm256_set1_epi8((char)k)));
+                if (_mm256_testz_si256(m, m)) continue;
+                trocarLinhasAvx2(s->tipo_fila + b, s->id_fila + b, s->tipo_pilha + k * w + b,
+                                 s->id_pilha + k * w + b, m, codigo == 2);
+            }
+        }
+        if (codigo == 1 || codigo == 2) reabastecerAvx2(s, b, ativa);
+        // ativa vale -1: reservar soma 1 ao topo e usar subtrai 1
+        if (codigo == 2) topo = _mm256_sub_epi8(topo, ativa);
+        if (codigo == 3) topo = _mm256_add_epi8(topo, ativa);
+        _mm256_storeu_si256((__m256i *)(s->topo + b), topo);
+    }
+}
+
+
+// --- 4. Nucleo SSE4.1 (16 sessoes por passo) ---
+// O mesmo do AVX2 com metade da largura: 2 sessoes por registrador nos IDs e no gerador.
+
+ALVO_SSE4 static inline __m128i mascaraGrupoSse4(const uint8_t *bytes, int g) {
+    int16_t q;
+    memcpy(&q, bytes + 2 * g, sizeof(q));
+    return _mm_cvtepi8_epi64(_mm_cvtsi32_si128(q));
+}
+
+ALVO_SSE4 static inline __m128i rotlSse4(__m128i x, int k) {
+    return _mm_or_si128(_mm_slli_epi64(x, k), _mm_srli_epi64(x, 64 - k));
+}
+
+ALVO_SSE4 static inline __m128i sortearTiposSse4(uint64_t *gerador, size_t w, __m128i ativa) {
+    __m128i s0 = _mm_loadu_si128((const __m128i *)gerador);
+    __m128i s1 = _mm_loadu_si128((const __m128i *)(gerador + w));
+    __m128i s2 = _mm_loadu_si128((const __m128i *)(gerador + 2 * w));
+    __m128i s3 = _mm_loadu_si128((const __m128i *)(gerador + 3 * w));
+
+    __m128i x = rotlSse4(_mm_add_epi64(s1, _mm_slli_epi64(s1, 2)), 7);
+    __m128i sorteado = _mm_add_epi64(x, _mm_slli_epi64(x, 3));
+    __m128i t = _mm_slli_epi64(s1, 17);
+    __m128i n2 = _mm_xor_si128(s2, s0);
+    __m128i n3 = _mm_xor_si128(s3, s1);
+    __m128i n1 = _mm_xor_si128(s1, n2);
+    __m128i n0 = _mm_xor_si128(s0, n3);
+    n2 = _mm_xor_si128(n2, t);
+    n3 = rotlSse4(n3, 45);
+
+    _mm_storeu_si128((__m128i *)gerador, _mm_blendv_epi8(s0, n0, ativa));
+    _mm_storeu_si128((__m128i *)(gerador + w), _mm_blendv_epi8(s1, n1, ativa));
+    _mm_storeu_si128((__m128i *)(gerador + 2 * w), _mm_blendv_epi8(s2, n2, ativa));
+    _mm_storeu_si128((__m128i *)(gerador + 3 * w), _mm_blendv_epi8(s3, n3, ativa));
+
+    __m128i alto = _mm_srli_epi64(sorteado, 32);
+    return _mm_srli_epi64(_mm_mul_epu32(alto, _mm_set1_epi64x(GERADOR_NUM_TIPOS)), 32);
+}
+
+ALVO_SSE4 static inline void trocarLinhasSse4(uint8_t *tipo_a, int64_t *id_a, uint8_t *tipo_b, int64_t *id_b,
+                                              __m128i m, int copiar_so_para_b) {
+    uint8_t bytes[16];
+    __m128i a = _mm_loadu_si128((const __m128i *)tipo_a);
+    __m128i b = _mm_loadu_si128((const __m128i *)tipo_b);
+
+    _mm_storeu_si128((__m128i *)tipo_b, _mm_blendv_epi8(b, a, m));
+    if (!copiar_so_para_b) _mm_storeu_si128((__m128i *)tipo_a, _mm_blendv_epi8(a, b, m));
+    _mm_storeu_si128((__m128i *)bytes, m);
+    for (int g = 0; g < 8; g++) {
+        __m128i m64 = mascaraGrupoSse4(bytes, g);
+        __m128i ia = _mm_loadu_si128((const __m128i *)(id_a + 2 * g));
+        __m128i ib = _mm_loadu_si128((const __m128i *)(id_b + 2 * g));
+        _mm_storeu_si128((__m128i *)(id_b + 2 * g), _mm_blendv_epi8(ib, ia, m64));
+        if (!copiar_so_para_b) _mm_storeu_si128((__m128i *)(id_a + 2 * g), _mm_blendv_epi8(ia, ib, m64));
+    }
+}
+
+ALVO_SSE4 static void reabastecerSse4(SessoesSoA *s, size_t b, __m128i ativa) {
+    size_t w = s->largura;
+    uint32_t ultima = s->limite - 1;
+    uint8_t bytes[16], novos[16];
+
+    for (uint32_t j = 0; j < ultima; j++) {
+        trocarLinhasSse4(s->tipo_fila + (j + 1) * w + b, s->id_fila + (j + 1) * w + b,
+                         s->tipo_fila + j * w + b, s->id_fila + j * w + b, ativa, 1);
+    }
+
+    _mm_storeu_si128((__m128i *)bytes, ativa);
+    int64_t *id_ultima = s->id_fila + ultima * w + b;
+    for (int g = 0; g < 8; g++) {
+        __m128i m64 = mascaraGrupoSse4(bytes, g);
+        __m128i tipos = sortearTiposSse4(s->gerador + b + 2 * g, w, m64);
+        novos[2 * g] = (uint8_t)_mm_extract_epi8(tipos, 0);
+        novos[2 * g + 1] = (uint8_t)_mm_extract_epi8(tipos, 8);
+
+        __m128i id = _mm_loadu_si128((const __m128i *)(s->proximo_id + b + 2 * g));
+        __m128i antigo = _mm_loadu_si128((const __m128i *)(id_ultima + 2 * g));
+        _mm_storeu_si128((__m128i *)(id_ultima + 2 * g), _mm_blendv_epi8(antigo, id, m64));
+        _mm_storeu_si128((__m128i *)(s->proximo_id + b + 2 * g), _mm_sub_epi64(id, m64));
+    }
+    uint8_t *tipo_ultima = s->tipo_fila + ultima * w + b;
+    __m128i antigo = _mm_loadu_si128((const __m128i *)tipo_ultima);
+    __m128i novo = _mm_loadu_si128((const __m128i *)novos);
+    _mm_storeu_si128((__m128i *)tipo_ultima, _mm_blendv_epi8(antigo, novo, ativa));
+}
+
+ALVO_SSE4 static void aplicarSse4(SessoesSoA *s, int codigo, uint8_t *resultado) {
+    size_t w = s->largura;
+    const __m128i uns = _mm_set1_epi8(-1);
+
+    for (size_t b = 0; b < s->n; b += 16) {
+        __m128i topo = _mm_loadu_si128((const __m128i *)(s->topo + b));
+        __m128i falha = _mm_setzero_si128();
+        int codigo_falha = ACAO_OK;
+        if (codigo == 2) {
+            falha = _mm_cmpeq_epi8(topo, _mm_set1_epi8((char)(s->capacidade_pilha - 1)));
+            codigo_falha = ACAO_PILHA_CHEIA;
+        } else if (codigo == 3 || codigo == 4) {
+            falha = _mm_cmpeq_epi8(topo, uns);
+            codigo_falha = ACAO_PILHA_VAZIA;
+        }
+        __m128i ativa = _mm_xor_si128(falha, uns);
+
+        if (resultado) {
+            uint8_t r[16];
+            _mm_storeu_si128((__m128i *)r, _mm_and_si128(falha, _mm_set1_epi8((char)codigo_falha)));
+            memcpy(resultado + b, r, s->n - b < 16 ? s->n - b : 16);
+        }
+
+        if (codigo == 2 || codigo == 4) {
+            __m128i destino = codigo == 2 ? _mm_sub_epi8(topo, uns) : topo;
+            for (int k = 0; k < s->capacidade_pilha; k++) {
+                __m128i m = _mm_and_si128(ativa, _mm_cmpeq_epi8(destino, _mm_set1_epi8((char)k)));
+                if (_mm_testz_si128(m, m)) continue;
+                trocarLinhasSse4(s->tipo_fila + b, s->id_fila + b, s->tipo_pilha + k * w + b,
+                                 s->id_pilha + k * w + b, m, codigo == 2);
+            }
+        }
+        if (codigo == 1 || codigo == 2) reabastecerSse4(s, b, ativa);
+        if (codigo == 2) topo = _mm_sub_epi8(topo, ativa);
+        if (codigo == 3) topo = _mm_add_epi8(topo, ativa);
+        _mm_storeu_si128((__m128i *)(s->topo + b), topo);
+    }
+}
+#endif // SESSOES_X86
+
+
+// --- 5. Escolha do Nucleo ---
+
+/**
+ * @brief O nucleo mais largo que a CPU suporta.
+ */
+ImplementacaoSessoes sessoes_melhorImplementacao(void) {
+#ifdef SESSOES_X86
+    if (__builtin_cpu_supports("avx2")) return SESSOES_AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return SESSOES_SSE4;
+#endif
+    return SESSOES_ESCALAR;
+}
+
+const char *sessoes_nomeImplementacao(ImplementacaoSessoes impl) {
+    static const char *nomes[] = {"escalar", "sse4", "avx2"};
+    return nomes[impl];
+}
+
+/**
+ * @brief Aplica a acao a todas as sessoes com o nucleo pedido (ou o melhor abaixo dele
+ * que a CPU suporta).
+ * @param resultado Recebe o ResultadoAcao de cada sessao (n bytes); pode ser NULL.
+ */
+void sessoes_aplicarCom(SessoesSoA *s, int codigo, uint8_t *resultado, ImplementacaoSessoes impl) {
+    ImplementacaoSessoes melhor = sessoes_melhorImplementacao();
+    if (impl > melhor) impl = melhor;
+    if (codigo < 1 || codigo > 4) impl = SESSOES_ESCALAR; // Troca em bloco e codigos invalidos
+
+#ifdef SESSOES_X86
+    if (impl == SESSOES_AVX2) {
+        aplicarAvx2(s, codigo, resultado);
+        return;
+    }
+    if (impl == SESSOES_SSE4) {
+        aplicarSse4(s, codigo, resultado);
+        return;
+    }
+#endif
+    aplicarEscalar(s, codigo, resultado);
+}
+
+/**
+ * @brief Aplica a acao a todas as sessoes com o melhor nucleo da CPU.
+ */
+void sessoes_aplicar(SessoesSoA *s, int codigo, uint8_t *resultado) {
+    sessoes_aplicarCom(s, codigo, resultado, SESSOES_AVX2);
+}
@@ -0,0 +1,60 @@
+// Muitas sessoes de Fila/Pilha em estrutura de arrays (SoA), para aplicar a mesma acao
+// a todas de uma vez (avaliar uma politica em milhares de sessoes em passo unico).
+//
+// Todas as sessoes tem a mesma fila (limite) e a mesma pilha (capacidade fixa) e usam o
+// gerador uniforme com IDs proprios. A fila de uma sessao do mestre esta sempre cheia
+// (jogar e reservar reabastecem, as trocas nao mudam o tamanho), entao ela e guardada
+// a partir da frente: a linha j tem a j-esima peca de cada sessao. Jogar desloca as
+// linhas e poe a peca nova na ultima, sem contador de cabeca nem acesso indireto. A
+// pilha e guardada da base para o topo; cada acao compara o topo de cada sessao com
+// cada posicao. Tipos (codigos 0-6, um byte), IDs, topos, proximo_id e as quatro
+// palavras do xoshiro256** ficam em arrays separados, um elemento por sessao.
+//
+// As acoes 1-4 tem nucleos AVX2 (32 sessoes por passo) e SSE4.1 (16), escolhidos em
+// tempo de execucao; uma sessao onde a acao falha (pilha cheia ou vazia) fica de fora
+// pela mascara e recebe o mesmo ResultadoAcao que executarAcao() daria. A acao 5 e
+// maquinas sem essas extensoes usam o caminho escalar, que percorre as mesmas linhas.
+// Os tres caminhos dao exatamente o estado de executarAcao() com a mesma semente
+// (sessoes_exportar + hashEstado conferem, ver bench.c).
+
+#ifndef SESSOES_H
+#define SESSOES_H
+
+#include <stdint.h>
+
+#include "pecas.h"
+#include "arena.h"
+
+#define SESSOES_BLOCO 32     // Sessoes por passo do nucleo mais largo (AVX2, um byte por sessao)
+#define SESSOES_MAX_FILA 32
+#define SESSOES_MAX_PILHA 16
+
+typedef enum {
+    SESSOES_ESCALAR = 0,
+    SESSOES_SSE4 = 1,
+    SESSOES_AVX2 = 2
+} ImplementacaoSessoes;
+
+typedef struct {
+    uint32_t n;            // Sessoes em uso
+    uint32_t largura;      // n arredondado para SESSOES_BLOCO: tamanho de cada linha
+    uint32_t limite;       // Pecas da fila de cada sessao
+    int capacidade_pilha;
+    uint8_t *tipo_fila;    // tipo_fila[j * largura + i]: j-esima peca da sessao i a partir da frente
+    int64_t *id_fila;
+    uint8_t *tipo_pilha;   // tipo_pilha[k * largura + i]: posicao k da pilha (0 = base)
+    int64_t *id_pilha;
+    int8_t *topo;          // Topo de cada pilha (-1: vazia)
+    int64_t *proximo_id;
+    uint64_t *gerador;     // gerador[w * largura + i]: palavra w do xoshiro da sessao i
+} SessoesSoA;
+
+int sessoes_criar(SessoesSoA *s, Arena *arena, uint32_t n, uint32_t limite, int capacidade_pilha);
+void sessoes_iniciar(SessoesSoA *s, uint32_t i, uint64_t semente);
+void sessoes_exportar(const SessoesSoA *s, uint32_t i, Fila *f, Pilha *p);
+ImplementacaoSessoes sessoes_melhorImplementacao(void);
+const char *sessoes_nomeImplementacao(ImplementacaoSessoes impl);
+void sessoes_aplicarCom(SessoesSoA *s, int codigo, uint8_t *resultado, ImplementacaoSessoes impl);
+void sessoes_aplicar(SessoesSoA *s, int codigo, uint8_t *resultado);
+
+#endif // SESSOES_H
@@ -0,0 +1,798 @@
+// Motor de simulacao: milhares de sessoes independentes de Fila/Pilha em paralelo.
+//
+// Cada sessao tem a sua propria fonte de pecas (gerador e contador de IDs) e aplica
+// uma sequencia de acoes com as mesmas funcoes de acao do nucleo (pecas.h). As sessoes sao
+// divididas em blocos; cada thread comeca pelos seus blocos e, ao termina-los,
+// rouba blocos ainda nao iniciados das outras (work stealing).
+//
+// Com --compacto as sessoes ficam guardadas no formato SessaoCompacta (24 bytes) e
+// sao expandidas em um rascunho da thread apenas enquanto suas acoes sao aplicadas.
+// Nesse formato, --salvar grava todas as sessoes em um unico arquivo ao final e
+// --carregar continua a partir dele, sem recriar as sessoes nem repetir passos.
+//
+// No formato normal as pilhas de reserva vem de arenas (arena.h), sem malloc por
+// sessao: todas sao criadas na arena da thread principal e, com --pilha-cresce, cada
+// thread faz crescer as pilhas que simula na sua propria arena. Destruir as sessoes
+// so reinicia as arenas, que sao reaproveitadas na proxima rodada de --escalonamento.
+//
+// Com --ids-unicos todas as sessoes tiram os IDs de um unico AlocadorIds (blocos de
+// BLOCO_IDS por sessao): os IDs sao unicos no processo inteiro, mas passam a depender
+// da ordem em que as threads reservam os blocos, entao o resumo so se repete com -t 1.
+//
+// Compilar: make simulacao
+// Uso:      simulacao [-s sessoes] [-p passos] [-t threads] [--fila N] [--pilha N]
+//                     [--pilha-cresce] [--ids-unicos] [--semente S] [--saco7]
+//                     [--acoes arquivo] [--escalonamento] [--compacto] [--salvar arquivo]
+//                     [--carregar arquivo] [--estatisticas arquivo]
+
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "pecas.h"
+#include "arena.h"
+#include "compacta.h"
+#include "estado.h"
+#include "estatisticas.h"
+
+// Sessoes por bloco de trabalho (unidade de roubo entre threads)
+#define SESSOES_POR_BLOCO 256
+
+// Limite de threads do pool
+#define MAX_THREADS 256
+
+// Fila do formato compacto (COMPACTA_SLOTS_FILA pecas em 8 posicoes de armazenamento)
+#define CAP_FILA_COMPACTA COMPACTA_SLOTS_FILA
+#define POSICOES_FILA_COMPACTA 8 // fila_tamanhoArmazenamento(CAP_FILA_COMPACTA)
+
+// Arquivo de sessoes salvas (formato compacto): cabecalho, os vetores SessaoCompacta,
+// GeradorPecas e politicas de todas as sessoes, e por fim cada sessao expandida
+// (politica seguida do estado no formato de serializarEstado, ver estado.h).
+#define LOTE_MAGICO "TTRSLOT1"
+#define LOTE_VERSAO 1
+
+// --- Estruturas da Simulacao ---
+
+// Estado completo de uma sessao simulada (formato normal)
+typedef struct {
+    Fila fila;
+    Pilha pilha;
+    FontePecas fonte;   // Pecas e IDs proprios da sessao
+    uint64_t politica;  // Estado (splitmix64) que sorteia as acoes quando nao ha roteiro
+} SessaoSimulada;
+
+// Sessao que nao coube no formato compacto (ID antigo demais na pilha, por exemplo).
+// Fica em uma tabela lateral e o seu SessaoCompacta guarda apenas o indice nela.
+typedef struct {
+    SessaoSimulada sessao;
+    Peca armazenamento[POSICOES_FILA_COMPACTA];
+    Peca armazenamento_pilha[COMPACTA_SLOTS_PILHA];
+} SessaoExpandida;
+
+// Faixa de blocos de uma thread. 'proximo' e disputado por quem rouba, entao
+// cada faixa fica em uma linha de cache propria.
+typedef struct {
+    _Alignas(TAM_LINHA_CACHE) _Atomic long proximo;
+    long fim;
+} FaixaTrabalho;
+
+typedef struct {
+    long num_sessoes;
+    long passos;
+    const char *roteiro;    // Acoes '1'-'5' aplicadas em todas as sessoes (ou NULL)
+    long tam_roteiro;
+    int num_threads;
+    int compacto;
+    int capacidade_pilha;
+    int pilha_cresce;
+
+    // Formato normal
+    SessaoSimulada *sessoes;
+    Peca *armazenamento;     // Filas de todas as sessoes em um unico bloco
+    Arena arenas[MAX_THREADS]; // Pilhas: arenas[0] na criacao, arenas[t] no crescimento pela thread t
+
+    // Formato compacto: vetores paralelos indexados pela sessao
+    SessaoCompacta *compactas;
+    GeradorPecas *geradores;
+    uint64_t *politicas;
+    SessaoExpandida **expandidas;
+    long num_expandidas;
+    long cap_expandidas;
+    pthread_mutex_t trava_expandidas;
+
+    AlocadorIds *ids;        // IDs compartilhados (--ids-unicos) ou NULL
+    FaixaTrabalho faixas[MAX_THREADS];
+} Simulacao;
+
+typedef struct {
+    char magico[8];          // LOTE_MAGICO (sem o '\0')
+    uint32_t versao;
+    uint32_t reservado;
+    uint64_t num_sessoes;
+    uint64_t num_expandidas;
+} CabecalhoLote;
+
+typedef struct {
+    Simulacao *sim;
+    int indice;
+    long blocos_roubados;
+    uint64_t acoes;
+    uint64_t falhas;
+    SessaoSimulada rascunho;                    // Sessao compacta em uso, expandida
+    Peca armazenamento[POSICOES_FILA_COMPACTA];
+    Peca armazenamento_pilha[COMPACTA_SLOTS_PILHA];
+} Trabalhador;
+
+
+// --- 1. Sessoes ---
+
+/**
+ * @brief Sorteia um codigo de acao (1-5) com splitmix64.
+ */
+static int sortearAcao(uint64_t *estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (int)(((z >> 32) * 5) >> 32) + 1;
+}
+
+/**
+ * @brief Prepara uma sessao com fila cheia sobre o armazenamento dado; a pilha ja
+ * deve estar criada. Cada sessao tem semente propria (semente + indice).
+ */
+static void prepararSessao(SessaoSimulada *s, Peca *armazenamento, uint32_t limite_fila,
+                           uint64_t semente, ModoGerador modo, AlocadorIds *ids) {
+    inicializarFonte(&s->fonte, semente, modo);
+    if (ids) usarAlocadorIds(&s->fonte, ids);
+    s->politica = ~semente;
+    criarFilaEm(&s->fila, armazenamento, limite_fila);
+    s->fila.fonte = &s->fonte;
+    inicializarPilha(&s->pilha);
+    preencherFila(&s->fila);
+}
+
+/**
+ * @brief Cria todas as sessoes no formato escolhido.
+ * @return 1 em caso de sucesso, 0 se faltou memoria.
+ */
+static int criarSessoes(Simulacao *sim, uint32_t limite_fila, uint64_t semente, ModoGerador modo) {
+    long n = sim->num_sessoes;
+
+    if (!sim->compacto) {
+        uint32_t posicoes = fila_tamanhoArmazenamento(limite_fila);
+        if (sim->ids) inicializarAlocadorIds(sim->ids, 0); // Cada rodada recomeca do ID 0
+        sim->sessoes = malloc((size_t)n * sizeof(SessaoSimulada));
+        sim->armazenamento = malloc((size_t)n * posicoes * sizeof(Peca));
+        if (!sim->sessoes || !sim->armazenamento) return 0;
+        for (long i = 0; i < n; i++) {
+            if (!criarPilha(&sim->sessoes[i].pilha, &sim->arenas[0], sim->capacidade_pilha, sim->pilha_cresce)) {
+                return 0;
+            }
+            prepararSessao(&sim->sessoes[i], sim->armazenamento + (size_t)i * posicoes,
+                           limite_fila, semente + (uint64_t)i, modo, sim->ids);
+        }
+        return 1;
+    }
+
+    sim->compactas = malloc((size_t)n * sizeof(SessaoCompacta));
+    sim->geradores = malloc((size_t)n * sizeof(GeradorPecas));
+    sim->politicas = malloc((size_t)n * sizeof(uint64_t));
+    if (!sim->compactas || !sim->geradores || !sim->politicas) return 0;
+    sim->expandidas = NULL;
+    sim->num_expandidas = 0;
+    sim->cap_expandidas = 0;
+    pthread_mutex_init(&sim->trava_expandidas, NULL);
+
+    SessaoSimulada s;
+    Peca armazenamento[POSICOES_FILA_COMPACTA];
+    Peca armazenamento_pilha[COMPACTA_SLOTS_PILHA];
+    criarPilhaEm(&s.pilha, armazenamento_pilha, COMPACTA_SLOTS_PILHA);
+    for (long i = 0; i < n; i++) {
+        prepararSessao(&s, armazenamento, CAP_FILA_COMPACTA, semente + (uint64_t)i, modo, NULL);
+        compactarSessao(&sim->compactas[i], &s.fila, &s.pilha); // Sempre cabe: IDs recem-gerados
+        sim->geradores[i] = s.fonte.gerador;
+        sim->politicas[i] = s.politica;
+    }
+    return 1;
+}
+
+/**
+ * @brief Libera as sessoes. As pilhas do formato normal somem de uma vez com o
+ * reinicio das arenas, que guardam os blocos para a proxima criacao.
+ */
+static void destruirSessoes(Simulacao *sim) {
+    free(sim->sessoes);
+    free(sim->armazenamento);
+    for (int i = 0; i < MAX_THREADS; i++) arena_reiniciar(&sim->arenas[i]);
+    free(sim->compactas);
+    free(sim->geradores);
+    free(sim->politicas);
+    if (sim->compacto) {
+        for (long i = 0; i < sim->num_expandidas; i++) free(sim->expandidas[i]);
+        free(sim->expandidas);
+        pthread_mutex_destroy(&sim->trava_expandidas);
+    }
+    sim->sessoes = NULL;
+    sim->armazenamento = NULL;
+    sim->compactas = NULL;
+    sim->geradores = NULL;
+    sim->politicas = NULL;
+    sim->expandidas = NULL;
+}
+
+/**
+ * @brief Aplica todos os passos a uma sessao e acumula os contadores na thread.
+ */
+static void simularSessao(const Simulacao *sim, Trabalhador *t, SessaoSimulada *s) {
+    uint64_t falhas = 0;
+    if (sim->roteiro) {
+        for (long k = 0; k < sim->passos; k++) {
+            int codigo = sim->roteiro[k % sim->tam_roteiro] - '0';
+            falhas += !aplicarAcao(codigo, &s->fila, &s->pilha);
+        }
+    } else {
+        for (long k = 0; k < sim->passos; k++) {
+            falhas += !aplicarAcao(sortearAcao(&s->politica), &s->fila, &s->pilha);
+        }
+    }
+    t->acoes += (uint64_t)sim->passos;
+    t->falhas += falhas;
+}
+
+/**
+ * @brief Busca uma sessao da tabela lateral pelo indice guardado no formato compacto.
+ */
+static SessaoExpandida *sessaoExpandida(Simulacao *sim, uint32_t indice) {
+    pthread_mutex_lock(&sim->trava_expandidas);
+    SessaoExpandida *e = sim->expandidas[indice];
+    pthread_mutex_unlock(&sim->trava_expandidas);
+    return e;
+}
+
+/**
+ * @brief Move para a tabela lateral uma sessao que nao coube no formato compacto.
+ */
+static void expandirDefinitivo(Simulacao *sim, SessaoCompacta *c, const SessaoSimulada *s) {
+    SessaoExpandida *e = malloc(sizeof(SessaoExpandida));
+    if (!e) {
+        fprintf(stderr, "Sem memoria para sessao expandida.\n");
+        exit(1);
+    }
+    e->sessao = *s;
+    memcpy(e->armazenamento, s->fila.elementos, sizeof(e->armazenamento));
+    e->sessao.fila.elementos = e->armazenamento;
+    e->sessao.fila.fonte = &e->sessao.fonte;
+    memcpy(e->armazenamento_pilha, s->pilha.elementos, sizeof(e->armazenamento_pilha));
+    e->sessao.pilha.elementos = e->armazenamento_pilha;
+
+    pthread_mutex_lock(&sim->trava_expandidas);
+    if (sim->num_expandidas == sim->cap_expandidas) {
+        sim->cap_expandidas = sim->cap_expandidas ? sim->cap_expandidas * 2 : 64;
+        sim->expandidas = realloc(sim->expandidas, (size_t)sim->cap_expandidas * sizeof(SessaoExpandida *));
+        if (!sim->expandidas) {
+            fprintf(stderr, "Sem memoria para sessao expandida.\n");
+            exit(1);
+        }
+    }
+    c->proximo_id = (uint32_t)sim->num_expandidas;
+    sim->expandidas[sim->num_expandidas++] = e;
+    pthread_mutex_unlock(&sim->trava_expandidas);
+    c->cabecalho = (uint32_t)COMPACTA_EXPANDIDA << 24;
+}
+
+/**
+ * @brief Expande a sessao i no rascunho da thread (ou usa a tabela lateral), aplica
+ * os passos e compacta de volta.
+ */
+static void simularCompacta(Simulacao *sim, Trabalhador *t, long i) {
+    SessaoCompacta *c = &sim->compactas[i];
+
+    if (compacta_tamanhoFila(c) == COMPACTA_EXPANDIDA) {
+        simularSessao(sim, t, &sessaoExpandida(sim, c->proximo_id)->sessao);
+        return;
+    }
+
+    SessaoSimulada *s = &t->rascunho;
+    s->fonte.gerador = sim->geradores[i];
+    s->politica = sim->politicas[i];
+    expandirSessao(c, &s->fila, &s->pilha);
+
+    simularSessao(sim, t, s);
+
+    sim->geradores[i] = s->fonte.gerador;
+    sim->politicas[i] = s->politica;
+    if (!compactarSessao(c, &s->fila, &s->pilha)) {
+        expandirDefinitivo(sim, c, s);
+    }
+}
+
+
+// --- 2. Pool de Threads com Roubo de Trabalho ---
+
+/**
+ * @brief Pega o proximo bloco de uma faixa, ou -1 se ela ja foi toda distribuida.
+ */
+static long pegarBloco(FaixaTrabalho *faixa) {
+    if (atomic_load_explicit(&faixa->proximo, memory_order_relaxed) >= faixa->fim) {
+        return -1;
+    }
+    long bloco = atomic_fetch_add_explicit(&faixa->proximo, 1, memory_order_relaxed);
+    return bloco < faixa->fim ? bloco : -1;
+}
+
+static void *lacoTrabalhador(void *arg) {
+    Trabalhador *t = arg;
+    Simulacao *sim = t->sim;
+
+    // Primeiro os proprios blocos, depois os das outras threads, em rodizio
+    for (int k = 0; k < sim->num_threads; k++) {
+        FaixaTrabalho *faixa = &sim->faixas[(t->indice + k) % sim->num_threads];
+        long bloco;
+        while ((bloco = pegarBloco(faixa)) >= 0) {
+            long inicio = bloco * SESSOES_POR_BLOCO;
+            long fim = inicio + SESSOES_POR_BLOCO;
+            if (fim > sim->num_sessoes) fim = sim->num_sessoes;
+            for (long i = inicio; i < fim; i++) {
+                if (sim->compacto) {
+                    simularCompacta(sim, t, i);
+                } else {
+                    // Se a pilha crescer, o armazenamento novo sai da arena desta thread
+                    SessaoSimulada *s = &sim->sessoes[i];
+                    if (s->pilha.crescer) s->pilha.crescer = &sim->arenas[t->indice];
+                    simularSessao(sim, t, s);
+                }
+            }
+            if (k > 0) t->blocos_roubados++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Prepara o rascunho de uma thread (fila de 5 e pilha de 3 sobre o armazenamento
+ * da propria thread).
+ */
+static void prepararTrabalhador(Trabalhador *t, Simulacao *sim, int indice) {
+    t->sim = sim;
+    t->indice = indice;
+    t->blocos_roubados = 0;
+    t->acoes = 0;
+    t->falhas = 0;
+    inicializarFonte(&t->rascunho.fonte, 0, GERADOR_UNIFORME); // O gerador vem de cada sessao
+    criarFilaEm(&t->rascunho.fila, t->armazenamento, CAP_FILA_COMPACTA);
+    t->rascunho.fila.fonte = &t->rascunho.fonte;
+    criarPilhaEm(&t->rascunho.pilha, t->armazenamento_pilha, COMPACTA_SLOTS_PILHA);
+}
+
+/**
+ * @brief Distribui os blocos em faixas contiguas, uma por thread, e roda o pool.
+ * @return Total de blocos roubados entre threads.
+ */
+static long executarSimulacao(Simulacao *sim, uint64_t *acoes, uint64_t *falhas) {
+    pthread_t threads[MAX_THREADS];
+    static Trabalhador trabalhadores[MAX_THREADS];
+    long blocos = (sim->num_sessoes + SESSOES_POR_BLOCO - 1) / SESSOES_POR_BLOCO;
+    long roubados = 0;
+
+    for (int i = 0; i < sim->num_threads; i++) {
+        atomic_init(&sim->faixas[i].proximo, blocos * i / sim->num_threads);
+        sim->faixas[i].fim = blocos * (i + 1) / sim->num_threads;
+    }
+    for (int i = 0; i < sim->num_threads; i++) {
+        prepararTrabalhador(&trabalhadores[i], sim, i);
+        if (i > 0) pthread_create(&threads[i], NULL, lacoTrabalhador, &trabalhadores[i]);
+    }
+    lacoTrabalhador(&trabalhadores[0]); // A thread principal tambem trabalha
+    *acoes = 0;
+    *falhas = 0;
+    for (int i = 0; i < sim->num_threads; i++) {
+        if (i > 0) pthread_join(threads[i], NULL);
+        roubados += trabalhadores[i].blocos_roubados;
+        *acoes += trabalhadores[i].acoes;
+        *falhas += trabalhadores[i].falhas;
+    }
+    return roubados;
+}
+
+
+// --- 3. Relatorio ---
+
+/**
+ * @brief Combina os resumos de todas as sessoes; nao depende do numero de threads
+ * nem do formato (normal ou compacto).
+ */
+static uint64_t resumoSimulacao(Simulacao *sim) {
+    uint64_t resumo = 0;
+    Trabalhador t;
+    prepararTrabalhador(&t, sim, 0);
+
+    for (long i = 0; i < sim->num_sessoes; i++) {
+        SessaoSimulada *s;
+        if (!sim->compacto) {
+            s = &sim->sessoes[i];
+        } else if (compacta_tamanhoFila(&sim->compactas[i]) == COMPACTA_EXPANDIDA) {
+            s = &sim->expandidas[sim->compactas[i].proximo_id]->sessao;
+        } else {
+            s = &t.rascunho;
+            expandirSessao(&sim->compactas[i], &s->fila, &s->pilha);
+        }
+        resumo ^= hashEstado(&s->fila, &s->pilha) * (2 * (uint64_t)i + 1);
+    }
+    return resumo;
+}
+
+static char *lerRoteiro(const char *caminho, long *tamanho) {
+    FILE *arq = fopen(caminho, "r");
+    if (!arq) {
+        perror(caminho);
+        return NULL;
+    }
+    long cap = 1 << 16, n = 0;
+    char *roteiro = malloc((size_t)cap);
+    int c;
+    while (roteiro && (c = fgetc(arq)) != EOF) {
+        if (c < '1' || c > '5') continue;
+        if (n == cap) {
+            cap *= 2;
+            roteiro = realloc(roteiro, (size_t)cap);
+            if (!roteiro) break;
+        }
+        roteiro[n++] = (char)c;
+    }
+    fclose(arq);
+    if (roteiro && n == 0) {
+        fprintf(stderr, "%s: nenhuma acao (1-5) encontrada.\n", caminho);
+        free(roteiro);
+        return NULL;
+    }
+    *tamanho = n;
+    return roteiro;
+}
+
+
+// --- 4. Sessoes Salvas em Lote ---
+
+/**
+ * @brief Grava todas as sessoes (formato compacto) em um arquivo.
+ * Os vetores principais vao em um unico writev().
+ * @return 1 em caso de sucesso, 0 caso contrario.
+ */
+static int salvarSessoes(Simulacao *sim, const char *caminho) {
+    CabecalhoLote cab;
+    size_t n = (size_t)sim->num_sessoes;
+    size_t tam_expandidas = 0;
+    uint8_t *expandidas = NULL;
+
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magico, LOTE_MAGICO, sizeof(cab.magico));
+    cab.versao = LOTE_VERSAO;
+    cab.num_sessoes = n;
+    cab.num_expandidas = (uint64_t)sim->num_expandidas;
+
+    for (long i = 0; i < sim->num_expandidas; i++) {
+        SessaoSimulada *s = &sim->expandidas[i]->sessao;
+        tam_expandidas += sizeof(uint64_t) + estado_tamanhoSalvo(&s->fila, &s->pilha);
+    }
+    if (tam_expandidas) {
+        expandidas = malloc(tam_expandidas);
+        if (!expandidas) return 0;
+        size_t usado = 0;
+        for (long i = 0; i < sim->num_expandidas; i++) {
+            SessaoSimulada *s = &sim->expandidas[i]->sessao;
+            memcpy(expandidas + usado, &s->politica, sizeof(uint64_t));
+            usado += sizeof(uint64_t);
+            usado += serializarEstado(expandidas + usado, &s->fila, &s->pilha);
+        }
+    }
+
+    int fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(caminho);
+        free(expandidas);
+        return 0;
+    }
+    struct iovec partes[5] = {
+        { &cab, sizeof(cab) },
+        { sim->compactas, n * sizeof(SessaoCompacta) },
+        { sim->geradores, n * sizeof(GeradorPecas) },
+        { sim->politicas, n * sizeof(uint64_t) },
+        { expandidas, tam_expandidas },
+    };
+    size_t total = 0;
+    for (int i = 0; i < 5; i++) total += partes[i].iov_len;
+    ssize_t escritos = writev(fd, partes, 5);
+    int ok = (escritos == (ssize_t)total);
+    if (!ok) perror(caminho);
+    if (close(fd) != 0) ok = 0;
+    free(expandidas);
+    return ok;
+}
+
+/**
+ * @brief Le o cabecalho de um arquivo de sessoes salvas.
+ * @return 1 se o arquivo e valido (cabecalho em 'cab'), 0 caso contrario.
+ */
+static int lerCabecalhoLote(int fd, CabecalhoLote *cab) {
+    return pread(fd, cab, sizeof(*cab), 0) == (ssize_t)sizeof(*cab) &&
+           memcmp(cab->magico, LOTE_MAGICO, sizeof(cab->magico)) == 0 && cab->versao == LOTE_VERSAO &&
+           cab->num_sessoes > 0 && cab->num_sessoes <= LONG_MAX;
+}
+
+/**
+ * @brief Confere a sessao i lida do arquivo: o gerador, e na forma compacta os tamanhos
+ * e os tipos dos slots usados; uma sessao expandida precisa apontar para uma entrada
+ * da tabela lateral ja carregada.
+ */
+static int sessaoCarregadaValida(const Simulacao *sim, size_t i) {
+    const SessaoCompacta *c = &sim->compactas[i];
+    int tamanho_fila = compacta_tamanhoFila(c);
+
+    if (!gerador_valido(&sim->geradores[i])) return 0;
+    if (tamanho_fila == COMPACTA_EXPANDIDA) return c->proximo_id < (uint64_t)sim->num_expandidas;
+    if (tamanho_fila > COMPACTA_SLOTS_FILA) return 0;
+    for (int slot = 0; slot < tamanho_fila; slot++) {
+        if (compacta_tipo(c, slot) >= GERADOR_NUM_TIPOS) return 0;
+    }
+    for (int k = 0; k < compacta_tamanhoPilha(c); k++) {
+        if (compacta_tipo(c, COMPACTA_SLOTS_FILA + k) >= GERADOR_NUM_TIPOS) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Recria as sessoes gravadas por salvarSessoes(); define sim->num_sessoes.
+ * Os vetores principais sao lidos com um unico readv().
+ * @return 1 em caso de sucesso, 0 caso contrario.
+ */
+static int carregarSessoes(Simulacao *sim, const char *caminho) {
+    CabecalhoLote cab;
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        perror(caminho);
+        return 0;
+    }
+    if (!lerCabecalhoLote(fd, &cab)) {
+        fprintf(stderr, "%s: nao e um arquivo de sessoes da versao %d.\n", caminho, LOTE_VERSAO);
+        close(fd);
+        return 0;
+    }
+    size_t n = (size_t)cab.num_sessoes;
+    sim->num_sessoes = (long)n;
+    sim->compactas = malloc(n * sizeof(SessaoCompacta));
+    sim->geradores = malloc(n * sizeof(GeradorPecas));
+    sim->politicas = malloc(n * sizeof(uint64_t));
+    sim->expandidas = NULL;
+    sim->num_expandidas = 0;
+    sim->cap_expandidas = 0;
+    pthread_mutex_init(&sim->trava_expandidas, NULL);
+    if (!sim->compactas || !sim->geradores || !sim->politicas) {
+        close(fd);
+        return 0;
+    }
+
+    struct iovec partes[3] = {
+        { sim->compactas, n * sizeof(SessaoCompacta) },
+        { sim->geradores, n * sizeof(GeradorPecas) },
+        { sim->politicas, n * sizeof(uint64_t) },
+    };
+    size_t principal = partes[0].iov_len + partes[1].iov_len + partes[2].iov_len;
+    off_t fim = lseek(fd, 0, SEEK_END);
+    int ok = fim >= (off_t)(sizeof(cab) + principal) && lseek(fd, sizeof(cab), SEEK_SET) == (off_t)sizeof(cab) &&
+             readv(fd, partes, 3) == (ssize_t)principal;
+
+    // Sessoes expandidas: na mesma ordem da tabela lateral (os indices nao mudam)
+    size_t tam_expandidas = ok ? (size_t)fim - sizeof(cab) - principal : 0;
+    uint8_t *expandidas = tam_expandidas ? malloc(tam_expandidas) : NULL;
+    if (tam_expandidas && (!expandidas || read(fd, expandidas, tam_expandidas) != (ssize_t)tam_expandidas)) {
+        ok = 0;
+    }
+    size_t usado = 0;
+    for (uint64_t i = 0; ok && i < cab.num_expandidas; i++) {
+        SessaoExpandida *e = malloc(sizeof(SessaoExpandida));
+        if (!e || usado + sizeof(uint64_t) > tam_expandidas) {
+            free(e);
+            ok = 0;
+            break;
+        }
+        memcpy(&e->sessao.politica, expandidas + usado, sizeof(uint64_t));
+        usado += sizeof(uint64_t);
+        inicializarFonte(&e->sessao.fonte, 0, GERADOR_UNIFORME); // Gerador e IDs vem do estado
+        criarFilaEm(&e->sessao.fila, e->armazenamento, CAP_FILA_COMPACTA);
+        e->sessao.fila.fonte = &e->sessao.fonte;
+        criarPilhaEm(&e->sessao.pilha, e->armazenamento_pilha, COMPACTA_SLOTS_PILHA);
+        size_t consumidos = desserializarEstado(expandidas + usado, tam_expandidas - usado,
+                                                &e->sessao.fila, &e->sessao.pilha);
+        if (!consumidos) {
+            free(e);
+            ok = 0;
+            break;
+        }
+        usado += consumidos;
+        if (sim->num_expandidas == sim->cap_expandidas) {
+            sim->cap_expandidas = sim->cap_expandidas ? sim->cap_expandidas * 2 : 64;
+            SessaoExpandida **tabela = realloc(sim->expandidas, (size_t)sim->cap_expandidas * sizeof(SessaoExpandida *));
+            if (!tabela) {
+                free(e);
+                ok = 0;
+                break;
+            }
+            sim->expandidas = tabela;
+        }
+        sim->expandidas[sim->num_expandidas++] = e;
+    }
+    for (size_t i = 0; ok && i < n; i++) {
+        ok = sessaoCarregadaValida(sim, i);
+    }
+    if (!ok) fprintf(stderr, "%s: arquivo de sessoes incompleto.\n", caminho);
+    free(expandidas);
+    close(fd);
+    return ok;
+}
+
+
+// --- Funcao Principal ---
+
+int main(int argc, char *argv[]) {
+    static AlocadorIds ids_compartilhados;
+    Simulacao sim = {0};
+    uint32_t limite_fila = CAP_FILA;
+    uint64_t semente = 1;
+    ModoGerador modo = GERADOR_UNIFORME;
+    int escalonamento = 0;
+    const char *arquivo_salvar = NULL;
+    const char *arquivo_carregar = NULL;
+    const char *arquivo_estatisticas = NULL;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    sim.num_sessoes = 100000;
+    sim.passos = 1000;
+    sim.num_threads = cpus > 0 ? (int)cpus : 1;
+    sim.capacidade_pilha = CAP_PILHA;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            sim.num_sessoes = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            sim.passos = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            sim.num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fila") == 0 && i + 1 < argc) {
+            limite_fila = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--pilha") == 0 && i + 1 < argc) {
+            sim.capacidade_pilha = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pilha-cresce") == 0) {
+            sim.pilha_cresce = 1;
+        } else if (strcmp(argv[i], "--ids-unicos") == 0) {
+            sim.ids = &ids_compartilhados;
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--saco7") == 0) {
+            modo = GERADOR_SACO7;
+        } else if (strcmp(argv[i], "--acoes") == 0 && i + 1 < argc) {
+            sim.roteiro = lerRoteiro(argv[++i], &sim.tam_roteiro);
+            if (!sim.roteiro) return 1;
+        } else if (strcmp(argv[i], "--escalonamento") == 0) {
+            escalonamento = 1;
+        } else if (strcmp(argv[i], "--compacto") == 0) {
+            sim.compacto = 1;
+        } else if (strcmp(argv[i], "--salvar") == 0 && i + 1 < argc) {
+            arquivo_salvar = argv[++i];
+        } else if (strcmp(argv[i], "--carregar") == 0 && i + 1 < argc) {
+            arquivo_carregar = argv[++i];
+        } else if (strcmp(argv[i], "--estatisticas") == 0 && i + 1 < argc) {
+            arquivo_estatisticas = argv[++i];
+        } else {
+            fprintf(stderr, "Uso: %s [-s sessoes] [-p passos] [-t threads] [--fila N] [--pilha N]\n"
+                            "          [--pilha-cresce] [--ids-unicos] [--semente S] [--saco7]\n"
+                            "          [--acoes arquivo] [--escalonamento] [--compacto] [--salvar arquivo]\n"
+                            "          [--carregar arquivo] [--estatisticas arquivo]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (sim.num_sessoes < 1 || sim.passos < 0 || limite_fila == 0 || sim.capacidade_pilha < 1 ||
+        sim.num_threads < 1 || sim.num_threads > MAX_THREADS) {
+        fprintf(stderr, "Parametros invalidos.\n");
+        return 1;
+    }
+    if (sim.compacto && (limite_fila != CAP_FILA_COMPACTA || sim.capacidade_pilha != COMPACTA_SLOTS_PILHA ||
+                         sim.pilha_cresce)) {
+        fprintf(stderr, "O formato compacto exige fila de %d pecas e pilha fixa de %d.\n", CAP_FILA_COMPACTA,
+                COMPACTA_SLOTS_PILHA);
+        return 1;
+    }
+    if (sim.compacto && sim.ids) {
+        fprintf(stderr, "O formato compacto guarda IDs proprios de cada sessao (sem --ids-unicos).\n");
+        return 1;
+    }
+    if ((arquivo_salvar || arquivo_carregar) && !sim.compacto) {
+        fprintf(stderr, "--salvar e --carregar usam o formato compacto (--compacto).\n");
+        return 1;
+    }
+    if (arquivo_carregar) {
+        // O numero de sessoes vem do arquivo
+        CabecalhoLote cab;
+        int fd = open(arquivo_carregar, O_RDONLY);
+        if (fd < 0 || !lerCabecalhoLote(fd, &cab)) {
+            fprintf(stderr, "%s: nao e um arquivo de sessoes da versao %d.\n", arquivo_carregar, LOTE_VERSAO);
+            if (fd >= 0) close(fd);
+            return 1;
+        }
+        close(fd);
+        sim.num_sessoes = (long)cab.num_sessoes;
+    }
+
+    if (arquivo_estatisticas && !iniciarEstatisticas(arquivo_estatisticas)) {
+        arquivo_estatisticas = NULL;
+    }
+    size_t bytes_sessao = sim.compacto
+        ? sizeof(SessaoCompacta) + sizeof(GeradorPecas) + sizeof(uint64_t)
+        : sizeof(SessaoSimulada) + (fila_tamanhoArmazenamento(limite_fila) + (size_t)sim.capacidade_pilha) * sizeof(Peca);
+
+    // Com --escalonamento, repete com 1, 2, 4, ... threads ate o numero pedido
+    int max_threads = sim.num_threads;
+    double vazao_uma = 0.0;
+    printf("sessoes=%ld passos=%ld fila=%u pilha=%d%s cpus=%ld formato=%s bytes/sessao=%zu\n", sim.num_sessoes,
+           sim.passos, limite_fila, sim.capacidade_pilha, sim.pilha_cresce ? "+" : "", cpus, sim.compacto ? "compacto" : "normal", bytes_sessao);
+    printf("%8s %12s %14s %14s %10s %9s  %s\n", "threads", "tempo(s)", "acoes/s", "acoes/s/thr", "eficiencia", "roubados", "resumo");
+    for (int t = escalonamento ? 1 : max_threads; ; t = (t * 2 < max_threads) ? t * 2 : max_threads) {
+        struct timespec c0, c1;
+        clock_gettime(CLOCK_MONOTONIC, &c0);
+        if (arquivo_carregar) {
+            if (!carregarSessoes(&sim, arquivo_carregar)) return 1;
+        } else if (!criarSessoes(&sim, limite_fila, semente, modo)) {
+            fprintf(stderr, "Sem memoria para %ld sessoes.\n", sim.num_sessoes);
+            return 1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &c1);
+        sim.num_threads = t;
+
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        uint64_t acoes, falhas;
+        long roubados = executarSimulacao(&sim, &acoes, &falhas);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        uint64_t resumo = resumoSimulacao(&sim);
+        double segundos = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+        double vazao = segundos > 0 ? (double)acoes / segundos : 0.0;
+        if (t == 1) vazao_uma = vazao;
+        // Eficiencia: vazao por thread relativa a execucao com uma thread
+        double eficiencia = vazao_uma > 0 ? 100.0 * vazao / (vazao_uma * t) : 100.0;
+        printf("%8d %12.4f %14.0f %14.0f %9.1f%% %9ld  %016llx\n", t, segundos, vazao, vazao / t,
+               eficiencia, roubados, (unsigned long long)resumo);
+        if (t == max_threads) {
+            printf("acoes=%llu falhas=%llu", (unsigned long long)acoes, (unsigned long long)falhas);
+            if (sim.compacto) printf(" expandidas=%ld", sim.num_expandidas);
+            printf("\n");
+            printf("%s: %.2f ms\n", arquivo_carregar ? "carregar" : "criar",
+                   ((c1.tv_sec - c0.tv_sec) + (c1.tv_nsec - c0.tv_nsec) / 1e9) * 1e3);
+            if (arquivo_salvar) {
+                clock_gettime(CLOCK_MONOTONIC, &c0);
+                int ok = salvarSessoes(&sim, arquivo_salvar);
+                clock_gettime(CLOCK_MONOTONIC, &c1);
+                if (!ok) {
+                    fprintf(stderr, "Nao foi possivel salvar as sessoes em %s.\n", arquivo_salvar);
+                    destruirSessoes(&sim);
+                    return 1;
+                }
+                printf("salvar: %.2f ms\n", ((c1.tv_sec - c0.tv_sec) + (c1.tv_nsec - c0.tv_nsec) / 1e9) * 1e3);
+            }
+            destruirSessoes(&sim);
+            break;
+        }
+        destruirSessoes(&sim);
+    }
+
+    for (int i = 0; i < MAX_THREADS; i++) arena_liberar(&sim.arenas[i]);
+    free((void *)sim.roteiro);
+    if (arquivo_estatisticas && !escreverEstatisticas(arquivo_estatisticas)) return 1;
+    return 0;
+}
@@ -0,0 +1,226 @@
+// Tabuleiro com linhas em mascaras de bits (ver tabuleiro.h).
+
+#include <string.h>
+
+#include "tabuleiro.h"
+
+#define BITS_BAIXOS 0x7FFF7FFF7FFF7FFFULL
+#define BITS_ALTOS 0x8000800080008000ULL
+
+/**
+ * @brief Prepara um tabuleiro vazio de largura x altura.
+ * @return 1 em caso de sucesso, 0 se as dimensoes estao fora dos limites.
+ */
+int tabuleiro_inicializar(Tabuleiro *t, int largura, int altura) {
+    if (largura < TABULEIRO_MIN_LARGURA || largura > TABULEIRO_MAX_LARGURA ||
+        altura < TABULEIRO_MIN_ALTURA || altura > TABULEIRO_MAX_ALTURA) {
+        return 0;
+    }
+    t->largura = largura;
+    t->altura = altura;
+    t->vazia = (uint16_t)~((1u << largura) - 1);
+    t->pecas = 0;
+    t->eliminadas = 0;
+    tabuleiro_limpar(t);
+    return 1;
+}
+
+/**
+ * @brief Esvazia todas as linhas (os contadores de pecas e linhas continuam).
+ */
+void tabuleiro_limpar(Tabuleiro *t) {
+    for (int i = 0; i < TABULEIRO_MAX_ALTURA + TABULEIRO_LINHAS_PECA; i++) t->linhas[i] = t->vazia;
+    t->ocupadas = 0;
+}
+
+/**
+ * @brief Coluna em que uma peca entra no tabuleiro (centralizada).
+ */
+int tabuleiro_colunaEntrada(const Tabuleiro *t, int tipo, int rotacao) {
+    return (t->largura - LARGURA_FORMA[tipo][rotacao]) / 2;
+}
+
+/**
+ * @brief Linha onde a peca para se cair em linha reta na coluna (hard drop).
+ * A queda comeca no topo, ou logo acima do bloco mais alto: as linhas acima de
+ * 'ocupadas' estao vazias e nao precisam ser testadas.
+ * @return A linha do canto inferior da peca, ou -1 se ela nao cabe nem no topo.
+ */
+int tabuleiro_soltar(const Tabuleiro *t, int tipo, int rotacao, int coluna) {
+    int linha = t->altura - ALTURA_FORMA[tipo][rotacao];
+
+    if (t->ocupadas < linha) {
+        linha = t->ocupadas;
+    } else if (!tabuleiro_cabe(t, tipo, rotacao, coluna, linha)) {
+        return -1;
+    }
+    while (linha > 0 && tabuleiro_cabe(t, tipo, rotacao, coluna, linha - 1)) linha--;
+    return linha;
+}
+
+/**
+ * @brief Bit 15 de cada linha de 16 bits da janela que esta completa (0xFFFF).
+ * ~janela zera as linhas completas; o teste de linha nula e feito nas quatro de uma vez.
+ */
+static inline uint64_t linhasCompletas(uint64_t janela) {
+    uint64_t x = ~janela;
+    uint64_t nao_nulas = (((x & BITS_BAIXOS) + BITS_BAIXOS) | x) & BITS_ALTOS;
+    return ~nao_nulas & BITS_ALTOS;
+}
+
+/**
+ * @brief Grava a peca em (coluna, linha), que ja deve caber, e elimina as linhas que
+ * ela completou. So as quatro linhas da peca podem ter ficado completas: elas sao
+ * compactadas e o restante desce com um unico memmove.
+ * @return Quantas linhas foram eliminadas.
+ */
+int tabuleiro_fixar(Tabuleiro *t, int tipo, int rotacao, int coluna, int linha) {
+    uint64_t forma = FORMAS_PECA[tipo][rotacao] << coluna;
+    for (int r = 0; r < TABULEIRO_LINHAS_PECA; r++) {
+        t->linhas[linha + r] |= (uint16_t)(forma >> (16 * r));
+    }
+    if (linha + ALTURA_FORMA[tipo][rotacao] > t->ocupadas) t->ocupadas = linha + ALTURA_FORMA[tipo][rotacao];
+    t->pecas++;
+
+    uint64_t completas = linhasCompletas(tabuleiro_janela(t, linha));
+    if (!completas) return 0;
+
+    int destino = linha;
+    for (int r = 0; r < TABULEIRO_LINHAS_PECA && linha + r < t->ocupadas; r++) {
+        if (!((completas >> (16 * r + 15)) & 1)) t->linhas[destino++] = t->linhas[linha + r];
+    }
+    int acima = linha + TABULEIRO_LINHAS_PECA;
+    if (acima < t->ocupadas) {
+        memmove(&t->linhas[destino], &t->linhas[acima], (size_t)(t->ocupadas - acima) * sizeof(uint16_t));
+        destino += t->ocupadas - acima;
+    }
+    int eliminadas = __builtin_popcountll(completas);
+    while (destino < t->ocupadas) t->linhas[destino++] = t->vazia;
+    t->ocupadas -= eliminadas;
+    t->eliminadas += (uint64_t)eliminadas;
+    return eliminadas;
+}
+
+/**
+ * @brief Solta a peca (tipo 0-6, rotacao 0-3) na coluna e a fixa onde ela parar.
+ * @return Linhas eliminadas, ou -1 se a posicao e invalida ou a peca nao cabe (fim de jogo).
+ */
+int tabuleiro_colocar(Tabuleiro *t, int tipo, int rotacao, int coluna) {
+    if (tipo < 0 || tipo >= GERADOR_NUM_TIPOS || rotacao < 0 || rotacao >= TABULEIRO_ROTACOES ||
+        coluna < 0 || coluna + LARGURA_FORMA[tipo][rotacao] > t->largura) {
+        return -1;
+    }
+    int linha = tabuleiro_soltar(t, tipo, rotacao, coluna);
+    if (linha < 0) return -1;
+    return tabuleiro_fixar(t, tipo, rotacao, coluna, linha);
+}
+
+/**
+ * @brief Coloca uma peca jogada do jeito que ela chega: rotacao 0, na coluna de entrada.
+ * @return Linhas eliminadas, ou -1 se a peca nao cabe (fim de jogo) ou o tipo e desconhecido.
+ */
+int tabuleiro_colocarPeca(Tabuleiro *t, Peca p) {
+    int tipo = tipoIndice(p.nome);
+    if (tipo >= GERADOR_NUM_TIPOS) return -1;
+    return tabuleiro_colocar(t, tipo, 0, tabuleiro_colunaEntrada(t, tipo, 0));
+}
+
+
+// --- Gerador de Colocacoes ---
+
+/**
+ * @brief Altura de cada coluna: linha do bloco mais alto + 1 (0 se vazia).
+ * Desce a partir de 'ocupadas'; cada linha so visita as colunas que ainda nao tinham bloco.
+ */
+void tabuleiro_alturas(const Tabuleiro *t, uint8_t alturas[TABULEIRO_MAX_LARGURA]) {
+    uint16_t colunas = (uint16_t)~t->vazia; // Colunas ainda sem bloco encontrado
+    memset(alturas, 0, TABULEIRO_MAX_LARGURA);
+
+    for (int y = t->ocupadas - 1; y >= 0 && colunas; y--) {
+        unsigned novos = t->linhas[y] & colunas;
+        colunas &= (uint16_t)~novos;
+        while (novos) {
+            alturas[__builtin_ctz(novos)] = (uint8_t)(y + 1);
+            novos &= novos - 1;
+        }
+    }
+}
+
+/**
+ * @brief Todas as colocacoes da peca a partir das alturas das colunas, uma por
+ * rotacao distinta e coluna. A peca para na primeira linha em que alguma de suas
+ * colunas encosta no bloco mais alto: max(alturas[c + i] - PERFIL_BASE[i]).
+ * Coincide com tabuleiro_soltar(); as posicoes em que a peca nao cabe ficam de fora.
+ * @param destino Pelo menos TABULEIRO_MAX_COLOCACOES posicoes.
+ * @return Quantas colocacoes foram escritas.
+ */
+int gerarColocacoesAlturas(const Tabuleiro *t, const uint8_t *alturas, int tipo, Colocacao *destino) {
+    int n = 0;
+
+    for (int rotacao = 0; rotacao < ROTACOES_DISTINTAS[tipo]; rotacao++) {
+        int largura = LARGURA_FORMA[tipo][rotacao];
+        int limite = t->altura - ALTURA_FORMA[tipo][rotacao]; // Maior linha em que a peca cabe
+        const uint8_t *perfil = PERFIL_BASE[tipo][rotacao];
+
+        for (int coluna = 0; coluna + largura <= t->largura; coluna++) {
+            int linha = 0, mais_alta = 0;
+            for (int i = 0; i < largura; i++) {
+                int apoio = alturas[coluna + i] - perfil[i];
+                if (apoio > linha) linha = apoio;
+                if (alturas[coluna + i] > mais_alta) mais_alta = alturas[coluna + i];
+            }
+            // Blocos na faixa de entrada: a peca surge no topo, possivelmente ja abaixo
+            // de algum deles, e so a queda de tabuleiro_soltar da a linha certa
+            if (mais_alta > limite) {
+                linha = tabuleiro_soltar(t, tipo, rotacao, coluna);
+                if (linha < 0) continue;
+            }
+            destino[n].acao = 0;
+            destino[n].tipo = (uint8_t)tipo;
+            destino[n].rotacao = (uint8_t)rotacao;
+            destino[n].coluna = (uint8_t)coluna;
+            destino[n].linha = (uint8_t)linha;
+            n++;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Todas as colocacoes de uma peca (tipo 0-6) no tabuleiro atual.
+ * @param destino Pelo menos TABULEIRO_MAX_COLOCACOES posicoes.
+ */
+int gerarColocacoes(const Tabuleiro *t, int tipo, Colocacao *destino) {
+    uint8_t alturas[TABULEIRO_MAX_LARGURA];
+    tabuleiro_alturas(t, alturas);
+    return gerarColocacoesAlturas(t, alturas, tipo, destino);
+}
+
+/**
+ * @brief Colocacoes das duas pecas que podem ser jogadas agora: a da frente da fila
+ * (acao 1) e a do topo da reserva (acao 3), com as alturas calculadas uma vez so.
+ * @param destino Pelo menos 2 * TABULEIRO_MAX_COLOCACOES posicoes.
+ */
+int gerarColocacoesJogada(const Tabuleiro *t, const Fila *f, const Pilha *p, Colocacao *destino) {
+    uint8_t alturas[TABULEIRO_MAX_LARGURA];
+    int n = 0;
+
+    tabuleiro_alturas(t, alturas);
+    if (!fila_estaVazia(f)) {
+        int tipo = tipoIndice(f->elementos[f->cabeca & f->mascara].nome);
+        if (tipo < GERADOR_NUM_TIPOS) {
+            int k = gerarColocacoesAlturas(t, alturas, tipo, destino);
+            for (int i = 0; i < k; i++) destino[i].acao = 1;
+            n += k;
+        }
+    }
+    if (!pilha_estaVazia(p)) {
+        int tipo = tipoIndice(p->elementos[p->topo].nome);
+        if (tipo < GERADOR_NUM_TIPOS) {
+            int k = gerarColocacoesAlturas(t, alturas, tipo, destino + n);
+            for (int i = 0; i < k; i++) destino[n + i].acao = 3;
+            n += k;
+        }
+    }
+    return n;
+}
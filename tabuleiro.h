@@ -0,0 +1,121 @@
+// Tabuleiro onde as pecas jogadas sao de fato colocadas (ver tabuleiro.c).
+//
+// Cada linha e uma mascara de 16 bits (bit c = coluna c) e as colunas alem da largura
+// ficam sempre marcadas, como uma parede: uma linha esta completa quando vale 0xFFFF,
+// qualquer que seja a largura. Quatro linhas consecutivas cabem em um uint64_t, entao
+// testar se uma peca cabe em uma posicao e um unico AND entre essa janela e a mascara
+// da peca (FORMAS_PECA, quatro linhas de 4 bits) deslocada para a coluna.
+//
+// O gerador de colocacoes lista todas as posicoes finais (rotacao x coluna, com a
+// queda ja resolvida) de uma peca: com a altura de cada coluna e o perfil de baixo
+// da forma (PERFIL_BASE), a linha de parada e um maximo de no maximo quatro valores.
+
+#ifndef TABULEIRO_H
+#define TABULEIRO_H
+
+#include <stdint.h>
+
+#include "pecas.h"
+
+#define TABULEIRO_LARGURA 10     // Tamanho padrao
+#define TABULEIRO_ALTURA 20
+#define TABULEIRO_MAX_LARGURA 16
+#define TABULEIRO_MAX_ALTURA 60
+#define TABULEIRO_MIN_LARGURA 4  // A peca I deitada precisa caber
+#define TABULEIRO_MIN_ALTURA 4
+#define TABULEIRO_ROTACOES 4
+#define TABULEIRO_LINHAS_PECA 4  // Linhas da janela de uma peca
+
+// Mascaras das pecas na ordem de GERADOR_TIPOS, para cada rotacao (sentido horario).
+// Linha r da peca nos bits [16r, 16r + 4), da mais baixa para a mais alta; cada forma
+// encosta na linha 0 e na coluna 0.
+static const uint64_t FORMAS_PECA[GERADOR_NUM_TIPOS][TABULEIRO_ROTACOES] = {
+    {0x000FULL, 0x0001000100010001ULL, 0x000FULL, 0x0001000100010001ULL},                      // I
+    {0x00030003ULL, 0x00030003ULL, 0x00030003ULL, 0x00030003ULL},                              // O
+    {0x00020007ULL, 0x000100030001ULL, 0x00070002ULL, 0x000200030002ULL},                      // T
+    {0x00040007ULL, 0x000100010003ULL, 0x00070001ULL, 0x000300020002ULL},                      // L
+    {0x00010007ULL, 0x000300010001ULL, 0x00070004ULL, 0x000200020003ULL},                      // J
+    {0x00060003ULL, 0x000100030002ULL, 0x00060003ULL, 0x000100030002ULL},                      // S
+    {0x00030006ULL, 0x000200030001ULL, 0x00030006ULL, 0x000200030001ULL},                      // Z
+};
+
+// Colunas e linhas ocupadas por cada forma
+static const uint8_t LARGURA_FORMA[GERADOR_NUM_TIPOS][TABULEIRO_ROTACOES] = {
+    {4, 1, 4, 1}, {2, 2, 2, 2}, {3, 2, 3, 2}, {3, 2, 3, 2}, {3, 2, 3, 2}, {3, 2, 3, 2}, {3, 2, 3, 2},
+};
+static const uint8_t ALTURA_FORMA[GERADOR_NUM_TIPOS][TABULEIRO_ROTACOES] = {
+    {1, 4, 1, 4}, {2, 2, 2, 2}, {2, 3, 2, 3}, {2, 3, 2, 3}, {2, 3, 2, 3}, {2, 3, 2, 3}, {2, 3, 2, 3},
+};
+
+// Linha mais baixa ocupada em cada coluna da forma (as colunas alem da largura ficam em 0)
+static const uint8_t PERFIL_BASE[GERADOR_NUM_TIPOS][TABULEIRO_ROTACOES][TABULEIRO_LINHAS_PECA] = {
+    {{0, 0, 0, 0}, {0}, {0, 0, 0, 0}, {0}},                        // I
+    {{0, 0}, {0, 0}, {0, 0}, {0, 0}},                              // O
+    {{0, 0, 0}, {0, 1}, {1, 0, 1}, {1, 0}},                        // T
+    {{0, 0, 0}, {0, 0}, {0, 1, 1}, {2, 0}},                        // L
+    {{0, 0, 0}, {0, 2}, {1, 1, 0}, {0, 0}},                        // J
+    {{0, 0, 1}, {1, 0}, {0, 0, 1}, {1, 0}},                        // S
+    {{1, 0, 0}, {0, 1}, {1, 0, 0}, {0, 1}},                        // Z
+};
+
+// Rotacoes com formas diferentes: O tem uma; I, S e Z repetem as duas primeiras
+static const uint8_t ROTACOES_DISTINTAS[GERADOR_NUM_TIPOS] = {2, 1, 4, 4, 4, 2, 2};
+
+// Maximo de colocacoes de uma peca: 4 rotacoes x 16 colunas
+#define TABULEIRO_MAX_COLOCACOES (TABULEIRO_ROTACOES * TABULEIRO_MAX_LARGURA)
+
+// Posicao final de uma peca, ja apoiada (tabuleiro_fixar a grava)
+typedef struct {
+    uint8_t acao;    // Em gerarColocacoesJogada: 1 = peca da frente da fila, 3 = topo da reserva
+    uint8_t tipo;    // 0-6, ordem de GERADOR_TIPOS
+    uint8_t rotacao;
+    uint8_t coluna;  // Coluna do canto esquerdo
+    uint8_t linha;   // Linha do canto de baixo
+} Colocacao;
+
+typedef struct {
+    // Linha 0 e o fundo. As TABULEIRO_LINHAS_PECA linhas acima da altura ficam vazias,
+    // para que a janela de 4 linhas nunca saia do vetor.
+    uint16_t linhas[TABULEIRO_MAX_ALTURA + TABULEIRO_LINHAS_PECA];
+    uint16_t vazia;      // Linha sem nenhum bloco (so a parede alem da largura)
+    int largura;
+    int altura;
+    int ocupadas;        // Linhas da base ate o bloco mais alto (acima delas tudo e vazio)
+    uint64_t pecas;      // Pecas colocadas
+    uint64_t eliminadas; // Linhas completas eliminadas
+} Tabuleiro;
+
+int tabuleiro_inicializar(Tabuleiro *t, int largura, int altura);
+void tabuleiro_limpar(Tabuleiro *t);
+int tabuleiro_soltar(const Tabuleiro *t, int tipo, int rotacao, int coluna);
+int tabuleiro_fixar(Tabuleiro *t, int tipo, int rotacao, int coluna, int linha);
+int tabuleiro_colocar(Tabuleiro *t, int tipo, int rotacao, int coluna);
+int tabuleiro_colocarPeca(Tabuleiro *t, Peca p);
+int tabuleiro_colunaEntrada(const Tabuleiro *t, int tipo, int rotacao);
+void tabuleiro_alturas(const Tabuleiro *t, uint8_t alturas[TABULEIRO_MAX_LARGURA]);
+int gerarColocacoesAlturas(const Tabuleiro *t, const uint8_t *alturas, int tipo, Colocacao *destino);
+int gerarColocacoes(const Tabuleiro *t, int tipo, Colocacao *destino);
+int gerarColocacoesJogada(const Tabuleiro *t, const Fila *f, const Pilha *p, Colocacao *destino);
+
+
+// --- Caminho quente ---
+
+/**
+ * @brief As quatro linhas a partir de 'linha', uma em cada 16 bits (a de baixo nos bits baixos).
+ */
+static inline uint64_t tabuleiro_janela(const Tabuleiro *t, int linha) {
+    const uint16_t *l = &t->linhas[linha];
+    return (uint64_t)l[0] | ((uint64_t)l[1] << 16) | ((uint64_t)l[2] << 32) | ((uint64_t)l[3] << 48);
+}
+
+/**
+ * @brief 1 se a forma cabe com o canto inferior esquerdo em (coluna, linha).
+ * A coluna ja deve estar em [0, largura - LARGURA_FORMA]: a parede cobre as colunas
+ * a direita, mas o deslocamento nao pode passar do bit 15.
+ */
+static inline int tabuleiro_cabe(const Tabuleiro *t, int tipo, int rotacao, int coluna, int linha) {
+    if (linha < 0 || linha + ALTURA_FORMA[tipo][rotacao] > t->altura) return 0;
+    return (tabuleiro_janela(t, linha) & (FORMAS_PECA[tipo][rotacao] << coluna)) == 0;
+}
+
+#endif // TABULEIRO_H
@@ -0,0 +1,126 @@
+// Entrada de teclado para o modo em tempo real: terminal em modo bruto e leitura
+// sem bloqueio.
+//
+// Em modo bruto cada tecla chega assim que e pressionada (sem esperar Enter e sem
+// eco). A espera por teclas e feita com poll() pelo laco de eventos; aqui ficam so a
+// configuracao do terminal e a decodificacao dos bytes lidos (setas chegam como
+// sequencias ESC [ A-D, que podem chegar em mais de um read()). Se a entrada nao e um terminal (pipe, arquivo), o modo
+// bruto e dispensado e os bytes sao lidos como chegam.
+
+#ifndef TECLADO_H
+#define TECLADO_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TECLADO_TAM_BUFFER 64
+#define TECLADO_ESPERA_ESC_NS 50000000ULL // Espera pelo resto de uma sequencia ESC [ incompleta
+
+// Codigos de tecla: 0-255 sao os proprios bytes; as setas ficam acima
+enum {
+    TECLA_CIMA = 256,
+    TECLA_BAIXO,
+    TECLA_DIREITA,
+    TECLA_ESQUERDA
+};
+
+typedef struct {
+    int fd;
+    int bruto;                 // 1 se o terminal foi posto em modo bruto (restaurar ao sair)
+    struct termios original;
+    unsigned char buffer[TECLADO_TAM_BUFFER]; // Bytes lidos e ainda nao decodificados
+    int inicio, fim;
+    uint64_t prefixo_desde;    // relogio_ns() em que um ESC incompleto ficou no fim do buffer (0: nenhum)
+} Teclado;
+
+/**
+ * @brief Tempo do relogio monotono em nanossegundos.
+ */
+static inline uint64_t relogio_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Prepara a leitura de fd; se for um terminal, o poe em modo bruto (sem eco,
+ * sem buffer de linha, sem sinais: Ctrl-C chega como o byte 3).
+ * @return 1 em caso de sucesso, 0 se o terminal nao pode ser configurado.
+ */
+static inline int teclado_iniciar(Teclado *k, int fd) {
+    k->fd = fd;
+    k->bruto = 0;
+    k->inicio = k->fim = 0;
+    k->prefixo_desde = 0;
+    if (!isatty(fd)) return 1;
+    if (tcgetattr(fd, &k->original) != 0) return 0;
+
+    struct termios bruto = k->original;
+    bruto.c_iflag &= (tcflag_t)~(ICRNL | IXON | BRKINT | ISTRIP);
+    bruto.c_lflag &= (tcflag_t)~(ICANON | ECHO | ISIG | IEXTEN);
+    bruto.c_cc[VMIN] = 0;
+    bruto.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSAFLUSH, &bruto) != 0) return 0;
+    k->bruto = 1;
+    return 1;
+}
+
+/**
+ * @brief Devolve o terminal ao modo em que estava antes de teclado_iniciar.
+ */
+static inline void teclado_restaurar(Teclado *k) {
+    if (k->bruto) tcsetattr(k->fd, TCSAFLUSH, &k->original);
+    k->bruto = 0;
+}
+
+/**
+ * @brief Le os bytes disponiveis (a chamar quando poll() indica entrada).
+ * @return Bytes lidos, 0 no fim da entrada, -1 em erro.
+ */
+static inline int teclado_ler(Teclado *k) {
+    if (k->inicio > 0) { // Leva o que falta decodificar (ex.: um ESC incompleto) para o inicio
+        memmove(k->buffer, k->buffer + k->inicio, (size_t)(k->fim - k->inicio));
+        k->fim -= k->inicio;
+        k->inicio = 0;
+    }
+    if (k->fim == TECLADO_TAM_BUFFER) return 1; // Ainda ha teclas a decodificar
+    ssize_t n;
+    do {
+        n = read(k->fd, k->buffer + k->fim, (size_t)(TECLADO_TAM_BUFFER - k->fim));
+    } while (n < 0 && errno == EINTR);
+    if (n > 0) k->fim += (int)n;
+    return (int)n;
+}
+
+/**
+ * @brief Proxima tecla ja lida, ou -1 se nao ha nenhuma completa.
+ * Um ESC ou ESC [ no fim do buffer fica esperando o resto da sequencia; se ele nao
+ * chega em TECLADO_ESPERA_ESC_NS, os bytes valem como teclas comuns. Por isso o laco
+ * de eventos chama esta funcao tambem quando nao ha entrada nova.
+ */
+static inline int teclado_proxima(Teclado *k) {
+    if (k->inicio == k->fim) return -1;
+    unsigned char c = k->buffer[k->inicio];
+    int disponiveis = k->fim - k->inicio;
+    if (c == 0x1b && (disponiveis == 1 || (disponiveis == 2 && k->buffer[k->inicio + 1] == '['))) {
+        uint64_t agora = relogio_ns();
+        if (!k->prefixo_desde) k->prefixo_desde = agora;
+        if (agora - k->prefixo_desde < TECLADO_ESPERA_ESC_NS) return -1;
+    } else if (c == 0x1b && disponiveis >= 3 && k->buffer[k->inicio + 1] == '[') {
+        unsigned char final = k->buffer[k->inicio + 2];
+        if (final >= 'A' && final <= 'D') {
+            k->inicio += 3;
+            k->prefixo_desde = 0;
+            return TECLA_CIMA + (final - 'A');
+        }
+    }
+    k->inicio++;
+    k->prefixo_desde = 0;
+    return c;
+}
+
+#endif // TECLADO_H
@@ -0,0 +1,251 @@
+// Renderizador de terminal com um buffer por quadro.
+//
+// O quadro e montado linha a linha em memoria (tela_linha) e enviado com um unico
+// write() em tela_desenhar. Em um terminal, so o trecho de cada linha que mudou desde
+// o quadro anterior e redesenhado, com posicionamento de cursor ANSI. Com a saida
+// redirecionada (arquivo, pipe), o quadro inteiro e escrito como texto simples.
+//
+// A ultima linha do quadro e o prompt: ela e sempre redesenhada (o eco da entrada do
+// usuario a suja) e o cursor termina no seu final.
+
+#ifndef TELA_H
+#define TELA_H
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#define TELA_MAX_LINHAS 64
+#define TELA_MAX_COLUNAS 160
+#define TELA_TAM_SAIDA (TELA_MAX_LINHAS * (TELA_MAX_COLUNAS + 16) + 32) // Quadro + sequencias ANSI
+#define TELA_TAM_STATUS 2048
+
+typedef struct {
+    char quadro[TELA_MAX_LINHAS][TELA_MAX_COLUNAS + 1];  // Quadro em montagem
+    char exibido[TELA_MAX_LINHAS][TELA_MAX_COLUNAS + 1]; // O que o terminal mostra agora
+    int num_linhas;        // Linhas do quadro em montagem
+    int linhas_exibidas;   // Linhas do quadro anterior
+    int colunas;           // Largura util (limitada pela largura do terminal)
+    int ansi;              // 1 se a saida e um terminal
+    int valido;            // 0 ate o primeiro quadro: forca limpar a tela
+    int fd;
+    char status[TELA_TAM_STATUS]; // Mensagens acumuladas desde o ultimo quadro
+    size_t tam_status;
+    size_t usado;
+    char saida[TELA_TAM_SAIDA];
+} Tela;
+
+
+// --- 1. Montagem do Quadro ---
+
+/**
+ * @brief Prepara a tela para escrever em fd (normalmente STDOUT_FILENO).
+ */
+static inline void tela_inicializar(Tela *t, int fd) {
+    struct winsize ws;
+    t->fd = fd;
+    t->ansi = isatty(fd);
+    t->colunas = TELA_MAX_COLUNAS;
+    if (t->ansi && ioctl(fd, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0 && ws.ws_col < TELA_MAX_COLUNAS) {
+        t->colunas = ws.ws_col;
+    }
+    t->num_linhas = 0;
+    t->linhas_exibidas = 0;
+    t->valido = 0;
+    t->tam_status = 0;
+    t->status[0] = '\0';
+}
+
+static inline void tela_iniciarQuadro(Tela *t) {
+    t->num_linhas = 0;
+}
+
+/**
+ * @brief Acrescenta uma linha ao quadro (sem '\n'), cortada na largura da tela.
+ */
+static inline void tela_linha(Tela *t, const char *formato, ...) {
+    if (t->num_linhas == TELA_MAX_LINHAS) return;
+    char *linha = t->quadro[t->num_linhas++];
+    va_list args;
+    va_start(args, formato);
+    int n = vsnprintf(linha, (size_t)t->colunas + 1, formato, args);
+    va_end(args);
+    if (n > t->colunas) {
+        // Nao deixa um caractere UTF-8 cortado ao meio
+        int fim = t->colunas;
+        while (fim > 0 && ((unsigned char)linha[fim] & 0xC0) == 0x80) fim--;
+        linha[fim] = '\0';
+    }
+}
+
+/**
+ * @brief Acumula uma mensagem de status para o proximo quadro. Com o buffer pela
+ * metade (um lote longo de acoes), as mensagens mais antigas sao descartadas: a area
+ * de status so mostra as ultimas.
+ */
+static inline void tela_status(Tela *t, const char *formato, ...) {
+    if (t->tam_status > TELA_TAM_STATUS / 2) {
+        const char *corte = strchr(t->status + t->tam_status - TELA_TAM_STATUS / 4, '\n');
+        if (corte) {
+            size_t inicio = (size_t)(corte + 1 - t->status);
+            memmove(t->status, t->status + inicio, t->tam_status - inicio + 1);
+            t->tam_status -= inicio;
+        }
+    }
+    if (t->tam_status + 1 >= TELA_TAM_STATUS) return;
+    va_list args;
+    va_start(args, formato);
+    int n = vsnprintf(t->status + t->tam_status, TELA_TAM_STATUS - t->tam_status, formato, args);
+    va_end(args);
+    if (n > 0) {
+        t->tam_status += (size_t)n;
+        if (t->tam_status >= TELA_TAM_STATUS) t->tam_status = TELA_TAM_STATUS - 1;
+    }
+}
+
+/**
+ * @brief Copia as ultimas 'max_linhas' linhas nao vazias do status para o quadro.
+ * No terminal a area e completada com linhas em branco, para que o resto do quadro
+ * nao mude de posicao.
+ * @param manter 0 limpa o status; 1 guarda as linhas exibidas para os proximos quadros.
+ */
+static inline void tela_copiarStatus(Tela *t, int max_linhas, int manter) {
+    const char *inicios[TELA_MAX_LINHAS];
+    int tamanhos[TELA_MAX_LINHAS];
+    int total = 0;
+
+    if (max_linhas > TELA_MAX_LINHAS) max_linhas = TELA_MAX_LINHAS;
+    const char *s = t->status;
+    while (*s) {
+        const char *fim = strchr(s, '\n');
+        int tam = fim ? (int)(fim - s) : (int)strlen(s);
+        if (tam > 0) {
+            if (total == max_linhas) { // Descarta a mais antiga
+                memmove(inicios, inicios + 1, (size_t)(max_linhas - 1) * sizeof(inicios[0]));
+                memmove(tamanhos, tamanhos + 1, (size_t)(max_linhas - 1) * sizeof(tamanhos[0]));
+                total--;
+            }
+            inicios[total] = s;
+            tamanhos[total++] = tam;
+        }
+        s += tam + (fim != NULL);
+    }
+    for (int i = 0; i < max_linhas; i++) {
+        if (i < total) {
+            tela_linha(t, "%.*s", tamanhos[i], inicios[i]);
+        } else if (t->ansi) {
+            tela_linha(t, "");
+        }
+    }
+    if (manter && total > 0) {
+        size_t inicio = (size_t)(inicios[0] - t->status);
+        memmove(t->status, t->status + inicio, t->tam_status - inicio + 1);
+        t->tam_status -= inicio;
+    } else {
+        t->tam_status = 0;
+        t->status[0] = '\0';
+    }
+}
+
+/**
+ * @brief Area de status de um quadro por acao: as mensagens aparecem uma vez.
+ */
+static inline void tela_areaStatus(Tela *t, int max_linhas) {
+    tela_copiarStatus(t, max_linhas, 0);
+}
+
+/**
+ * @brief Area de status rolante, para quadros redesenhados sem acao do usuario (tempo
+ * real): as ultimas linhas continuam na tela ate serem empurradas por novas mensagens.
+ */
+static inline void tela_areaStatusRolante(Tela *t, int max_linhas) {
+    tela_copiarStatus(t, max_linhas, 1);
+}
+
+
+// --- 2. Desenho ---
+
+static inline void tela_acrescentar(Tela *t, const char *dados, size_t n) {
+    if (t->usado + n > TELA_TAM_SAIDA) n = TELA_TAM_SAIDA - t->usado;
+    memcpy(t->saida + t->usado, dados, n);
+    t->usado += n;
+}
+
+static inline void tela_moverCursor(Tela *t, int linha, int coluna) {
+    char seq[24];
+    int n = snprintf(seq, sizeof(seq), "\x1b[%d;%dH", linha + 1, coluna + 1);
+    tela_acrescentar(t, seq, (size_t)n);
+}
+
+/**
+ * @brief Envia o quadro montado com um unico write() e o guarda como exibido.
+ * @return 1 em caso de sucesso, 0 se a escrita falhou.
+ */
+static inline int tela_desenhar(Tela *t) {
+    t->usado = 0;
+
+    if (!t->ansi) {
+        tela_acrescentar(t, "\n", 1);
+        for (int i = 0; i < t->num_linhas; i++) {
+            tela_acrescentar(t, t->quadro[i], strlen(t->quadro[i]));
+            if (i < t->num_linhas - 1) tela_acrescentar(t, "\n", 1);
+        }
+    } else {
+        if (!t->valido) {
+            tela_acrescentar(t, "\x1b[H\x1b[2J", 7);
+            t->linhas_exibidas = 0;
+        } else if (t->linhas_exibidas > t->num_linhas) {
+            tela_moverCursor(t, t->num_linhas, 0);
+            tela_acrescentar(t, "\x1b[J", 3); // Apaga as linhas que sobraram
+        }
+        for (int i = 0; i < t->num_linhas; i++) {
+            const char *novo = t->quadro[i];
+            const char *antigo = i < t->linhas_exibidas ? t->exibido[i] : "";
+            int ultima = (i == t->num_linhas - 1);
+            int inicio = 0;
+            int ascii = 1;
+
+            while (novo[inicio] && novo[inicio] == antigo[inicio]) {
+                if ((unsigned char)novo[inicio] >= 0x80) ascii = 0;
+                inicio++;
+            }
+            if (!ultima && novo[inicio] == '\0' && antigo[inicio] == '\0') continue; // Linha igual
+            // Caracteres multibyte antes da mudanca: a coluna nao e conhecida, redesenha a linha
+            if (!ascii || ultima) inicio = 0;
+
+            size_t tam_novo = strlen(novo);
+            tela_moverCursor(t, i, inicio);
+            tela_acrescentar(t, novo + inicio, tam_novo - (size_t)inicio);
+            if (ultima || strlen(antigo) > tam_novo || inicio == 0) {
+                tela_acrescentar(t, "\x1b[K", 3);
+            }
+        }
+    }
+
+    memcpy(t->exibido, t->quadro, (size_t)t->num_linhas * sizeof(t->quadro[0]));
+    t->linhas_exibidas = t->num_linhas;
+    t->valido = 1;
+
+    size_t enviado = 0;
+    while (enviado < t->usado) {
+        ssize_t n = write(t->fd, t->saida + enviado, t->usado - enviado);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        enviado += (size_t)n;
+    }
+    return 1;
+}
+
+/**
+ * @brief Faz o proximo quadro ser desenhado por completo (ex.: apos outra saida no terminal).
+ */
+static inline void tela_invalidar(Tela *t) {
+    t->valido = 0;
+}
+
+#endif // TELA_H